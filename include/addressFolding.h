@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "tacGenerator.h"
+
+/*
+    Folds the arithmetic computing the index of an array/struct/pointer access into the access itself
+    (run after the optimiser, before registers are allocated since it lengthens the life of the index)
+    i.e. MUL 4, i -> t1; ADD 8, t1 -> t2; ASSIGN x, t2 -> a becomes ASSIGN x, i*4+8 -> a
+    which the assembler emits as a single base + index * scale + displacement address
+
+    - Only multiplies by 1, 2, 4 or 8 (the scales x86 addressing supports) and adding/subtracting
+      constants are folded
+    - Everything folded has to be straight-line code before the access (no labels in between)
+      with nothing in between changing what it was computed from
+    - An index which comes to a constant is replaced by that constant
+    The instructions folded are removed once nothing else uses them
+*/
+class AddressFolding
+{
+public:
+    AddressFolding(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(std::vector<TACInstruction> &instructions);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    // State for the function being folded
+    std::unordered_map<std::string, int> def_counts;
+    std::unordered_map<std::string, int> use_counts;
+    std::unordered_map<std::string, size_t> def_positions;
+    std::unordered_set<std::string> address_taken;
+
+    void count(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+    bool fold_access(std::vector<TACInstruction> &instructions, size_t block_start, size_t access,
+                     std::vector<size_t> &dead);
+
+    bool is_index_operand(const std::string &name) const;
+    bool is_redefined(const std::vector<TACInstruction> &instructions, const std::string &name, size_t from,
+                      size_t to) const;
+};
@@ -4,10 +4,13 @@
 #include <cstdio>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 
 #include "symbolTable.h"
 #include "globalSymbolTable.h"
+#include "options.h"
+#include "peephole.h"
 #include "tacGenerator.h"
 
 enum class VarType
@@ -22,16 +25,27 @@ enum class VarType
 class Assembler
 {
 public:
-    Assembler(std::shared_ptr<GlobalSymbolTable> &gst, const std::string &filename);
+    Assembler(std::shared_ptr<GlobalSymbolTable> &gst, const std::string &filename, const CompilerOptions &options);
     void assemble(const std::vector<TACInstruction> &instructions);
 
 private:
     std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
     VarType current_var_type = VarType::TEXT;
     FILE *file;
 
+    // Everything emitted is held here (one line each) until the peephole optimiser has been over it
+    std::vector<MachineInstr> machine_instrs;
+    std::string pending_line = "";
+
     std::unordered_map<TACOp, std::function<void(const TACInstruction &)>> handlers;
 
+    // Functions which make no calls (and never move %rsp) so they don't need a frame of their own
+    static constexpr int RED_ZONE_SIZE = 128;
+    std::unordered_set<std::string> leaf_funcs;
+    std::string frame_reg = "%rbp"; // What the current function's locals are addressed from
+    bool uses_red_zone = false;
+
     const std::unordered_map<std::string, std::array<std::string, 4>> register_table = {
         // 64-bit, 32-bit, 16-bit, 8-bit
         {"%rax", {"%rax", "%eax", "%ax", "%al"}},
@@ -56,6 +70,8 @@ private:
 
     void emit_func_begin(const TACInstruction &instruction);
     void emit_func_end(const TACInstruction &instruction);
+    void find_leaf_funcs(const std::vector<TACInstruction> &instructions);
+    int get_red_zone_slot(size_t saved_reg) const;
     void emit_return(const TACInstruction &instruction);
     void emit_bin_op(const TACInstruction &instruction, const std::string &op);
     void emit_cmp_op(const TACInstruction &instruction, const std::string &op);
@@ -81,9 +97,23 @@ private:
     void emit_logical_or(const TACInstruction &instruction);
 
     void emit_div_mod(const TACInstruction &instruction, const bool &is_mod);
+    bool emit_div_mod_by_const(const TACInstruction &instruction, bool is_mod);
+    bool emit_mul_by_const(const TACInstruction &instruction);
+    bool emit_add_by_lea(const TACInstruction &instruction);
     void emit_mod(const TACInstruction &instruction);
     void emit_div(const TACInstruction &instruction);
 
+    // Vector loops (see LoopVectoriser), using ymm registers under -mavx2 and xmm registers otherwise
+    void emit_vec_load(const TACInstruction &instruction);
+    void emit_vec_store(const TACInstruction &instruction);
+    void emit_vec_splat(const TACInstruction &instruction);
+    void emit_vec_bin_op(const TACInstruction &instruction, const std::string &op);
+    void emit_vec_int_mul(const std::string &a, const std::string &b, const std::string &result);
+    void emit_vec_end(const TACInstruction &instruction);
+    std::string select_vec_reg(const std::string &reg);
+    std::string select_vec_mov(const Type &type);
+    std::string format_vec_mem_operand(const std::string &array, const std::string &index, const Type &type);
+
     std::string select_mov_instr(const Type &type);
     std::string select_cmp_instr(const Type &type);
     std::string select_reg_name(const char *base_reg, const Type &type);
@@ -93,8 +123,14 @@ private:
     std::string format_typed_instr(const std::string &instr, const Type &type);
     std::string normalise_signed_instr(const std::string &instr);
 
-    void emit_load(const std::string &operand, const char *reg, Type type, const std::string &arg2 = "");
-    void emit_store(const std::string &operand, const char *reg, Type type, const std::string &arg2 = "");
+    // scale and displacement are those of an indexed access (see AddressFolding)
+    void emit_load(const std::string &operand, const char *reg, Type type, const std::string &arg2 = "",
+                   int scale = 1, int displacement = 0);
+    void emit_store(const std::string &operand, const char *reg, Type type, const std::string &arg2 = "",
+                    int scale = 1, int displacement = 0);
+    void emit_index_load(const std::string &index, const char *reg);
+    std::string format_indexed_operand(const std::string &base, const std::string &index, const char *reg, int scale,
+                                       int displacement);
 
     void emit_assign(const TACInstruction &instruction);
     void emit_text_assign(const TACInstruction &instruction);
@@ -103,6 +139,7 @@ private:
     void emit_literal8_assign(const TACInstruction &instruction);
     void emit_str_assign(const TACInstruction &instruction);
 
+    void emit(const char *format, ...) __attribute__((format(printf, 2, 3)));
     void emit_comment_instr(const TACInstruction &instr);
     std::string encode_double_hex(const double &value);
     void report_error(const std::string &message);
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "astArena.h"
 #include "lexer.h"
 #include "type.h"
 
@@ -200,10 +201,10 @@ public:
 
 class AggregateLiteral : public ASTNode {
 public:
-	std::vector<std::unique_ptr<ASTNode>> values;
+	std::vector<ASTNode *> values;
 	Type type = Type(BaseType::VOID);
 
-	void add_element(std::unique_ptr<ASTNode> element);
+	void add_element(ASTNode *element);
 
 	AggregateLiteral(Type t, SourceLocation loc);
 	void print(int tabs) override;
@@ -246,27 +247,27 @@ public:
 
 class CastNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> expr;
+	ASTNode *expr = nullptr;
 	Type target_type;
 	Type src_type;
 
-	CastNode(std::unique_ptr<ASTNode> e, Type t1, Type t2 = Type(BaseType::VOID), SourceLocation loc = {});
+	CastNode(ASTNode *e, Type t1, Type t2 = Type(BaseType::VOID), SourceLocation loc = {});
 	void print(int tabs) override;
 };
 
 class RtnNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> value;
+	ASTNode *value = nullptr;
 
-	RtnNode(std::unique_ptr<ASTNode> v, SourceLocation loc);
+	RtnNode(ASTNode *v, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class FuncNode : public ASTNode {
 public:
 	std::string name;
-	std::vector<std::unique_ptr<ASTNode>> params;
-	std::vector<std::unique_ptr<ASTNode>> elements;
+	std::vector<ASTNode *> params;
+	std::vector<ASTNode *> elements;
 	Type return_type = Type(BaseType::VOID);
 	std::vector<Specifier> specifiers;
 
@@ -278,7 +279,7 @@ public:
 class FuncCallNode : public ASTNode {
 public:
 	std::string name;
-	std::vector<std::unique_ptr<ASTNode>> args;
+	std::vector<ASTNode *> args;
 
 	FuncCallNode(const std::string &n, SourceLocation loc);
 	void print(int tabs) override;
@@ -286,7 +287,7 @@ public:
 
 class ProgramNode : public ASTNode {
 public:
-	std::vector<std::unique_ptr<ASTNode>> decls;
+	std::vector<ASTNode *> decls;
 
 	ProgramNode();
 	void print(int tabs = 0) override;
@@ -295,34 +296,34 @@ public:
 class UnaryNode : public ASTNode {
 public:
 	UnaryOpType op;
-	std::unique_ptr<ASTNode> value;
+	ASTNode *value = nullptr;
 	Type type = Type(BaseType::VOID);
 
-	UnaryNode(UnaryOpType o, std::unique_ptr<ASTNode> v, SourceLocation loc);
+	UnaryNode(UnaryOpType o, ASTNode *v, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class PostfixNode : public ASTNode {
 public:
 	TokenType op;
-	std::unique_ptr<ASTNode> value;
+	ASTNode *value = nullptr;
 	Type type = Type(BaseType::VOID);
 
 	std::string struct_name;
 	std::string field_name;
 
-	PostfixNode(TokenType o, std::unique_ptr<ASTNode> v, SourceLocation loc);
+	PostfixNode(TokenType o, ASTNode *v, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class BinaryNode : public ASTNode {
 public:
 	BinOpType op;
-	std::unique_ptr<ASTNode> left;
-	std::unique_ptr<ASTNode> right;
+	ASTNode *left = nullptr;
+	ASTNode *right = nullptr;
 	Type type = Type(BaseType::VOID);
 
-	BinaryNode(BinOpType o, std::unique_ptr<ASTNode> l, std::unique_ptr<ASTNode> r, SourceLocation loc);
+	BinaryNode(BinOpType o, ASTNode *l, ASTNode *r, SourceLocation loc);
 	void print(int tabs) override;
 };
 
@@ -339,64 +340,62 @@ public:
 
 class VarDeclNode : public ASTNode {
 public:
-	std::unique_ptr<VarNode> var;
-	std::unique_ptr<ASTNode> value;
+	VarNode *var = nullptr;
+	ASTNode *value = nullptr;
 
-	VarDeclNode(std::unique_ptr<VarNode> v, std::unique_ptr<ASTNode> val, SourceLocation loc);
+	VarDeclNode(VarNode *v, ASTNode *val, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class StructDeclNode : public ASTNode {
 public:
 	std::string name;
-	std::vector<std::unique_ptr<ASTNode>> members;
+	std::vector<ASTNode *> members;
 
-	StructDeclNode(const std::string &n, std::vector<std::unique_ptr<ASTNode>> m, SourceLocation loc);
+	StructDeclNode(const std::string &n, std::vector<ASTNode *> m, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class VarAssignNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> var;
-	std::unique_ptr<ASTNode> value;
+	ASTNode *var = nullptr;
+	ASTNode *value = nullptr;
 
-	VarAssignNode(std::unique_ptr<ASTNode> v, std::unique_ptr<ASTNode> val, SourceLocation loc);
+	VarAssignNode(ASTNode *v, ASTNode *val, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class IfNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> condition;
-	std::vector<std::unique_ptr<ASTNode>> then_elements;
-	std::vector<std::unique_ptr<ASTNode>> else_elements;
+	ASTNode *condition = nullptr;
+	std::vector<ASTNode *> then_elements;
+	std::vector<ASTNode *> else_elements;
 
-	IfNode(std::unique_ptr<ASTNode> c, std::vector<std::unique_ptr<ASTNode>> t, std::vector<std::unique_ptr<ASTNode>> e,
-		   SourceLocation loc);
+	IfNode(ASTNode *c, std::vector<ASTNode *> t, std::vector<ASTNode *> e, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class WhileNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> condition;
-	std::vector<std::unique_ptr<ASTNode>> elements;
+	ASTNode *condition = nullptr;
+	std::vector<ASTNode *> elements;
 
 	std::string label = "";
 
-	WhileNode(std::unique_ptr<ASTNode> c, std::vector<std::unique_ptr<ASTNode>> e, SourceLocation loc);
+	WhileNode(ASTNode *c, std::vector<ASTNode *> e, SourceLocation loc);
 	void print(int tabs) override;
 };
 
 class ForNode : public ASTNode {
 public:
-	std::unique_ptr<ASTNode> init;
-	std::unique_ptr<BinaryNode> condition;
-	std::unique_ptr<ASTNode> post;
-	std::vector<std::unique_ptr<ASTNode>> elements;
+	ASTNode *init = nullptr;
+	ASTNode *condition = nullptr;
+	ASTNode *post = nullptr;
+	std::vector<ASTNode *> elements;
 
 	std::string label = "";
 
-	ForNode(std::unique_ptr<ASTNode> i, std::unique_ptr<BinaryNode> c, std::unique_ptr<ASTNode> p,
-			std::vector<std::unique_ptr<ASTNode>> e, SourceLocation loc);
+	ForNode(ASTNode *i, ASTNode *c, ASTNode *p, std::vector<ASTNode *> e, SourceLocation loc);
 	void print(int tabs) override;
 };
 
@@ -411,12 +410,12 @@ public:
 
 class ArrayAccessNode : public ASTNode {
 public:
-	std::unique_ptr<VarNode> array;
-	std::unique_ptr<ASTNode> index;
+	VarNode *array = nullptr;
+	ASTNode *index = nullptr;
 	Type type = Type(BaseType::VOID);
 
-	ArrayAccessNode(const ArrayAccessNode &other, SourceLocation loc);
-	ArrayAccessNode(std::unique_ptr<VarNode> arr, std::unique_ptr<ASTNode> idx, SourceLocation loc);
+	ArrayAccessNode(const ArrayAccessNode &other, ASTArena &arena, SourceLocation loc);
+	ArrayAccessNode(VarNode *arr, ASTNode *idx, SourceLocation loc);
 
 	void print(int tabs) override;
 };
@@ -424,10 +423,10 @@ public:
 class SizeOfNode : public ASTNode {
 public:
 	Type type;
-	std::unique_ptr<VarNode> var;
+	VarNode *var = nullptr;
 
 	SizeOfNode(Type t, SourceLocation loc);
-	SizeOfNode(std::unique_ptr<VarNode> v, SourceLocation loc);
+	SizeOfNode(VarNode *v, SourceLocation loc);
 	void print(int tabs) override;
 };
 
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+class ASTNode;
+
+/*
+    Owns every AST node of a module (created by the parser and the semantic analyser)
+    Nodes are bump allocated out of large blocks rather than each being its own heap allocation
+    and are all destroyed at once when the arena is (once the module has been compiled)
+    so the pointers it hands out (and the nodes hold to each other) never own anything
+*/
+class ASTArena
+{
+public:
+    ASTArena() = default;
+    ASTArena(const ASTArena &) = delete;
+    ASTArena &operator=(const ASTArena &) = delete;
+    ~ASTArena();
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        T *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        nodes.push_back(node);
+        return node;
+    }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t used = BLOCK_SIZE; // Within the last block (so the first allocation starts one)
+
+    std::vector<ASTNode *> nodes; // In the order they were created
+
+    void *allocate(size_t size, size_t alignment);
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "tacGenerator.h"
+
+struct BasicBlock
+{
+    int id;
+    std::string label = ""; // Label the block starts with (empty if it is only reached by falling through)
+    std::vector<TACInstruction> instructions;
+    std::vector<int> preds;
+    std::vector<int> succs;
+};
+
+/*
+    A natural loop (found from a back edge to a header which dominates its source)
+    Back edges sharing a header are merged into one loop
+*/
+struct Loop
+{
+    int header;
+    std::vector<int> blocks;  // Includes the header
+    std::vector<int> latches; // Sources of the back edges
+
+    bool contains(int block) const;
+};
+
+/*
+    Control flow graph of a single function (FUNC_BEGIN to FUNC_END inclusive)
+    Blocks are kept in layout order so flattening reproduces the original fall throughs
+    - Block 0 is the entry (holds FUNC_BEGIN)
+    - The last block is the exit (holds only FUNC_END) which every RETURN leads to
+*/
+class ControlFlowGraph
+{
+public:
+    ControlFlowGraph(std::shared_ptr<GlobalSymbolTable> gst);
+
+    void build(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+    std::vector<TACInstruction> flatten() const;
+
+    // Recomputes the edges from each block's last instruction (after a pass rewrites jumps)
+    void rebuild_edges();
+
+    // Drops blocks which can't be reached from the entry (the exit is always kept)
+    bool remove_unreachable_blocks();
+
+    /*
+        Inserts an empty block (holding just a label) at a position in the layout
+        The blocks after it are renumbered and the edges must be rebuilt once any jumps have been updated
+    */
+    int insert_block(int position);
+
+    // Requires the dominators (inner loops come before the loops containing them)
+    std::vector<Loop> find_loops() const;
+
+    /*
+        Returns a block which is the only way into the loop and only leads to its header
+        Inserts one just before the header if there isn't one already (or -1 if that can't be done)
+        Note that this renumbers the blocks so any loops found beforehand must be found again
+    */
+    int get_preheader(const Loop &loop);
+
+    // Cooper, Harvey and Kennedy's iterative algorithm (must be called after the edges change)
+    void compute_dominators();
+
+    std::vector<BasicBlock> blocks;
+
+    int get_entry() const { return 0; }
+    int get_exit() const { return blocks.size() - 1; }
+
+    const std::vector<int> &get_rpo() const { return rpo; }
+    bool is_reachable(int block) const { return rpo_index[block] >= 0; }
+
+    int get_idom(int block) const { return idom[block]; }
+    const std::vector<int> &get_dom_children(int block) const { return dom_children[block]; }
+    const std::vector<int> &get_dominance_frontier(int block) const { return dominance_frontier[block]; }
+    bool dominates(int a, int b) const;
+
+    static bool is_terminator(const TACInstruction &instruction);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    std::unordered_map<std::string, int> label_blocks;
+    int new_label_count = 0;
+
+    std::vector<int> rpo;       // Reachable blocks in reverse postorder
+    std::vector<int> rpo_index; // -1 if unreachable
+    std::vector<int> idom;      // -1 if unreachable (the entry is its own idom)
+    std::vector<std::vector<int>> dom_children;
+    std::vector<std::vector<int>> dominance_frontier;
+
+    void compute_rpo();
+    int intersect(int a, int b) const;
+};
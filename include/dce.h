@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "ssa.h"
+
+/*
+    Dead code elimination over a function in SSA form
+    - Blocks which can't be reached are removed
+    - Stores to locals which are never read (and never have their address taken) are removed
+    - Instructions without side effects whose results are never used are removed (mark and sweep
+      from the instructions which have side effects so dead cycles through PHIs also go)
+*/
+class DeadCodeElimination
+{
+public:
+    DeadCodeElimination(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg, const SSA &ssa);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    const SSA *ssa = nullptr;
+
+    bool is_pure(const TACInstruction &instruction) const;
+    TACField get_target_field(const TACInstruction &instruction) const;
+
+    bool remove_dead_stores(ControlFlowGraph &cfg);
+    bool remove_dead_instructions(ControlFlowGraph &cfg);
+};
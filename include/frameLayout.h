@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "tacGenerator.h"
+
+/*
+    Packs the stack slots of each function once registers have been assigned (run before assembly)
+    Every symbol is given its own slot as it is declared, so a function ends up with a frame as large as
+    every temporary/block scoped local it has ever had (including those now living in registers)
+
+    - Only symbols still on the stack are given a slot
+    - Slots whose lifetimes don't overlap share the same memory
+    - The largest (most aligned) slots are placed first to cut down on padding
+
+    Anything which could be reached other than by name (its address is taken, aggregates, char pointers)
+    is kept alive for the whole function
+    Structs keep the slot they were declared with since their field offsets are baked into the TAC
+*/
+class FrameLayout
+{
+public:
+    FrameLayout(std::shared_ptr<GlobalSymbolTable> gst);
+
+    void layout(const std::vector<TACInstruction> &instructions);
+
+private:
+    struct Slot
+    {
+        std::string name;
+        int size;
+        int start;
+        int end;
+        int depth = 0;      // Distance below the frame base (so stack_offset is -depth)
+        bool fixed = false; // Keeps the depth it was declared with
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    void layout_func(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+
+    std::vector<Slot> build_slots(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+                                  const Liveness &liveness);
+    std::unordered_set<std::string> find_unpackable(const std::vector<TACInstruction> &instructions, size_t begin,
+                                                    size_t end);
+
+    static int get_alignment(int size);
+};
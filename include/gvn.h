@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "ssa.h"
+
+/*
+    Dominator based global value numbering over a function in SSA form
+    Walks the dominator tree keeping a scoped table of the expressions computed so far so an
+    expression already available from a dominating block is reused rather than recomputed
+    (e.g. the scaled index of arr[i] or a struct field offset used more than once)
+
+    Copies between values of the same type are propagated as well and PHIs whose operands
+    all have the same value are replaced (the copies left behind are removed by DCE)
+
+    Only pure operations on SSA values/literals are numbered (loads can be changed by stores)
+*/
+class GlobalValueNumbering
+{
+public:
+    GlobalValueNumbering(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg, const SSA &ssa);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    const SSA *ssa = nullptr;
+
+    std::unordered_map<std::string, std::string> leaders; // SSA value -> value it is equal to
+    std::unordered_map<std::string, std::string> available; // Expression key -> value holding it
+
+    bool is_numbered_op(TACOp op) const;
+    bool is_commutative(TACOp op) const;
+    bool is_invariant_operand(const std::string &operand) const;
+
+    const std::string &get_leader(const std::string &name) const;
+    bool get_key(const TACInstruction &instruction, std::string &key) const;
+
+    bool number_block(ControlFlowGraph &cfg, int block);
+    bool replace_uses(ControlFlowGraph &cfg);
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "options.h"
+#include "tacGenerator.h"
+
+/*
+    Replaces calls to small functions of the module with a copy of their body (run before the rest of the optimiser)
+    - Only functions which can't be called from another module (i.e. not public) are inlined
+    - The arguments are copied straight into (renamed) parameters rather than going through registers
+    - Each RETURN becomes an assignment to the call's result and a jump past the copied body
+    Functions are visited callees first so a helper has its own calls inlined before it is measured/copied
+    Once every call to a function has been inlined it is dropped from the module
+*/
+class Inliner
+{
+public:
+    Inliner(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options);
+
+    // Returns whether anything changed
+    bool run(std::vector<TACInstruction> &instructions);
+
+private:
+    struct Param
+    {
+        std::string name;
+        Type type;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
+
+    // FUNC_BEGIN to FUNC_END (inclusive) of each function in the module
+    std::unordered_map<std::string, std::vector<TACInstruction>> functions;
+    std::unordered_set<std::string> inlined;
+
+    int site_count = 0;
+
+    size_t get_cost(const std::vector<TACInstruction> &body) const;
+    std::unordered_map<std::string, Param> get_params(const std::vector<TACInstruction> &body) const;
+
+    bool is_inlinable(const std::string &callee, const std::string &caller);
+    bool inline_call(const std::string &caller, const std::string &callee, size_t call);
+    void inline_calls(const std::string &caller);
+};
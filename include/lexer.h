@@ -1,8 +1,9 @@
 #pragma once
 
-#include <unordered_map>
+#include <deque>
 #include <string>
-#include <stack>
+#include <string_view>
+#include <vector>
 
 enum TokenType
 {
@@ -79,47 +80,45 @@ enum TokenType
     TOKEN_NULL,
 };
 
-extern std::unordered_map<std::string, TokenType> string_to_token;
-;
-
 struct Token
 {
 public:
     TokenType type;
-    std::string text;
+    std::string_view text; // A span of the source (or of the lexer for char/string literals with escapes)
     size_t line;
     size_t index;
 
-    Token(TokenType t, const std::string &txt, size_t l, size_t i);
+    Token(TokenType t, std::string_view txt, size_t l, size_t i);
 };
 
 class Lexer
 {
 public:
-    Lexer(const std::string &source);
-    Token get_next_token();
-    Token rewind(int iterations = 1);
+    // source isn't copied so has to outlive the lexer and its tokens
+    Lexer(std::string_view source);
+
+    // Lexes the whole source the first time it is called (the last token is always TOKEN_EOF)
+    const std::vector<Token> &tokenise();
     void print_all_tokens();
-    void print_stack();
 
     std::string token_to_string(const TokenType &token_type);
 
 private:
-    std::string source;
+    std::string_view source;
     size_t index;
     size_t line = 1;
 
-    struct LexerState
-    {
-        size_t index;
-        size_t line;
-    };
+    // Char/string literals which had escapes in them (a deque so they never move)
+    std::deque<std::string> unescaped;
 
-    std::stack<LexerState> state_stack;
+    std::vector<Token> tokens;
 
-    std::string process_number();
-    std::string process_identifier();
-    std::string process_symbol();
+    char peek(size_t offset = 0) const;
+
+    std::string_view process_number();
+    std::string_view process_identifier();
+    Token process_symbol();
     Token process_char();
     Token process_string();
+    Token get_next_token();
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "ssa.h"
+
+/*
+    Loop invariant code motion over a function in SSA form
+    Natural loops are found from their back edges and instructions whose operands can't change
+    within the loop are moved into a preheader (inserted in front of the header where needed)
+    so they run once rather than on every iteration (e.g. struct field offsets, scaled indexes)
+
+    Loads of variables (including globals) are also moved when nothing in the loop could store to
+    them (no calls or stores through pointers), loads through pointers are left as the loop could
+    be guarding them. Inner loops are done first so what they hoist can carry on outwards
+*/
+class LoopInvariantCodeMotion
+{
+public:
+    LoopInvariantCodeMotion(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg, const SSA &ssa);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    const SSA *ssa = nullptr;
+
+    // What the loop being looked at could store to
+    std::unordered_set<std::string> written;
+    bool has_unknown_stores = false;
+
+    bool is_hoistable_op(const TACInstruction &instruction) const;
+    bool is_hoistable_load(const TACInstruction &instruction) const;
+
+    void find_stores(const ControlFlowGraph &cfg, const Loop &loop);
+    std::vector<std::pair<int, size_t>> find_invariants(const ControlFlowGraph &cfg, const Loop &loop);
+
+    bool hoist(ControlFlowGraph &cfg, const std::string &header_label);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "tacGenerator.h"
+
+/*
+    Returns the local variables/temporaries an instruction reads and writes
+    Anything which doesn't resolve to an automatic symbol of the current function is ignored
+    (literals, labels, registers, globals, statics)
+*/
+std::vector<std::string> get_tac_uses(const TACInstruction &instruction, GlobalSymbolTable *gst);
+std::vector<std::string> get_tac_defs(const TACInstruction &instruction, GlobalSymbolTable *gst);
+
+/*
+    The same but returns which fields hold the names (so they can be rewritten)
+    Note that the operands of a PHI aren't held in a field
+*/
+using TACField = std::string TACInstruction::*;
+std::vector<TACField> get_tac_use_fields(const TACInstruction &instruction, GlobalSymbolTable *gst);
+std::vector<TACField> get_tac_def_fields(const TACInstruction &instruction, GlobalSymbolTable *gst);
+
+bool is_local_symbol(Symbol *symbol);
+bool is_aggregate(const Type &type);
+
+/*
+    Backwards dataflow analysis over a single function (FUNC_BEGIN to FUNC_END inclusive)
+    Successors are derived from GOTO/IF/RETURN so loops are handled correctly
+*/
+class Liveness
+{
+public:
+    Liveness(std::shared_ptr<GlobalSymbolTable> gst);
+
+    void analyse(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+
+    bool is_live_in(size_t index, const std::string &name) const;
+    bool is_live_out(size_t index, const std::string &name) const;
+
+    const std::vector<std::string> &get_vars() const { return vars; }
+    const std::vector<std::vector<int>> &get_uses() const { return uses; }
+    const std::vector<std::vector<int>> &get_defs() const { return defs; }
+    const std::vector<std::vector<size_t>> &get_successors() const { return successors; }
+    const std::vector<std::vector<bool>> &get_live_in() const { return live_in; }
+    const std::vector<std::vector<bool>> &get_live_out() const { return live_out; }
+
+    int get_var_id(const std::string &name) const;
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    size_t begin = 0;
+    std::vector<std::string> vars;
+    std::unordered_map<std::string, int> var_ids;
+
+    // All indexed relative to begin
+    std::vector<std::vector<int>> uses;
+    std::vector<std::vector<int>> defs;
+    std::vector<std::vector<size_t>> successors;
+    std::vector<std::vector<bool>> live_in;
+    std::vector<std::vector<bool>> live_out;
+
+    int intern_var(const std::string &name);
+};
+
+/*
+    Finds the [FUNC_BEGIN, FUNC_END] index pairs within a module's instruction stream
+*/
+std::vector<std::pair<size_t, size_t>> find_func_ranges(const std::vector<TACInstruction> &instructions);
@@ -3,6 +3,8 @@
 #include <string>
 
 #include "../include/globalSymbolTable.h"
+#include "../include/options.h"
+#include "../include/sourceFile.h"
 
 class Module
 {
@@ -10,12 +12,13 @@ public:
     std::string name;
     std::string filepath;
 
-    Module(const std::string &path, std::shared_ptr<GlobalSymbolTable> gst);
+    Module(const std::string &path, std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options = CompilerOptions());
     void compile();
 
 private:
-    std::string file_contents;
+    SourceFile source;
     std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
 
     void check_file();
 };
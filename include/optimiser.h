@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "options.h"
+#include "ssa.h"
+#include "tacGenerator.h"
+
+/*
+    Runs the machine independent optimisations over each function's TAC
+    Every function is split into a CFG and put into SSA form which the passes work on
+    before being flattened back into ordinary TAC for the register allocator/assembler
+*/
+class Optimiser
+{
+public:
+    Optimiser(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options);
+
+    void optimise(std::vector<TACInstruction> &instructions);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
+
+    // Initial values of const global integers (which can be used in place of loading them)
+    std::unordered_map<std::string, long long> const_globals;
+
+    void find_const_globals(const std::vector<TACInstruction> &instructions);
+    void optimise_func(ControlFlowGraph &cfg, SSA &ssa);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+/*
+    Options which apply to an entire compilation (set from the command line)
+    - 0: No optimisations (everything lives on the stack)
+    - 1: SSA based optimisations and linear scan register allocation (default)
+    - 2: Graph colouring register allocation with move coalescing and further loop unrolling
+         (slower to compile, tighter code)
+*/
+struct CompilerOptions
+{
+    int opt_level = 1;
+
+    // Largest function (roughly in TAC instructions) which is inlined into its callers (-finline-limit=N)
+    int inline_threshold = 16;
+
+    // Largest loop (roughly in TAC instructions once unrolled) which is unrolled (-funroll-limit=N)
+    int unroll_threshold = 64;
+
+    // Vectorised loops use AVX2 (256 bit) rather than SSE2 (128 bit) instructions (-mavx2)
+    bool avx2 = false;
+
+    int get_vector_size() const { return avx2 ? 32 : 16; }
+
+    // Copies of the body a loop without a known trip count is unrolled into
+    int get_unroll_factor() const { return opt_level >= 2 ? 4 : 2; }
+};
@@ -10,11 +10,15 @@
 class Parser
 {
 public:
-    Parser(Lexer &l, std::string source_file);
-    std::shared_ptr<ProgramNode> parse();
+    // Every node parsed is created in (and owned by) arena
+    Parser(Lexer &l, std::string source_file, ASTArena &arena);
+    ProgramNode *parse();
 
 private:
     Lexer &lexer;
+    const std::vector<Token> &tokens; // Lexed up front so looking ahead/backtracking just moves position
+    size_t position = 0;
+    ASTArena &arena;
     std::string source_file;
     Token current_token;
 
@@ -38,29 +42,29 @@ private:
     void expect(const std::vector<TokenType> &tokens);
     void error(const std::string &message);
 
-    std::unique_ptr<FuncNode> parse_func_decl(const std::optional<std::vector<TokenType>> specifiers);
-    std::vector<std::unique_ptr<ASTNode>> parse_block();
-    void parse_param_list(std::unique_ptr<FuncNode> &func);
-    std::unique_ptr<RtnNode> parse_rtn();
-    std::unique_ptr<VarNode> parse_var_declarator(const std::optional<std::vector<TokenType>> specifiers);
-    std::unique_ptr<VarDeclNode> parse_var_decl(const std::optional<std::vector<TokenType>> specifiers);
-    std::unique_ptr<VarAssignNode> parse_var_assign();
-    std::unique_ptr<ASTNode> parse_factor();
-    std::unique_ptr<ASTNode> parse_expr(int min_precedence = 0);
-    std::unique_ptr<IfNode> parse_if_stmt();
-    std::unique_ptr<WhileNode> parse_while_stmt();
-    std::unique_ptr<ForNode> parse_for_stmt();
-    std::unique_ptr<ASTNode> parse_for_init();
-    std::unique_ptr<ASTNode> parse_loop_control();
-    void parse_args_list(std::unique_ptr<FuncCallNode> &func_call);
-    std::unique_ptr<AggregateLiteral> parse_aggregate_literal(const Type &type = Type(BaseType::VOID));
-    std::unique_ptr<ASTNode> parse_cast();
-    std::unique_ptr<ASTNode> parse_unary_operation();
-    std::unique_ptr<ASTNode> parse_number_literal();
-    std::unique_ptr<ASTNode> parse_lvalue(const Specifier &specifier = Specifier::NONE);
-    std::unique_ptr<ASTNode> parse_struct_decl();
-    std::unique_ptr<ASTNode> parse_sizeof();
-    std::unique_ptr<ASTNode> parse_import();
+    FuncNode *parse_func_decl(const std::optional<std::vector<TokenType>> specifiers);
+    std::vector<ASTNode *> parse_block();
+    void parse_param_list(FuncNode *func);
+    RtnNode *parse_rtn();
+    VarNode *parse_var_declarator(const std::optional<std::vector<TokenType>> specifiers);
+    VarDeclNode *parse_var_decl(const std::optional<std::vector<TokenType>> specifiers);
+    VarAssignNode *parse_var_assign();
+    ASTNode *parse_factor();
+    ASTNode *parse_expr(int min_precedence = 0);
+    IfNode *parse_if_stmt();
+    WhileNode *parse_while_stmt();
+    ForNode *parse_for_stmt();
+    ASTNode *parse_for_init();
+    ASTNode *parse_loop_control();
+    void parse_args_list(FuncCallNode *func_call);
+    AggregateLiteral *parse_aggregate_literal(const Type &type = Type(BaseType::VOID));
+    ASTNode *parse_cast();
+    ASTNode *parse_unary_operation();
+    ASTNode *parse_number_literal();
+    ASTNode *parse_lvalue(const Specifier &specifier = Specifier::NONE);
+    ASTNode *parse_struct_decl();
+    ASTNode *parse_sizeof();
+    ASTNode *parse_import();
 
     int get_precedence(const TokenType &op);
     Type determine_type(const std::vector<TokenType> &types);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+    A single line of emitted assembly
+    Instructions are split into their mnemonic and operands so the peephole optimiser can match on them
+    whilst everything else (labels, comments, directives) is kept as it was written
+*/
+struct MachineInstr
+{
+    enum class Kind
+    {
+        INSTRUCTION,
+        LABEL,
+        COMMENT, // Also blank lines
+        DIRECTIVE,
+    };
+
+    Kind kind;
+    std::string op; // Mnemonic (or the name of a label)
+    std::vector<std::string> operands;
+    std::string text; // The line as it is written out
+
+    static MachineInstr parse(const std::string &line);
+
+    // Replaces an instruction's mnemonic/operands (regenerating its text)
+    void set(const std::string &new_op, const std::vector<std::string> &new_operands);
+};
+
+/*
+    Cleans up the instructions the assembler emits one TAC instruction at a time
+    - Self moves (other than movl which zero extends) are removed
+    - A load straight after a store to the same place reuses the stored register
+    - Values moved through the scratch registers (%r10/%r11) are operated on (or compared) in place
+    - Moves into a scratch register which is never read are removed
+    - Jumps to the label which immediately follows are removed
+    - A materialised boolean which is only branched on jumps on the original comparison's flags
+
+    The scratch registers are only ever used within the instructions for a single TAC instruction
+    so they are never live across a label, jump or call
+*/
+class PeepholeOptimiser
+{
+public:
+    void optimise(std::vector<MachineInstr> &instructions);
+
+private:
+    std::vector<MachineInstr> *instructions = nullptr;
+
+    size_t next(size_t i) const;
+    void erase(size_t i);
+
+    bool is_scratch_dead_after(size_t i, const std::string &reg) const;
+
+    bool remove_self_moves();
+    bool forward_stores();
+    bool fold_scratch_ops();
+    bool remove_dead_scratch_moves();
+    bool remove_jumps_to_next();
+    bool fuse_compare_branches();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "tacGenerator.h"
+
+enum class AllocStrategy
+{
+    LINEAR_SCAN,
+    GRAPH_COLOURING,
+};
+
+struct LiveInterval
+{
+    std::string name;
+    int start = -1;
+    int end = -1;
+    bool is_double = false;
+    bool crosses_call = false; // Live across a CALL (so caller-saved registers can't be used)
+    std::vector<int> points;   // Instructions where the value is either needed or written
+    int weight = 0;            // Number of references (used to pick what to spill)
+    std::string hint = "";     // Argument register this is moved to/from (so the move can be removed)
+    std::string reg = "";
+};
+
+/*
+    Assigns registers to scalar locals/temporaries between TAC generation and assembly
+    Anything not assigned a register keeps its stack slot (i.e. is spilled)
+
+    - Integers not live across a call prefer the argument registers (whilst they aren't holding arguments)
+    - Otherwise integers use the callee-saved registers (which the assembler never touches otherwise)
+    - Doubles use xmm8-xmm15 but only when they aren't live across a call (all xmm registers are caller-saved)
+
+    Linear scan is fast whilst graph colouring (Chaitin/Briggs) also coalesces copies
+*/
+class RegisterAllocator
+{
+public:
+    RegisterAllocator(std::shared_ptr<GlobalSymbolTable> gst, AllocStrategy strategy = AllocStrategy::LINEAR_SCAN);
+
+    void allocate(const std::vector<TACInstruction> &instructions);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+    AllocStrategy strategy;
+
+    const std::vector<std::string> caller_saved_registers = {"%rsi", "%rdi", "%rcx", "%r8", "%r9"};
+    const std::vector<std::string> callee_saved_registers = {"%rbx", "%r12", "%r13", "%r14", "%r15"};
+    const std::vector<std::string> xmm_registers = {"%xmm8", "%xmm9", "%xmm10", "%xmm11",
+                                                    "%xmm12", "%xmm13", "%xmm14", "%xmm15"};
+
+    // Ranges (within the current function) where an argument register is holding a value
+    std::unordered_map<std::string, std::vector<std::pair<int, int>>> reserved_ranges;
+
+    void allocate_func(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+
+    std::vector<LiveInterval> build_intervals(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+                                              const Liveness &liveness);
+    void reserve_arg_registers(const std::vector<TACInstruction> &instructions, size_t begin, size_t end);
+    bool can_use_reg(const LiveInterval &interval, const std::string &reg);
+    bool is_callee_saved(const std::string &reg);
+    std::string pick_register(const LiveInterval &interval, const std::vector<std::string> &free_regs,
+                              const std::unordered_set<std::string> &used_callee_saved);
+
+    std::vector<std::string> find_candidates(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+                                             const Liveness &liveness);
+    Type get_access_type(const TACInstruction &instruction, const std::string &name);
+
+    void linear_scan(std::vector<LiveInterval> &intervals);
+
+    void colour_graph(std::vector<LiveInterval> &intervals, const std::vector<TACInstruction> &instructions,
+                      size_t begin, size_t end, const Liveness &liveness);
+};
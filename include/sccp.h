@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "ssa.h"
+
+/*
+    Helpers for integer literals appearing as TAC operands
+    Values are held as 64 bits and normalised (truncated and sign/zero extended) to the type they're used as
+*/
+bool parse_int_literal(const std::string &str, long long &value);
+long long normalise_int(long long value, const Type &type);
+std::string format_int_literal(long long value, const Type &type);
+long long min_int_value(const Type &type);
+
+/*
+    Sparse conditional constant propagation (Wegman and Zadeck) over a function in SSA form
+    - Integer expressions whose operands are constant are folded into a single ASSIGN
+    - Constants (including those of const globals) are substituted into the instructions which use them
+    - IFs whose outcome is known become a GOTO (or are removed) and blocks only reached through
+      branches which are never taken are left unreachable (so they can be removed afterwards)
+*/
+class SCCP
+{
+public:
+    SCCP(std::shared_ptr<GlobalSymbolTable> gst, const std::unordered_map<std::string, long long> &const_globals);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg, const SSA &ssa);
+
+private:
+    enum class State
+    {
+        TOP,    // No value seen yet (optimistically anything)
+        CONST,  // Always the same value
+        BOTTOM, // Varies (or isn't known at compile time)
+    };
+
+    struct LatticeValue
+    {
+        State state = State::TOP;
+        long long value = 0;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+    const std::unordered_map<std::string, long long> &const_globals;
+
+    const SSA *ssa = nullptr;
+    std::unordered_map<std::string, LatticeValue> values;
+    std::vector<bool> executable_blocks;
+    std::vector<std::vector<int>> executable_edges; // Executable predecessors of each block
+
+    bool is_tracked(const Type &type) const;
+    LatticeValue get_value(const std::string &operand);
+    LatticeValue evaluate(const TACInstruction &instruction, const Type &result_type);
+    LatticeValue evaluate_binary(TACOp op, LatticeValue a, LatticeValue b, const Type &type);
+    LatticeValue evaluate_condition(const TACInstruction &instruction);
+
+    static LatticeValue meet(const LatticeValue &a, const LatticeValue &b);
+
+    bool update(const std::string &name, const LatticeValue &value);
+    bool mark_edge(int from, int to);
+
+    void propagate(ControlFlowGraph &cfg);
+    bool rewrite(ControlFlowGraph &cfg);
+    void substitute(TACInstruction &instruction, TACField field, bool &changed);
+};
@@ -12,9 +12,10 @@
 class SemanticAnalyser
 {
 public:
-    SemanticAnalyser(std::shared_ptr<GlobalSymbolTable> gst, std::string module_name);
+    // Any nodes added to the tree (e.g. implicit casts) are created in arena
+    SemanticAnalyser(std::shared_ptr<GlobalSymbolTable> gst, std::string module_name, ASTArena &arena);
 
-    void analyse(std::shared_ptr<ProgramNode> &program);
+    void analyse(ProgramNode *program);
 
     Type infer_type(ASTNode *node, std::optional<std::string> struct_name = std::nullopt);
 
@@ -22,6 +23,7 @@ private:
     std::unordered_map<NodeType, std::function<void(ASTNode *)>> handlers;
     std::shared_ptr<GlobalSymbolTable> gst;
     std::string module_name;
+    ASTArena &arena;
 
     unsigned int loop_label_counter = 0;
     std::string gen_new_loop_label();
@@ -51,9 +53,9 @@ private:
 
     void analyse_specifiers(const std::vector<Specifier> &specifiers, ASTNode *node);
 
-    bool try_promote_literal(std::unique_ptr<ASTNode> &expr, const Type &target);
+    bool try_promote_literal(ASTNode *&expr, const Type &target);
 
-    void validate_type_assignment(Type &target_type, std::unique_ptr<ASTNode> &source_expr, const std::string &context);
+    void validate_type_assignment(Type &target_type, ASTNode *&source_expr, const std::string &context);
 
     void error(const std::string &message, const SourceLocation &loc);
 };
\ No newline at end of file
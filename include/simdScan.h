@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/*
+    Scanning used by the lexer to find where a run of characters ends 16 or 32 characters at a time
+    - AVX2 when the CPU supports it (checked once, the first time anything is scanned)
+    - Otherwise SSE2 (which every x86-64 CPU has)
+    - Otherwise (or for the last few characters of the text) one character at a time
+    Characters outside ASCII never count as whitespace, letters or digits
+
+    Each returns the index it stopped at (text.length() when it reached the end)
+*/
+
+// Skips spaces, tabs, newlines, carriage returns, vertical tabs and form feeds
+size_t skip_whitespace(std::string_view text, size_t from);
+
+// Skips letters and digits
+size_t skip_alnum(std::string_view text, size_t from);
+
+size_t skip_digits(std::string_view text, size_t from);
+
+size_t find_char(std::string_view text, size_t from, char c);
+
+// Finds whichever of the two comes first
+size_t find_either_char(std::string_view text, size_t from, char a, char b);
+
+// The number of newlines in [from, to)
+size_t count_newlines(std::string_view text, size_t from, size_t to);
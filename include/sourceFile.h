@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*
+    A source file mapped (read only) into memory so it can be lexed where it is rather than being copied
+    The tokens lexed from it are spans of the mapping so it has to outlive them
+*/
+class SourceFile
+{
+public:
+    SourceFile() = default;
+    SourceFile(const SourceFile &) = delete;
+    SourceFile &operator=(const SourceFile &) = delete;
+    ~SourceFile();
+
+    void open(const std::string &path);
+
+    std::string_view get_contents() const { return std::string_view(data, size); }
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+
+    void close();
+};
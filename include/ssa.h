@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+
+/*
+    Converts a function's CFG to (pruned) SSA form and back again (mem2reg)
+
+    Only scalar locals/temporaries which never have their address taken are promoted
+    Each definition of one gets a fresh version (x.1, x.2...) declared with the same type
+    and PHIs are placed on the iterated dominance frontier wherever the variable is live
+
+    Anything which is only defined once is already in SSA form so keeps its name
+
+    Destruction replaces each PHI with a copy from a fresh variable which every predecessor
+    writes to just before it leaves (so no edges need splitting and parallel copies stay correct)
+*/
+class SSA
+{
+public:
+    SSA(std::shared_ptr<GlobalSymbolTable> gst);
+
+    void construct(ControlFlowGraph &cfg);
+    void destruct(ControlFlowGraph &cfg);
+
+    // Whether a name is an SSA value (defined at most once) rather than a location in memory
+    bool is_ssa_value(const std::string &name) const;
+
+    // Declares a fresh SSA value (name.N) for a pass which introduces values of its own
+    std::string new_value(const std::string &name, const Type &type);
+
+private:
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    std::unordered_set<std::string> promoted;
+    std::unordered_set<std::string> ssa_values;
+
+    std::unordered_map<std::string, int> versions;
+    std::unordered_map<std::string, std::vector<std::string>> stacks;
+    int copy_count = 0;
+
+    void find_promotable(const ControlFlowGraph &cfg);
+    std::vector<std::unordered_set<std::string>> compute_live_in(const ControlFlowGraph &cfg);
+    void insert_phis(ControlFlowGraph &cfg);
+    void rename(ControlFlowGraph &cfg, int block);
+
+    std::string new_version(const std::string &name);
+    const std::string &current_version(const std::string &name);
+};
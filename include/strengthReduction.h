@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+#include "liveness.h"
+#include "ssa.h"
+
+/*
+    Induction variable strength reduction over a function in SSA form
+    A basic induction variable is a PHI in a loop header which is stepped by a constant each
+    iteration (i = i + c). Multiplying one by a constant (e.g. scaling the index of arr[i]) is
+    replaced with a new induction variable which starts at init * k and is stepped by c * k
+    so each iteration does an add rather than a multiply
+    Multiplies only used to index arrays by 1, 2, 4 or 8 are left since addressing can scale by those
+*/
+class StrengthReduction
+{
+public:
+    StrengthReduction(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg, SSA &ssa);
+
+private:
+    struct InductionVariable
+    {
+        std::string phi;  // Value at the start of each iteration
+        std::string init; // Value coming in from the preheader
+        std::string next; // Value going round the back edge
+        long long step;
+        Type type;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    SSA *ssa = nullptr;
+
+    std::vector<InductionVariable> find_induction_variables(const ControlFlowGraph &cfg, const Loop &loop,
+                                                            int preheader);
+    bool find_multiply(const ControlFlowGraph &cfg, const Loop &loop, const InductionVariable &iv, int &block,
+                       size_t &index, long long &factor);
+
+    bool is_only_index(const ControlFlowGraph &cfg, const std::string &name) const;
+    void replace_uses(ControlFlowGraph &cfg, const std::string &from, const std::string &to);
+    bool reduce(ControlFlowGraph &cfg, const std::string &header_label);
+};
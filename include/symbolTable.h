@@ -38,6 +38,7 @@ struct Symbol
     bool is_literal8 = false;
     std::vector<Specifier> specifiers;
     bool is_global = false;
+    std::string reg = ""; // Register assigned by the register allocator (empty if it lives on the stack)
 
     Symbol(std::string n, int o, Type t, std::vector<Specifier> s);
 
@@ -74,8 +75,12 @@ public:
     std::tuple<bool, std::string> check_var_defined(const std::string &name);
 
     int get_stack_size();
+    void set_stack_size(int size); // Once the frame has been laid out (see FrameLayout)
     Symbol *get_symbol(const std::string &name);
 
+    void add_saved_reg(const std::string &reg);
+    const std::vector<std::string> &get_saved_regs() const;
+
     void print();
 
 private:
@@ -89,4 +94,7 @@ private:
 
     int var_count = 0;
     int stack_size = 0;
+
+    // Callee-saved registers used within the function (which must be preserved)
+    std::vector<std::string> saved_regs;
 };
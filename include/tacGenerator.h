@@ -56,6 +56,19 @@ enum class TACOp
   PRINTF,
   STRUCT_INIT,
   ASSIGN_DEREF,
+  PHI, // Only present whilst in SSA form
+  /*
+    Vector operations (only made by the loop vectoriser)
+    Vector values live in %v registers which aren't symbols (see LoopVectoriser)
+  */
+  VEC_LOAD,   // VEC_LOAD array, index -> %v
+  VEC_STORE,  // VEC_STORE array, index -> %v
+  VEC_SPLAT,  // Every lane gets the same scalar
+  VEC_ADD,
+  VEC_SUB,
+  VEC_MUL,
+  VEC_DIV,
+  VEC_END,    // After the vector loop (clears the upper halves of the AVX registers)
 };
 
 TACOp convert_UnaryOpType_to_TACOp(UnaryOpType op);
@@ -72,6 +85,13 @@ struct TACInstruction
   BinOpType cmp_op; // Optional argument
   std::string arg3; // Another optional argument
 
+  std::vector<std::pair<int, std::string>> phi_args; // (Predecessor block, value) for PHI
+
+  // An indexed ASSIGN whose index arithmetic has been folded into the address (see AddressFolding)
+  // i.e. the byte offset is arg2 * scale + displacement
+  int scale = 1;
+  int displacement = 0;
+
   TACInstruction(TACOp op, const std::string &arg1 = "",
                  const std::string &arg2 = "", const std::string &result = "",
                  Type type = Type(BaseType::VOID))
@@ -85,7 +105,7 @@ public:
   TacGenerator(std::shared_ptr<GlobalSymbolTable> gst,
                std::shared_ptr<SemanticAnalyser> sem_analyser);
 
-  void generate_all_tac(std::shared_ptr<ProgramNode> &program);
+  void generate_all_tac(ProgramNode *program);
   void print_all_tac();
   static std::string gen_tac_str(const TACInstruction &instruction);
 
@@ -94,6 +114,8 @@ public:
     return instructions;
   }
 
+  std::vector<TACInstruction> &get_instructions() { return instructions; }
+
 private:
   std::shared_ptr<GlobalSymbolTable> gst;
   std::shared_ptr<SemanticAnalyser> sem_analyser;
@@ -147,6 +169,7 @@ private:
   std::string generate_tac_expr_string(ASTNode *expr);
   std::string generate_tac_expr_unary(ASTNode *expr);
   std::string generate_tac_expr_binary(ASTNode *expr);
+  std::string generate_tac_expr_logical(BinaryNode *bin_node);
   std::string generate_tac_expr_postfix(ASTNode *expr);
   std::string generate_tac_expr_array_access(ASTNode *expr);
   std::string generate_tac_expr_func_call(ASTNode *expr);
@@ -155,8 +178,8 @@ private:
 
   void generate_tac_var_array_assign(VarNode *var_node, Symbol *var_symbol,
                                      ASTNode *value);
-  void generate_tac_cmp(ASTNode *condition, const std::string &label_success,
-                        const std::string &label_failure);
+  void generate_tac_cmp(ASTNode *condition, const std::string &label,
+                        bool jump_if);
   void generate_tac_struct_assign(VarNode *var, ASTNode *value,
                                   std::string memory_region = "text");
   std::string get_const_label(double value);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "globalSymbolTable.h"
+
+/*
+    Turns self recursion in tail position into a loop (run before the function is put into SSA form)
+    - return f(a, b) copies the arguments into the parameters and jumps back to just after the entry
+    - return x * f(a) / return x + f(a) keeps an accumulator instead (acc = acc * x) which every other
+      return is combined with, so factorial style recursion no longer needs a frame per call
+    Functions which take the address of anything are left alone since the parameters/locals of each call
+    would then be shared
+*/
+class TailRecursionElimination
+{
+public:
+    TailRecursionElimination(std::shared_ptr<GlobalSymbolTable> gst);
+
+    // Returns whether anything changed
+    bool run(ControlFlowGraph &cfg);
+
+private:
+    struct Param
+    {
+        std::string name;
+        Type type;
+    };
+
+    struct TailCall
+    {
+        int block;
+        size_t call;                    // Index of the CALL
+        std::vector<size_t> arg_loads;  // Indexes of the MOV_BETWEEN_REG loads (one per parameter)
+        TACOp accumulate = TACOp::NOP;  // ADD/MUL when the result is combined with accumulated
+        std::string accumulated;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+
+    std::string func_name;
+    Type return_type;
+    std::unordered_map<std::string, Param> params; // By the register each one is passed in
+
+    int new_var_count = 0;
+
+    bool find_params(const ControlFlowGraph &cfg);
+    bool reaches_exit(const ControlFlowGraph &cfg, int block) const;
+    bool is_accumulable(const std::string &operand) const;
+
+    bool match_tail_call(const ControlFlowGraph &cfg, int block, TailCall &tail_call) const;
+    bool find_arg_loads(const std::vector<TACInstruction> &instructions, TailCall &tail_call) const;
+
+    std::string new_var(const std::string &name, const Type &type);
+};
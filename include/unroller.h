@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "options.h"
+#include "tacGenerator.h"
+
+/*
+    Unrolls counted for loops (run before the rest of the optimiser, after the vectoriser)
+    i.e. for (int i = a; i < n; i++) { ... } where nothing in the body changes i or n
+
+    - When a and n are both literals the whole loop is replaced by a copy of the body per iteration
+      (as long as that comes to no more than the unroll threshold)
+    - Otherwise an unrolled loop doing several iterations per check is put in front of the original loop
+      which is left to do the remainder (how many depends on the optimisation level)
+
+    Each copy gets its own labels so any control flow within the body (including continue) stays within the copy
+    Inner loops are unrolled before the loops they are in
+*/
+class LoopUnroller
+{
+public:
+    LoopUnroller(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options);
+
+    // Returns whether anything changed
+    bool run(std::vector<TACInstruction> &instructions);
+
+private:
+    struct Loop
+    {
+        size_t start; // LABEL at the top (the condition follows)
+        size_t post;  // LABEL before the increment
+        size_t end;   // LABEL after the loop
+        std::string counter;
+        std::string bound;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
+
+    int copy_count = 0;
+
+    bool match_loop(const std::vector<TACInstruction> &instructions, size_t start, size_t func_end, Loop &loop) const;
+    bool is_countable(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+                      const Loop &loop) const;
+    bool get_trip_count(const std::vector<TACInstruction> &instructions, size_t begin, const Loop &loop,
+                        long long &trip_count) const;
+    size_t get_cost(const std::vector<TACInstruction> &instructions, const Loop &loop) const;
+
+    // The body and increment with every label in them renamed
+    std::vector<TACInstruction> copy_body(const std::vector<TACInstruction> &instructions, const Loop &loop);
+
+    void unroll_fully(std::vector<TACInstruction> &instructions, const Loop &loop, long long trip_count);
+    void unroll_partially(std::vector<TACInstruction> &instructions, const Loop &loop, int factor);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "globalSymbolTable.h"
+#include "options.h"
+#include "tacGenerator.h"
+
+/*
+    Vectorises counted for loops over int, long and double arrays (run before the rest of the optimiser)
+    i.e. for (int i = 0; i < n; i++) { c[i] = a[i] * b[i] + x; }
+
+    - The body may only be arithmetic on elements at index i (so no iteration depends on another)
+      and values which don't change within the loop
+    - A vector loop doing a whole register's worth of iterations at once is put in front of the original loop
+      which is left to do the remainder
+    - Values which don't change are splatted across a register once before the loop
+
+    Vector values are kept in %v registers (%v2 to %v7 which are %xmm2-%xmm7 or %ymm2-%ymm7)
+    each being reused once the value in it is no longer needed
+    These aren't symbols so the rest of the optimiser and the register allocator leave them alone
+*/
+class LoopVectoriser
+{
+public:
+    LoopVectoriser(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options);
+
+    // Returns whether anything changed
+    bool run(std::vector<TACInstruction> &instructions);
+
+    static constexpr int FIRST_VEC_REG = 2;
+    static constexpr int LAST_VEC_REG = 7;
+
+private:
+    struct Loop
+    {
+        size_t start; // LABEL at the top (the condition follows)
+        size_t body;  // First instruction of the body
+        size_t post;  // LABEL before the increment
+        size_t end;   // LABEL after the loop
+        std::string counter;
+        std::string bound;
+    };
+
+    std::shared_ptr<GlobalSymbolTable> gst;
+    CompilerOptions options;
+
+    // State for the loop being vectorised
+    Type element_type;
+    std::unordered_map<std::string, std::string> values; // Temporaries held in vector registers
+    std::unordered_map<std::string, std::string> splats; // Loop invariant scalars splatted into vector registers
+    std::unordered_set<std::string> body_defs;
+    std::unordered_map<std::string, size_t> last_uses; // Last instruction in the body each value is used by
+    std::unordered_set<std::string> written;                   // Registers values have been put in
+    size_t current = 0;
+
+    int new_var_count = 0;
+
+    bool match_loop(const std::vector<TACInstruction> &instructions, size_t start, size_t func_end, Loop &loop) const;
+    bool vectorise_body(const std::vector<TACInstruction> &instructions, const Loop &loop,
+                        std::vector<TACInstruction> &body);
+    bool is_used_outside(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+                         const Loop &loop) const;
+
+    bool set_element_type(const Type &type);
+    bool get_operand(const std::string &operand, const std::string &counter, std::string &reg);
+    std::string new_reg(bool is_splat = false);
+    std::string new_var(const std::string &name, const Type &type);
+};
@@ -28,6 +28,9 @@ echo -e "${GREEN}Build successful${NC}\n"
 
 make || { echo "Build failed."; exit 1; }
 
+# Every test is run at each of these (and compared against the same .out file)
+levels=("-O0" "-O1" "-O2" "-O2 -mavx2")
+
 : '
     For each test file (denoted by the .ss.in extension) in the tests directory
     -   Compile each test file using the ssc compiler
@@ -35,8 +38,9 @@ make || { echo "Build failed."; exit 1; }
     -   Execute the compiled binary
 '
 
+for level in "${levels[@]}"; do
 for filepath in $(find ../tests -name "*.ss"); do
-    echo -e "${BLUE}Testing: ${filepath}${NC}"
+    echo -e "${BLUE}Testing: ${filepath} (${level})${NC}"
 
     : '
         First determine the appropriate filenames to use
@@ -62,7 +66,7 @@ for filepath in $(find ../tests -name "*.ss"); do
     filename_out="${test_directory}/${base_filename}.out"
 
     # Compile the test file using the ssc compiler
-    ./ssc "$filepath" > /dev/null 2>&1 || {
+    ./ssc $level "$filepath" > /dev/null 2>&1 || {
         echo -e "${RED}✗ Compilation failed${NC}\n"
         ((failed++))
         continue
@@ -103,4 +107,5 @@ for filepath in $(find ../tests -name "*.ss"); do
     echo "-----------------------------------"
     echo
 
+done
 done
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "../include/addressFolding.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "../include/liveness.h"
+#include "../include/sccp.h"
+
+AddressFolding::AddressFolding(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool AddressFolding::run(std::vector<TACInstruction> &instructions)
+{
+	bool changed = false;
+	auto ranges = find_func_ranges(instructions);
+
+	// Work backwards so removing instructions doesn't move the functions still to be done
+	for (auto it = ranges.rbegin(); it != ranges.rend(); it++)
+	{
+		auto [begin, end] = *it;
+
+		gst->enter_func_scope(instructions[begin].arg1);
+		count(instructions, begin, end);
+
+		std::vector<size_t> dead;
+		size_t block_start = begin;
+
+		for (size_t i = begin; i <= end; i++)
+		{
+			if (instructions[i].op == TACOp::LABEL)
+				block_start = i;
+			else if (instructions[i].op == TACOp::ASSIGN && !instructions[i].arg2.empty())
+				changed |= fold_access(instructions, block_start, i, dead);
+		}
+
+		std::sort(dead.rbegin(), dead.rend());
+		for (size_t i : dead)
+			instructions.erase(instructions.begin() + i);
+
+		gst->leave_func_scope();
+	}
+
+	return changed;
+}
+
+void AddressFolding::count(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	def_counts.clear();
+	use_counts.clear();
+	def_positions.clear();
+	address_taken.clear();
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		if (instruction.op == TACOp::ADDR_OF)
+			address_taken.insert(instruction.arg1);
+
+		for (auto &def : get_tac_defs(instruction, gst.get()))
+		{
+			def_counts[def]++;
+			def_positions[def] = i;
+		}
+		for (auto &use : get_tac_uses(instruction, gst.get()))
+			use_counts[use]++;
+	}
+}
+
+bool AddressFolding::is_index_operand(const std::string &name) const
+{
+	// Indexes are sign/zero extended to 64 bits before being used in an address (see Assembler::emit_index_load)
+	Symbol *symbol = gst->get_symbol(name);
+	return is_local_symbol(symbol) && !address_taken.count(name) && symbol->type.is_integral() &&
+		   !symbol->type.is_pointer() && !symbol->type.is_array() &&
+		   (symbol->type.get_size() == 4 || symbol->type.get_size() == 8);
+}
+
+bool AddressFolding::is_redefined(const std::vector<TACInstruction> &instructions, const std::string &name,
+								  size_t from, size_t to) const
+{
+	for (size_t i = from + 1; i < to; i++)
+		for (auto &def : get_tac_defs(instructions[i], gst.get()))
+			if (def == name)
+				return true;
+
+	return false;
+}
+
+bool AddressFolding::fold_access(std::vector<TACInstruction> &instructions, size_t block_start, size_t access,
+								 std::vector<size_t> &dead)
+{
+	TACInstruction &instruction = instructions[access];
+
+	if (instruction.scale != 1 || instruction.displacement != 0 || !is_index_operand(instruction.arg2))
+		return false;
+
+	/*
+		Which of the two is indexed (the same way Assembler::emit_text_assign decides)
+		A struct index is a byte offset within the frame whereas any other constant index counts elements
+	*/
+	Symbol *src = gst->get_symbol(instruction.result);
+	Symbol *dst = gst->get_symbol(instruction.arg1);
+	Symbol *base = nullptr;
+
+	if (src && (src->type.is_array() || src->type.is_pointer() || src->type.is_struct()))
+		base = src;
+	else if (dst && (dst->type.is_array() || dst->type.is_struct()))
+		base = dst;
+
+	// Char arrays/pointers are only ever loaded by address (and struct pointers by field offset)
+	if (!is_local_symbol(base) || base->type.has_base_type(BaseType::CHAR) ||
+		(base->type.is_pointer() && base->type.is_struct()))
+		return false;
+
+	bool is_struct = base->type.is_struct() && !base->type.is_pointer();
+	long long element_size = is_struct ? 1 : instruction.type.get_size();
+
+	std::string index = instruction.arg2;
+	long long scale = 1;
+	long long displacement = 0;
+	bool is_constant = false;
+	std::vector<size_t> folded;
+
+	while (def_counts[index] == 1 && !address_taken.count(index))
+	{
+		size_t pos = def_positions[index];
+		if (pos <= block_start || pos >= access)
+			break;
+
+		const TACInstruction &def = instructions[pos];
+		const Type &type = def.type;
+		if (!type.is_integral() || type.is_pointer() || (type.get_size() != 4 && type.get_size() != 8))
+			break;
+
+		long long value;
+		std::string operand;
+		long long next_scale = scale;
+		long long next_displacement = displacement;
+
+		if (def.op == TACOp::ASSIGN && def.arg2.empty() && !gst->get_symbol(def.result) &&
+			parse_int_literal(def.result, value))
+		{
+			// The whole index is known
+			displacement += normalise_int(value, type) * scale;
+			folded.push_back(pos);
+			is_constant = true;
+			break;
+		}
+		else if (def.op == TACOp::ADD && !gst->get_symbol(def.arg1) && parse_int_literal(def.arg1, value))
+		{
+			operand = def.arg2;
+			next_displacement += normalise_int(value, type) * scale;
+		}
+		else if ((def.op == TACOp::ADD || def.op == TACOp::SUB) && !gst->get_symbol(def.arg2) &&
+				 parse_int_literal(def.arg2, value))
+		{
+			operand = def.arg1;
+			next_displacement += (def.op == TACOp::ADD ? 1 : -1) * normalise_int(value, type) * scale;
+		}
+		else if (def.op == TACOp::MUL && scale == 1)
+		{
+			if (!gst->get_symbol(def.arg1) && parse_int_literal(def.arg1, value))
+				operand = def.arg2;
+			else if (!gst->get_symbol(def.arg2) && parse_int_literal(def.arg2, value))
+				operand = def.arg1;
+			else
+				break;
+
+			if (value != 1 && value != 2 && value != 4 && value != 8)
+				break;
+			next_scale = value;
+		}
+		else
+			break;
+
+		// What it was computed from has to still hold the same value at the access
+		if (!is_index_operand(operand) || is_redefined(instructions, operand, pos, access) ||
+			next_displacement < INT_MIN || next_displacement > INT_MAX)
+			break;
+
+		index = operand;
+		scale = next_scale;
+		displacement = next_displacement;
+		folded.push_back(pos);
+	}
+
+	if (folded.empty() || (is_constant && displacement % element_size != 0))
+		return false;
+
+	// Each instruction folded is only removed if the one after it in the chain was its only use
+	std::string used = instruction.arg2;
+	for (size_t pos : folded)
+	{
+		if (--use_counts[used] > 0)
+			break;
+
+		dead.push_back(pos);
+		def_counts[used] = 0;
+
+		const TACInstruction &def = instructions[pos];
+		used = gst->get_symbol(def.arg1) ? def.arg1 : def.arg2;
+		if (def.op == TACOp::ASSIGN)
+			break;
+	}
+
+	if (is_constant)
+		instruction.arg2 = std::to_string(displacement / element_size);
+	else
+	{
+		instruction.arg2 = index;
+		instruction.scale = scale;
+		instruction.displacement = displacement;
+		use_counts[index]++;
+	}
+
+	return true;
+}
@@ -1,6 +1,8 @@
 #include "../include/assembler.h"
 
 #include <cerrno>
+#include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <functional>
@@ -11,14 +13,15 @@
 #include <unordered_map>
 
 #include "../include/parser.h"
+#include "../include/sccp.h"
 #include "../include/tacGenerator.h"
 
 #define REGISTER_HANDLER(op, fn) \
 	handlers[TACOp::op] = [this](TACInstruction instr) { fn(instr); }
 
 Assembler::Assembler(std::shared_ptr<GlobalSymbolTable> &gst,
-					 const std::string &filename)
-	: gst(gst)
+					 const std::string &filename, const CompilerOptions &options)
+	: gst(gst), options(options)
 {
 	file = fopen(filename.c_str(), "w");
 	if (file == NULL)
@@ -68,7 +71,7 @@ Assembler::Assembler(std::shared_ptr<GlobalSymbolTable> &gst,
 					 { emit_cmp_op(instr, "sete"); });
 	REGISTER_HANDLER(NOT_EQUAL,
 					 [&](TACInstruction instr)
-					 { emit_cmp_op(instr, "sene"); });
+					 { emit_cmp_op(instr, "setne"); });
 	REGISTER_HANDLER(IF, emit_if);
 	REGISTER_HANDLER(GOTO, emit_goto);
 	REGISTER_HANDLER(LABEL, emit_label);
@@ -90,13 +93,31 @@ Assembler::Assembler(std::shared_ptr<GlobalSymbolTable> &gst,
 	REGISTER_HANDLER(ASSIGN_DEREF, emit_assign_deref);
 	REGISTER_HANDLER(PUSH, emit_push);
 	REGISTER_HANDLER(POP, emit_pop);
+	REGISTER_HANDLER(VEC_LOAD, emit_vec_load);
+	REGISTER_HANDLER(VEC_STORE, emit_vec_store);
+	REGISTER_HANDLER(VEC_SPLAT, emit_vec_splat);
+	REGISTER_HANDLER(VEC_ADD,
+					 [&](TACInstruction instr)
+					 { emit_vec_bin_op(instr, "add"); });
+	REGISTER_HANDLER(VEC_SUB,
+					 [&](TACInstruction instr)
+					 { emit_vec_bin_op(instr, "sub"); });
+	REGISTER_HANDLER(VEC_MUL,
+					 [&](TACInstruction instr)
+					 { emit_vec_bin_op(instr, "mul"); });
+	REGISTER_HANDLER(VEC_DIV,
+					 [&](TACInstruction instr)
+					 { emit_vec_bin_op(instr, "div"); });
+	REGISTER_HANDLER(VEC_END, emit_vec_end);
 }
 
 void Assembler::assemble(const std::vector<TACInstruction> &instructions)
 {
-	fprintf(file, ".section __TEXT,__text,regular,pure_instructions\n");
-	fprintf(file, ".build_version macos, 15, 0 sdk_version 15, 1\n");
-	fprintf(file, ".p2align 4, 0x90\n\n");
+	emit(".section __TEXT,__text,regular,pure_instructions\n");
+	emit(".build_version macos, 15, 0 sdk_version 15, 1\n");
+	emit(".p2align 4, 0x90\n\n");
+
+	find_leaf_funcs(instructions);
 
 	for (const auto &instruction : instructions)
 	{
@@ -104,13 +125,52 @@ void Assembler::assemble(const std::vector<TACInstruction> &instructions)
 		if (handler != handlers.end())
 			handler->second(instruction);
 		else
-			fprintf(file, "# Unknown TAC operation: %d\n",
+			emit("# Unknown TAC operation: %d\n",
 					static_cast<int>(instruction.op));
 	}
+
+	if (options.opt_level > 0)
+	{
+		PeepholeOptimiser peephole;
+		peephole.optimise(machine_instrs);
+	}
+
+	for (const auto &instr : machine_instrs)
+		fprintf(file, "%s\n", instr.text.c_str());
+	fprintf(file, "%s", pending_line.c_str());
+
+	fflush(file);
+}
+
+/*
+	Formats into the machine instruction list (a line at a time) rather than straight to the file
+*/
+void Assembler::emit(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	va_list size_args;
+	va_copy(size_args, args);
+	int size = vsnprintf(nullptr, 0, format, size_args);
+	va_end(size_args);
+
+	std::string text(size, '\0');
+	vsnprintf(text.data(), size + 1, format, args);
+	va_end(args);
+
+	pending_line += text;
+
+	size_t newline;
+	while ((newline = pending_line.find('\n')) != std::string::npos)
+	{
+		machine_instrs.push_back(MachineInstr::parse(pending_line.substr(0, newline)));
+		pending_line.erase(0, newline + 1);
+	}
 }
 
 void Assembler::emit_load(const std::string &operand, const char *reg,
-						  Type type, const std::string &arg2)
+						  Type type, const std::string &arg2, int scale, int displacement)
 {
 	Symbol *sym = gst->get_symbol(operand);
 	std::string mov = select_mov_instr(type);
@@ -118,7 +178,7 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 
 	if (!sym)
 	{
-		fprintf(file, "\t%s\t%s, %s\n", mov.c_str(),
+		emit("\t%s\t%s, %s\n", mov.c_str(),
 				format_mem_operand(operand).c_str(), reg_name.c_str());
 		return;
 	}
@@ -127,7 +187,7 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 	if (sym->type.has_base_type(BaseType::CHAR) &&
 		(sym->type.is_pointer() || sym->type.is_array()))
 	{
-		fprintf(file, "\tleaq\t%s, %s\n", format_mem_operand(operand).c_str(), reg);
+		emit("\tleaq\t%s, %s\n", format_mem_operand(operand).c_str(), reg);
 		return;
 	}
 
@@ -149,10 +209,10 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 		if (!field_sym)
 		{
 			if (sym->is_global)
-				fprintf(file, "\tmovl\t_%s+%d(%%rip), %s\n", operand.c_str(),
+				emit("\tmovl\t_%s+%d(%%rip), %s\n", operand.c_str(),
 						std::stoi(arg2), reg_name.c_str());
 			else
-				fprintf(file, "\tmovl\t%d(%%rbp), %s\n", std::stoi(arg2),
+				emit("\tmovl\t%d(%s), %s\n", std::stoi(arg2), frame_reg.c_str(),
 						reg_name.c_str());
 		}
 		else
@@ -162,9 +222,8 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 					It then will move the value on the stack at the offset of arg2
 			   into the register
 			*/
-			fprintf(file, "\tmovslq\t%s, %s\n", format_mem_operand(arg2).c_str(),
-					"%r10");
-			fprintf(file, "\tmovl\t(%%rbp, %%r10), %s\n", reg_name.c_str());
+			std::string mem = format_indexed_operand(frame_reg, arg2, "%r10", scale, displacement);
+			emit("\tmovl\t%s, %s\n", mem.c_str(), reg_name.c_str());
 		}
 
 		return;
@@ -177,7 +236,7 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 			/*
 				Case: pointer dereference (e.g., int val = *ptr;)
 			*/
-			fprintf(file, "\tmovq\t%d(%%rbp), %%r10\n", sym->stack_offset);
+			emit("\tmovq\t%d(%s), %%r10\n", sym->stack_offset, frame_reg.c_str());
 		}
 		else
 		{
@@ -191,17 +250,16 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 			{
 				// Index is a variable/temp - it's already scaled by TAC generator
 				// Just load and use it
-				fprintf(file, "\tmovl\t%d(%%rbp), %%r11d\n", index_sym->stack_offset);
-				fprintf(file, "\tmovslq\t%%r11d, %%r11\n");
+				std::string mem = format_indexed_operand("%r10", arg2, "%r11", scale, displacement);
 
 				std::string mov = select_mov_instr(type);
 				std::string reg_name = select_reg_name(reg, type);
 
 				// Load the pointer
-				fprintf(file, "\tmovq\t%d(%%rbp), %%r10\n", sym->stack_offset);
+				emit("\tmovq\t%d(%s), %%r10\n", sym->stack_offset, frame_reg.c_str());
 
 				// Load the value at pointer + index
-				fprintf(file, "\t%s\t(%%r10, %%r11), %s\n", mov.c_str(), reg_name.c_str());
+				emit("\t%s\t%s, %s\n", mov.c_str(), mem.c_str(), reg_name.c_str());
 			}
 			else
 			{
@@ -211,10 +269,10 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 				int offset = std::stoi(arg2) * type.get_size();
 
 				// Load pointer into %r10
-				fprintf(file, "\tmovq\t%d(%%rbp), %%r10\n", sym->stack_offset);
+				emit("\tmovq\t%d(%s), %%r10\n", sym->stack_offset, frame_reg.c_str());
 
 				// Load from pointer with offset: mov offset(%r10), reg
-				fprintf(file, "\t%s\t%d(%%r10), %s\n", mov.c_str(), offset, reg_name.c_str());
+				emit("\t%s\t%d(%%r10), %s\n", mov.c_str(), offset, reg_name.c_str());
 			}
 		}
 
@@ -229,7 +287,7 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 					Case: array-to-pointer decay (get address of array start)
 					(e.g, int* p = array;)
 			*/
-			fprintf(file, "\tleaq\t%d(%%rbp), %s\n", sym->stack_offset, reg);
+			emit("\tleaq\t%d(%s), %s\n", sym->stack_offset, frame_reg.c_str(), reg);
 		}
 		else
 		{
@@ -244,40 +302,76 @@ void Assembler::emit_load(const std::string &operand, const char *reg,
 			{
 				// Index is a variable/temp - it's already scaled by TAC generator
 				// Just load and use it
-				fprintf(file, "\tmovl\t%d(%%rbp), %%r11d\n", index_sym->stack_offset);
-				fprintf(file, "\tmovslq\t%%r11d, %%r11\n");
+				std::string mem = format_indexed_operand(frame_reg, arg2, "%r11", scale,
+														 sym->stack_offset + displacement);
 
 				std::string mov = select_mov_instr(type);
 				std::string reg_name = select_reg_name(reg, type);
 
 				// Load: array[base + index]
-				fprintf(file, "\t%s\t%d(%%rbp, %%r11), %s\n",
-						mov.c_str(),
-						sym->stack_offset,
-						reg_name.c_str());
+				emit("\t%s\t%s, %s\n", mov.c_str(), mem.c_str(), reg_name.c_str());
 			}
 			else
 			{
 				// Index is a constant - calculate offset at compile time
 
 				int offset = sym->stack_offset + std::stoi(arg2) * type.get_size();
-				fprintf(file, "\t%s\t%d(%%rbp), %s\n", mov.c_str(), offset, reg_name.c_str());
+				emit("\t%s\t%d(%s), %s\n", mov.c_str(), offset, frame_reg.c_str(), reg_name.c_str());
 			}
 		}
 
 		return;
 	}
 
-	fprintf(file, "\t%s\t%s, %s\n", mov.c_str(),
+	emit("\t%s\t%s, %s\n", mov.c_str(),
 			format_mem_operand(operand).c_str(), reg_name.c_str());
 }
 
+/*
+	Loads an index (already scaled into a byte offset) into a 64 bit register for addressing
+	Sign extends straight from the operand rather than loading it and then extending
+*/
+void Assembler::emit_index_load(const std::string &index, const char *reg)
+{
+	Symbol *sym = gst->get_symbol(index);
+
+	if (sym->type.is_size_8())
+		emit("\tmovq\t%s, %s\n", format_mem_operand(index).c_str(), reg);
+	else if (!sym->type.is_signed())
+		emit("\tmovl\t%s, %s\n", format_mem_operand(index).c_str(), select_reg_name(reg, sym->type).c_str());
+	else
+		emit("\tmovslq\t%s, %s\n", format_mem_operand(index).c_str(), reg);
+}
+
+/*
+	Formats the address base + index * scale + displacement, loading the index into reg first
+	(a 64 bit index already in a register is used where it is)
+*/
+std::string Assembler::format_indexed_operand(const std::string &base, const std::string &index, const char *reg,
+											  int scale, int displacement)
+{
+	Symbol *sym = gst->get_symbol(index);
+	std::string index_reg = reg;
+
+	if (sym->type.is_size_8() && !sym->reg.empty())
+		index_reg = sym->reg;
+	else
+		emit_index_load(index, reg);
+
+	std::string operand = displacement != 0 ? std::to_string(displacement) : "";
+	operand += "(" + base + ", " + index_reg;
+	if (scale != 1)
+		operand += ", " + std::to_string(scale);
+
+	return operand + ")";
+}
+
 /*
 		The following function is used to store a value from a register to
    various different memory locations (e.g., a variable, an array element, etc.)
 */
 void Assembler::emit_store(const std::string &operand, const char *reg,
-						   Type type, const std::string &arg2)
+						   Type type, const std::string &arg2, int scale, int displacement)
 {
 	Symbol *sym = gst->get_symbol(operand);
 	std::string mov = select_mov_instr(type);
@@ -305,11 +399,11 @@ void Assembler::emit_store(const std::string &operand, const char *reg,
 		{
 			if (type.get_base_type() == BaseType::CHAR)
 			{
-				fprintf(file, "\tmovq\t_%s(%%rip), %s\n", operand.c_str(), reg);
+				emit("\tmovq\t_%s(%%rip), %s\n", operand.c_str(), reg);
 				return;
 			}
 
-			fprintf(file, "\tleaq\t%d(%%rbp), %s\n", sym->stack_offset,
+			emit("\tleaq\t%d(%s), %s\n", sym->stack_offset, frame_reg.c_str(),
 					reg_name.c_str());
 		}
 		else
@@ -319,23 +413,20 @@ void Assembler::emit_store(const std::string &operand, const char *reg,
 			if (index_sym)
 			{
 				// Index is already scaled - just load and use
-				fprintf(file, "\tmovl\t%d(%%rbp), %%r11d\n", index_sym->stack_offset);
-				fprintf(file, "\tmovslq\t%%r11d, %%r11\n");
+				std::string mem = format_indexed_operand(frame_reg, arg2, "%r11", scale,
+														 sym->stack_offset + displacement);
 
 				std::string mov = select_mov_instr(type);
 				std::string reg_name = select_reg_name(reg, type);
 
 				// Store: array[base + index] = value
-				fprintf(file, "\t%s\t%s, %d(%%rbp, %%r11)\n",
-						mov.c_str(),
-						reg_name.c_str(),
-						sym->stack_offset);
+				emit("\t%s\t%s, %s\n", mov.c_str(), reg_name.c_str(), mem.c_str());
 			}
 			else
 			{
 				// Constant index
 				int offset = sym->stack_offset + std::stoi(arg2) * type.get_size();
-				fprintf(file, "\t%s\t%s, %d(%%rbp)\n", mov.c_str(), reg_name.c_str(), offset);
+				emit("\t%s\t%s, %d(%s)\n", mov.c_str(), reg_name.c_str(), offset, frame_reg.c_str());
 			}
 		}
 		return;
@@ -356,23 +447,23 @@ void Assembler::emit_store(const std::string &operand, const char *reg,
 		if (!field_sym)
 		{
 			if (sym->is_global)
-				fprintf(file, "\tmovl\t%s, _%s+%d(%%rip)\n", reg_name.c_str(),
+				emit("\tmovl\t%s, _%s+%d(%%rip)\n", reg_name.c_str(),
 						operand.c_str(), std::stoi(arg2));
 			else
-				fprintf(file, "\tmovl\t%s, %d(%%rbp)\n", reg_name.c_str(),
-						std::stoi(arg2));
+				emit("\tmovl\t%s, %d(%s)\n", reg_name.c_str(),
+						std::stoi(arg2), frame_reg.c_str());
 		}
 		else
 		{
-			fprintf(file, "\tmovslq\t%s, %%r11\n", format_mem_operand(arg2).c_str());
-			fprintf(file, "\tmovl\t%s, (%%rbp, %%r11)\n", reg_name.c_str());
+			std::string mem = format_indexed_operand(frame_reg, arg2, "%r11", scale, displacement);
+			emit("\tmovl\t%s, %s\n", reg_name.c_str(), mem.c_str());
 		}
 
 		return;
 	}
 
 	// Case: dst is a variable (of any sort i.e. static, local, etc)
-	fprintf(file, "\t%s\t%s, %s\n", mov.c_str(), reg_name.c_str(),
+	emit("\t%s\t%s, %s\n", mov.c_str(), reg_name.c_str(),
 			format_mem_operand(operand).c_str());
 }
 
@@ -381,59 +472,146 @@ void Assembler::compare_and_store_result(const std::string &operand_a, const std
 {
 	emit_load(operand_a, reg, type);
 
-	Symbol *potential_var_b = gst->get_symbol(operand_b);
 	std::string cmp_text = select_cmp_instr(type);
 
 	std::string reg_name = select_reg_name(reg, type);
 
-	if (potential_var_b == nullptr)
-		fprintf(file, "\t%s\t$%s, %s\n", cmp_text.c_str(), operand_b.c_str(),
-				reg_name.c_str());
-	else
-		fprintf(file, "\t%s\t%d(%%rbp), %s\n", cmp_text.c_str(),
-				potential_var_b->stack_offset, reg_name.c_str());
+	emit("\t%s\t%s, %s\n", cmp_text.c_str(),
+			format_mem_operand(operand_b).c_str(), reg_name.c_str());
 
 	std::string reg_b = reg_name;
 	if (!type.is_size_8())
 		reg_b.pop_back();
 	reg_b += "b";
 
-	fprintf(file, "\t%s\t%s\n", op.c_str(), reg_b.c_str());
+	emit("\t%s\t%s\n", op.c_str(), reg_b.c_str());
 
+	// Writing the 32 bit register clears the upper half too
 	if (reg_b != reg_name)
-		fprintf(file, "\tmovzbl\t%s, %s\n", reg_b.c_str(), reg_name.c_str());
+		emit("\tmovzbl\t%s, %s\n", reg_b.c_str(), select_reg_name(reg, Type(BaseType::INT)).c_str());
 
 	emit_store(result, reg, type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_func_begin(const TACInstruction &instruction)
 {
 	gst->enter_func_scope(instruction.arg1);
 	if (instruction.arg2 == "global")
-		fprintf(file, ".global _%s\n", instruction.arg1.c_str());
-	fprintf(file, ".extern _printf\n");
-	fprintf(file, "_%s: # %s\n", instruction.arg1.c_str(),
+		emit(".global _%s\n", instruction.arg1.c_str());
+	emit(".extern _printf\n");
+	emit("_%s: # %s\n", instruction.arg1.c_str(),
 			TacGenerator::gen_tac_str(instruction).c_str());
-	fprintf(file, "\tpushq\t%%rbp\n");
-	fprintf(file, "\tmovq\t%%rsp, %%rbp\n");
-	int stack_space = gst->get_func_st(gst->get_current_func())->get_stack_size();
-	fprintf(file, "\tsubq\t$%d, %%rsp\n\n", stack_space);
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+	const auto &saved_regs = st->get_saved_regs();
+
+	/*
+		A leaf function's frame can live in the red zone (the 128 bytes below %rsp which nothing else
+		will touch) so the locals are addressed from %rsp and nothing needs setting up
+		The callee-saved registers are kept just below the locals
+	*/
+	int frame_size = st->get_stack_size() + (int)saved_regs.size() * 8;
+	uses_red_zone = leaf_funcs.count(instruction.arg1) && frame_size <= RED_ZONE_SIZE;
+
+	if (uses_red_zone)
+	{
+		frame_reg = "%rsp";
+		for (size_t i = 0; i < saved_regs.size(); i++)
+			emit("\tmovq\t%s, %d(%%rsp)\n", saved_regs[i].c_str(), get_red_zone_slot(i));
+
+		emit("\n");
+		return;
+	}
+
+	frame_reg = "%rbp";
+	emit("\tpushq\t%%rbp\n");
+	emit("\tmovq\t%%rsp, %%rbp\n");
+	if (st->get_stack_size() > 0)
+		emit("\tsubq\t$%d, %%rsp\n", st->get_stack_size());
+
+	// Preserve any callee-saved registers handed out by the register allocator (keeping %rsp 16 byte aligned)
+	for (const auto &reg : saved_regs)
+		emit("\tpushq\t%s\n", reg.c_str());
+	if (saved_regs.size() % 2 != 0)
+		emit("\tsubq\t$8, %%rsp\n");
+
+	emit("\n");
 }
 
 void Assembler::emit_func_end(const TACInstruction &instruction)
 {
 	std::string current_func = gst->get_current_func();
-	fprintf(file, ".L%s_end: # %s\n", current_func.c_str(),
+	emit(".L%s_end: # %s\n", current_func.c_str(),
 			TacGenerator::gen_tac_str(instruction).c_str());
-	int stack_space = gst->get_func_st(current_func)->get_stack_size();
-	fprintf(file, "\taddq\t$%d, %%rsp\n", stack_space);
-	fprintf(file, "\tpopq\t%%rbp\n");
-	fprintf(file, "\tretq\n\n");
+	SymbolTable *st = gst->get_func_st(current_func);
+
+	const auto &saved_regs = st->get_saved_regs();
+	if (uses_red_zone)
+	{
+		for (size_t i = 0; i < saved_regs.size(); i++)
+			emit("\tmovq\t%d(%%rsp), %s\n", get_red_zone_slot(i), saved_regs[i].c_str());
+	}
+	else
+	{
+		if (saved_regs.size() % 2 != 0)
+			emit("\taddq\t$8, %%rsp\n");
+		for (auto it = saved_regs.rbegin(); it != saved_regs.rend(); ++it)
+			emit("\tpopq\t%s\n", it->c_str());
+
+		if (st->get_stack_size() > 0)
+			emit("\taddq\t$%d, %%rsp\n", st->get_stack_size());
+		emit("\tpopq\t%%rbp\n");
+	}
+
+	emit("\tretq\n\n");
 	gst->leave_func_scope();
 }
 
+int Assembler::get_red_zone_slot(size_t saved_reg) const
+{
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+	return -(st->get_stack_size() + (int)(saved_reg + 1) * 8);
+}
+
+void Assembler::find_leaf_funcs(const std::vector<TACInstruction> &instructions)
+{
+	leaf_funcs.clear();
+
+	// Frames are always set up without optimisation (so debuggers can walk them)
+	if (options.opt_level == 0)
+		return;
+
+	std::string current_func;
+	bool is_leaf = false;
+
+	for (const auto &instruction : instructions)
+	{
+		switch (instruction.op)
+		{
+		case TACOp::FUNC_BEGIN:
+			current_func = instruction.arg1;
+			is_leaf = true;
+			break;
+		case TACOp::FUNC_END:
+			if (is_leaf)
+				leaf_funcs.insert(current_func);
+			break;
+		// Anything which moves %rsp (or calls something which would use the red zone itself)
+		case TACOp::CALL:
+		case TACOp::PRINTF:
+		case TACOp::PUSH:
+		case TACOp::POP:
+		case TACOp::ALLOC_STACK:
+		case TACOp::DEALLOC_STACK:
+			is_leaf = false;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 void Assembler::emit_assign(const TACInstruction &instruction)
 {
 	switch (current_var_type)
@@ -458,18 +636,24 @@ void Assembler::emit_text_assign(const TACInstruction &instruction)
 	Symbol *dst = gst->get_symbol(instruction.arg1);
 	Symbol *src = gst->get_symbol(instruction.result);
 
-	emit_load(instruction.result, "%r10", instruction.type, instruction.arg2);
-	emit_store(instruction.arg1, "%r10", instruction.type, instruction.arg2);
+	// Copies coalesced by the register allocator don't need any code
+	if (dst && src && instruction.arg2.empty() && !dst->reg.empty() && dst->reg == src->reg)
+		return;
+
+	emit_load(instruction.result, "%r10", instruction.type, instruction.arg2, instruction.scale,
+			  instruction.displacement);
+	emit_store(instruction.arg1, "%r10", instruction.type, instruction.arg2, instruction.scale,
+			   instruction.displacement);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_bss_assign(const TACInstruction &instruction)
 {
 	if (instruction.arg3 == "global")
-		fprintf(file, "\t.global\t_%s\n", instruction.arg1.c_str());
-	fprintf(file, "_%s:\n", instruction.arg1.c_str());
-	fprintf(file, "\t.zero %zu\n\n", instruction.type.get_size());
+		emit("\t.global\t_%s\n", instruction.arg1.c_str());
+	emit("_%s:\n", instruction.arg1.c_str());
+	emit("\t.zero %zu\n\n", instruction.type.get_size());
 }
 
 void Assembler::emit_data_assign(const TACInstruction &instruction)
@@ -480,11 +664,11 @@ void Assembler::emit_data_assign(const TACInstruction &instruction)
 		return;
 
 	if (instruction.arg3 == "global")
-		fprintf(file, ".global	_%s\n", instruction.arg1.c_str());
+		emit(".global	_%s\n", instruction.arg1.c_str());
 
 	if (instruction.arg3 != "struct_not_first")
-		fprintf(file, "_%s:\n", instruction.arg1.c_str());
-	fprintf(file, "\t.%s %s\n", instruction.type.is_size_8() ? "quad" : "long",
+		emit("_%s:\n", instruction.arg1.c_str());
+	emit("\t.%s %s\n", instruction.type.is_size_8() ? "quad" : "long",
 			instruction.result.c_str());
 }
 
@@ -493,12 +677,12 @@ void Assembler::emit_literal8_assign(const TACInstruction &instruction)
 	if (!instruction.type.has_base_type(BaseType::DOUBLE))
 		return;
 
-	fprintf(file, "_%s:\n", instruction.arg1.c_str());
+	emit("_%s:\n", instruction.arg1.c_str());
 
 	double value = std::stod(instruction.result);
 	std::string double_hex = encode_double_hex(value);
 
-	fprintf(file, "\t.quad %s # %s\n\n", double_hex.c_str(),
+	emit("\t.quad %s # %s\n\n", double_hex.c_str(),
 			instruction.result.c_str());
 }
 
@@ -528,8 +712,8 @@ void Assembler::emit_str_assign(const TACInstruction &instruction)
 	if (!instruction.type.has_base_type(BaseType::CHAR))
 		return;
 
-	fprintf(file, "_%s:\n", instruction.arg1.c_str());
-	fprintf(file, "\t.asciz \"%s\"\n\n",
+	emit("_%s:\n", instruction.arg1.c_str());
+	emit("\t.asciz \"%s\"\n\n",
 			escape_basic(instruction.result).c_str());
 }
 
@@ -543,7 +727,7 @@ void Assembler::emit_return(const TACInstruction &instruction)
 	if (instruction.arg1 != "")
 		emit_load(instruction.arg1, "%rax", instruction.type, instruction.arg2);
 
-	fprintf(file, "\tjmp\t.L%s_end\n\n", gst->get_current_func().c_str());
+	emit("\tjmp\t.L%s_end\n\n", gst->get_current_func().c_str());
 }
 
 void Assembler::emit_bin_op(const TACInstruction &instruction, const std::string &op)
@@ -552,6 +736,12 @@ void Assembler::emit_bin_op(const TACInstruction &instruction, const std::string
 
 	std::string reg = select_reg_name("%r10", instruction.type);
 
+	if (op == "imul" && emit_mul_by_const(instruction))
+		return;
+
+	if ((op == "add" || op == "sub") && emit_add_by_lea(instruction))
+		return;
+
 	emit_load(instruction.arg1, "%r10", instruction.type);
 
 	if (instruction.type.has_base_type(BaseType::DOUBLE))
@@ -564,10 +754,15 @@ void Assembler::emit_bin_op(const TACInstruction &instruction, const std::string
 		/*
 				So mulq doesn't allow an immediate value and a register to be
 		   multiplied together Hence we need to use imulq instead
+		   (The three operand form is only valid with an immediate)
 		*/
-		fprintf(file, "\timulq\t%s, %s, %s\n",
-				format_mem_operand(instruction.arg2).c_str(), reg.c_str(),
-				reg.c_str());
+		if (gst->get_symbol(instruction.arg2))
+			emit("\timulq\t%s, %s\n",
+					format_mem_operand(instruction.arg2).c_str(), reg.c_str());
+		else
+			emit("\timulq\t%s, %s, %s\n",
+					format_mem_operand(instruction.arg2).c_str(), reg.c_str(),
+					reg.c_str());
 	}
 	else
 	{
@@ -575,19 +770,20 @@ void Assembler::emit_bin_op(const TACInstruction &instruction, const std::string
 		if (instruction.type.has_base_type(BaseType::DOUBLE))
 		{
 			/*
-				Note that mulsd xmm0, xmm1 does: xmm1 = xmm1 * xmm0
+				Note that mulsd xmm0, xmm1 does: xmm1 = xmm1 * xmm0 (and likewise for addsd/subsd)
 				(The result is stored in xmm1 - which maps to r10 here)
 			*/
-			fprintf(file, "\t%s\t%%xmm0, %s\n", "mulsd", reg.c_str());
+			std::string double_instr = (op == "imul" ? "mul" : op) + "sd";
+			emit("\t%s\t%%xmm0, %s\n", double_instr.c_str(), reg.c_str());
 		}
 		else
-			fprintf(file, "\t%s\t%s, %s\n", instr.c_str(),
+			emit("\t%s\t%s, %s\n", instr.c_str(),
 					format_mem_operand(instruction.arg2).c_str(), reg.c_str());
 	}
 
 	emit_store(instruction.result, "%r10", instruction.type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_cmp_op(const TACInstruction &instruction,
@@ -605,14 +801,14 @@ void Assembler::emit_cmp_op(const TACInstruction &instruction,
 		emit_load(instruction.arg1, "%xmm0", instruction.type);
 		emit_load(instruction.arg2, "%xmm1", instruction.type);
 
-		fprintf(file, "\tcomisd\t%%xmm1, %%xmm0\n");
+		emit("\tcomisd\t%%xmm1, %%xmm0\n");
 
-		fprintf(file, "\tsetb\t%%r10b\n");
-		fprintf(file, "\tmovzbl\t%%r10b, %%r10d\n");
+		emit("\t%s\t%%r10b\n", actual_op.c_str());
+		emit("\tmovzbl\t%%r10b, %%r10d\n");
 
 		emit_store(instruction.result, "%r10", instruction.type);
 
-		fprintf(file, "\n");
+		emit("\n");
 
 		return;
 	}
@@ -622,41 +818,120 @@ void Assembler::emit_cmp_op(const TACInstruction &instruction,
 							 instruction.type);
 }
 
+static bool fits_imm32(long long value)
+{
+	return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// The comparison which holds once its operands are swapped (a < b is b > a)
+static BinOpType swap_comparison(BinOpType op)
+{
+	switch (op)
+	{
+	case BinOpType::LESS_THAN:
+		return BinOpType::GREATER_THAN;
+	case BinOpType::GREATER_THAN:
+		return BinOpType::LESS_THAN;
+	case BinOpType::LESS_OR_EQUAL:
+		return BinOpType::GREATER_OR_EQUAL;
+	case BinOpType::GREATER_OR_EQUAL:
+		return BinOpType::LESS_OR_EQUAL;
+	default:
+		return op;
+	}
+}
+
 void Assembler::emit_if(const TACInstruction &instruction)
 {
 	emit_comment_instr(instruction);
 
-	Symbol *sym = gst->get_symbol(instruction.arg1);
+	std::string lhs = instruction.arg1;
+	std::string rhs = instruction.arg2;
+	BinOpType cmp_op = instruction.cmp_op;
+
+	// The destination of a cmp can't be an immediate so compare the other way round
+	if (!gst->get_symbol(lhs) && gst->get_symbol(rhs))
+	{
+		std::swap(lhs, rhs);
+		cmp_op = swap_comparison(cmp_op);
+	}
+
+	/*
+		comisd sets the flags like an unsigned comparison except when either side is NaN (unordered)
+		which sets ZF, PF and CF so every comparison other than != has to come out false
+		- < and <= are done the other way round as > and >= (ja and jae don't jump when CF is set)
+		- == and != check PF as well
+	*/
+	bool is_double = instruction.type.has_base_type(BaseType::DOUBLE) && !instruction.type.is_pointer();
+	if (is_double && (cmp_op == BinOpType::LESS_THAN || cmp_op == BinOpType::LESS_OR_EQUAL))
+	{
+		std::swap(lhs, rhs);
+		cmp_op = swap_comparison(cmp_op);
+	}
 
 	std::string cmp_text = select_cmp_instr(instruction.type);
-	std::string jmp = select_conditional_jmp(instruction.cmp_op, instruction.type);
+	std::string jmp = select_conditional_jmp(cmp_op, instruction.type);
 
-	std::string reg = select_reg_name("%r10", instruction.type);
-	emit_load(instruction.arg1, "%r10", instruction.type);
+	/*
+		Jump straight on the flags of the comparison
+		A value which is already in a register is compared in place
+	*/
+	std::string reg;
+	Symbol *sym = gst->get_symbol(lhs);
+	if (sym && !sym->reg.empty() && !sym->type.is_array())
+		reg = format_mem_operand(lhs);
+	else if (instruction.type.has_base_type(BaseType::DOUBLE))
+	{
+		reg = "%xmm0";
+		emit_load(lhs, "%xmm0", instruction.type);
+	}
+	else
+	{
+		reg = select_reg_name("%r10", instruction.type);
+		emit_load(lhs, "%r10", instruction.type);
+	}
+
+	// A literal can only be compared against as a 32 bit immediate (any larger has to be loaded first)
+	std::string rhs_operand = format_mem_operand(rhs);
+	long long literal;
+	if (!gst->get_symbol(rhs) && parse_int_literal(rhs, literal) && !fits_imm32(literal))
+	{
+		emit_load(rhs, "%r11", instruction.type);
+		rhs_operand = select_reg_name("%r11", instruction.type);
+	}
+
+	emit("\t%s\t%s, %s\n", cmp_text.c_str(), rhs_operand.c_str(), reg.c_str());
+
+	if (is_double && cmp_op == BinOpType::EQUAL)
+	{
+		emit("\tjp\t1f\n");
+		emit("\t%s\t%s\n", jmp.c_str(), instruction.result.c_str());
+		emit("1:\n\n");
+		return;
+	}
 
-	fprintf(file, "\t%s\t%s, %s\n", cmp_text.c_str(),
-			format_mem_operand(instruction.arg2).c_str(),
-			reg.c_str());
+	if (is_double && cmp_op == BinOpType::NOT_EQUAL)
+		emit("\tjp\t%s\n", instruction.result.c_str());
 
-	fprintf(file, "\t%s\t%s\n\n", jmp.c_str(), instruction.result.c_str());
+	emit("\t%s\t%s\n\n", jmp.c_str(), instruction.result.c_str());
 }
 
 void Assembler::emit_goto(const TACInstruction &instruction)
 {
 	emit_comment_instr(instruction);
-	fprintf(file, "\tjmp\t%s\n\n", instruction.result.c_str());
+	emit("\tjmp\t%s\n\n", instruction.result.c_str());
 }
 
 void Assembler::emit_label(const TACInstruction &instruction)
 {
-	fprintf(file, "%s: # %s\n", instruction.arg1.c_str(),
+	emit("%s: # %s\n", instruction.arg1.c_str(),
 			TacGenerator::gen_tac_str(instruction).c_str());
 }
 
 void Assembler::emit_call(const TACInstruction &instruction)
 {
 	emit_comment_instr(instruction);
-	fprintf(file, "\tcall\t_%s\n\n", instruction.arg1.c_str());
+	emit("\tcall\t_%s\n\n", instruction.arg1.c_str());
 }
 
 void Assembler::emit_mov_between_reg(const TACInstruction &instruction)
@@ -664,12 +939,20 @@ void Assembler::emit_mov_between_reg(const TACInstruction &instruction)
 	// MOV_TO_REG %rsi, 5 (int)
 	emit_comment_instr(instruction);
 
+	// The value may already have been allocated to this register
+	Symbol *sym = gst->get_symbol(instruction.arg1);
+	if (sym && sym->reg == instruction.arg2)
+	{
+		emit("\n");
+		return;
+	}
+
 	if (instruction.result == "load")
 		emit_load(instruction.arg1, instruction.arg2.c_str(), instruction.type);
 	else if (instruction.result == "store")
 		emit_store(instruction.arg1, instruction.arg2.c_str(), instruction.type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_nop(const TACInstruction &instruction)
@@ -700,29 +983,396 @@ void Assembler::emit_div_mod(const TACInstruction &instruction,
 
 		emit_load(instruction.arg1, "%xmm0", instruction.type);
 		emit_load(instruction.arg2, "%xmm1", instruction.type);
-		fprintf(file, "\tdivsd %%xmm1, %%xmm0\n");
+		emit("\tdivsd %%xmm1, %%xmm0\n");
 		emit_store(instruction.result, "%xmm0", instruction.type);
-		fprintf(file, "\n");
+		emit("\n");
 		return;
 	}
 
+	if (emit_div_mod_by_const(instruction, is_mod))
+		return;
+
 	emit_load(instruction.arg1, "%rax", instruction.type);
 
 	if (instruction.type.is_signed())
-		fprintf(file, "\t%s\n", instruction.type.is_size_8() ? "cqto" : "cdq");
+		emit("\t%s\n", instruction.type.is_size_8() ? "cqto" : "cdq");
 	else
-		fprintf(file, "\txor\t%%rdx, %%rdx\n");
+		emit("\txor\t%%rdx, %%rdx\n");
 
 	std::string op = format_typed_instr("idiv", instruction.type);
 	std::string reg = select_reg_name("%r10", instruction.type);
 
 	emit_load(instruction.arg2, "%r10", instruction.type);
-	fprintf(file, "\t%s\t%s\n", op.c_str(), reg.c_str());
+	emit("\t%s\t%s\n", op.c_str(), reg.c_str());
 
 	const char *result_reg = is_mod ? "%rdx" : "%rax";
 	emit_store(instruction.result, result_reg, instruction.type);
 }
 
+/*
+	Magic numbers for dividing by a constant d (at least 2) using a multiply and shifts
+	(Hacker's Delight chapter 10) where W is the width of the operation in bits
+	- Signed: q = (mulhs(M, n) [+ n if M is negative]) >> s, plus one if n is negative
+	- Unsigned: q = mulhu(M, n) >> s, or when add is set ((n - t) >> 1 + t) >> (s - 1) with t = mulhu(M, n)
+*/
+struct MagicNumber
+{
+	unsigned long long multiplier;
+	int shift;
+	bool add = false;
+};
+
+static MagicNumber get_signed_magic(unsigned long long d, int width)
+{
+	const unsigned long long mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+	const unsigned long long two_w1 = 1ULL << (width - 1);
+
+	unsigned long long anc = two_w1 - 1 - two_w1 % d; // Absolute value of nc
+	int p = width - 1;
+	unsigned long long q1 = two_w1 / anc, r1 = two_w1 - q1 * anc;
+	unsigned long long q2 = two_w1 / d, r2 = two_w1 - q2 * d;
+	unsigned long long delta;
+
+	do
+	{
+		p++;
+		q1 = (2 * q1) & mask;
+		r1 = (2 * r1) & mask;
+		if (r1 >= anc)
+		{
+			q1++;
+			r1 -= anc;
+		}
+
+		q2 = (2 * q2) & mask;
+		r2 = (2 * r2) & mask;
+		if (r2 >= d)
+		{
+			q2++;
+			r2 -= d;
+		}
+
+		delta = d - r2;
+	} while (q1 < delta || (q1 == delta && r1 == 0));
+
+	return {(q2 + 1) & mask, p - width};
+}
+
+static MagicNumber get_unsigned_magic(unsigned long long d, int width)
+{
+	const unsigned long long mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+	const unsigned long long two_w1 = 1ULL << (width - 1);
+
+	MagicNumber magic = {0, 0, false};
+	unsigned long long nc = (mask - (((mask - d) & mask) + 1) % d) & mask;
+	int p = width - 1;
+	unsigned long long q1 = two_w1 / nc, r1 = two_w1 - q1 * nc;
+	unsigned long long q2 = (two_w1 - 1) / d, r2 = (two_w1 - 1) - q2 * d;
+	unsigned long long delta;
+
+	do
+	{
+		p++;
+		if (r1 >= nc - r1)
+		{
+			q1 = (2 * q1 + 1) & mask;
+			r1 = (2 * r1 - nc) & mask;
+		}
+		else
+		{
+			q1 = (2 * q1) & mask;
+			r1 = (2 * r1) & mask;
+		}
+
+		if (r2 + 1 >= d - r2)
+		{
+			if (q2 >= two_w1 - 1)
+				magic.add = true;
+			q2 = (2 * q2 + 1) & mask;
+			r2 = (2 * r2 + 1 - d) & mask;
+		}
+		else
+		{
+			if (q2 >= two_w1)
+				magic.add = true;
+			q2 = (2 * q2) & mask;
+			r2 = (2 * r2 + 1) & mask;
+		}
+
+		delta = d - 1 - r2;
+	} while (p < 2 * width && (q1 < delta || (q1 == delta && r1 == 0)));
+
+	magic.multiplier = (q2 + 1) & mask;
+	magic.shift = p - width;
+	return magic;
+}
+
+/*
+	Multiplying by a constant is done with a shift or lea where possible rather than imul
+	Returns false (having emitted nothing) when there isn't a cheaper sequence
+*/
+bool Assembler::emit_mul_by_const(const TACInstruction &instruction)
+{
+	const Type &type = instruction.type;
+	if (type.has_base_type(BaseType::DOUBLE) || type.is_array() || (type.get_size() != 4 && type.get_size() != 8))
+		return false;
+
+	// Multiplication is commutative so the constant could be either side
+	std::string operand = instruction.arg1;
+	long long value;
+
+	if (gst->get_symbol(instruction.arg2) || !parse_int_literal(instruction.arg2, value))
+	{
+		if (gst->get_symbol(instruction.arg1) || !parse_int_literal(instruction.arg1, value))
+			return false;
+		operand = instruction.arg2;
+	}
+
+	value = normalise_int(value, type);
+	bool is_negative = value < 0;
+	unsigned long long magnitude = is_negative ? 0ULL - static_cast<unsigned long long>(value) : value;
+
+	std::string reg = select_reg_name("%r10", type);
+	int shift = __builtin_ctzll(magnitude | (1ULL << 63));
+
+	if (magnitude == 0)
+		emit("\t%s\t$0, %s\n", select_mov_instr(type).c_str(), reg.c_str());
+	else if (magnitude == 1ULL << shift)
+	{
+		emit_load(operand, "%r10", type);
+		if (shift > 0)
+			emit("\t%s\t$%d, %s\n", format_typed_instr("shl", type).c_str(), shift, reg.c_str());
+	}
+	else if (magnitude == 3 || magnitude == 5 || magnitude == 9)
+	{
+		// x * 3 = x + x * 2 etc
+		emit_load(operand, "%r10", type);
+		emit("\t%s\t(%%r10, %%r10, %llu), %s\n", format_typed_instr("lea", type).c_str(), magnitude - 1,
+				reg.c_str());
+	}
+	else
+		return false;
+
+	if (is_negative && magnitude != 0)
+		emit("\t%s\t%s\n", format_typed_instr("neg", type).c_str(), reg.c_str());
+
+	emit_store(instruction.result, "%r10", type);
+
+	emit("\n");
+	return true;
+}
+
+/*
+	Adding (or subtracting a constant) where everything is in registers is done with a single lea
+	rather than copying an operand into the result and adding the other to it
+	Returns false (having emitted nothing) when the result isn't in a register of its own
+*/
+bool Assembler::emit_add_by_lea(const TACInstruction &instruction)
+{
+	const Type &type = instruction.type;
+	if (!type.is_integral() || type.is_pointer() || type.is_array() || (type.get_size() != 4 && type.get_size() != 8))
+		return false;
+
+	auto get_reg = [&](const std::string &name) -> std::string
+	{
+		Symbol *sym = gst->get_symbol(name);
+		return sym ? sym->reg : "";
+	};
+
+	// Addition is commutative so the register could be either side
+	std::string base = get_reg(instruction.arg1);
+	std::string other = instruction.arg2;
+
+	if (base.empty() && instruction.op == TACOp::ADD)
+	{
+		base = get_reg(instruction.arg2);
+		other = instruction.arg1;
+	}
+
+	// When the result is also an operand a plain add is just as short
+	std::string result = get_reg(instruction.result);
+	std::string index = get_reg(other);
+	if (base.empty() || result.empty() || result == base || result == index)
+		return false;
+
+	std::string address;
+	long long value;
+
+	if (!index.empty() && instruction.op == TACOp::ADD)
+		address = "(" + base + ", " + index + ")";
+	else if (!gst->get_symbol(other) && parse_int_literal(other, value))
+	{
+		value = normalise_int(value, type);
+		if (instruction.op == TACOp::SUB)
+			value = -value;
+		if (!fits_imm32(value))
+			return false;
+
+		address = std::to_string(value) + "(" + base + ")";
+	}
+	else
+		return false;
+
+	emit("\t%s\t%s, %s\n\n", format_typed_instr("lea", type).c_str(), address.c_str(),
+			select_reg_name(result.c_str(), type).c_str());
+	return true;
+}
+
+/*
+	Dividing by a constant avoids (i)div which is many times slower than a multiply
+	- Powers of two are shifted (with signed values first biased so they round towards zero)
+	- Anything else multiplies by a magic number and takes the high half of the result
+	The remainder is then n - q * d (or a mask for powers of two)
+	Returns false (having emitted nothing) when the divisor isn't a suitable constant
+*/
+bool Assembler::emit_div_mod_by_const(const TACInstruction &instruction, bool is_mod)
+{
+	const Type &type = instruction.type;
+	if (type.is_array() || type.is_pointer() || (type.get_size() != 4 && type.get_size() != 8))
+		return false;
+
+	long long value;
+	if (gst->get_symbol(instruction.arg2) || !parse_int_literal(instruction.arg2, value))
+		return false;
+
+	const int width = type.get_size() * 8;
+	const bool is_signed = type.is_signed();
+
+	value = normalise_int(value, type);
+
+	// Dividing by 0 must still fault, -1 (and the most negative value) can overflow
+	if (value == 0 || (is_signed && (value == -1 || value == (width == 64 ? INT64_MIN : INT32_MIN))))
+		return false;
+
+	bool is_negative = is_signed && value < 0;
+	unsigned long long d = is_negative ? 0ULL - static_cast<unsigned long long>(value) : value;
+	if (width == 32)
+		d &= 0xFFFFFFFFULL;
+
+	std::string r10 = select_reg_name("%r10", type);
+	std::string r11 = select_reg_name("%r11", type);
+	std::string rax = select_reg_name("%rax", type);
+	std::string rdx = select_reg_name("%rdx", type);
+	std::string mov = select_mov_instr(type);
+
+	// The result ends up in %r10
+	if (d == 1)
+	{
+		if (is_mod)
+			emit("\t%s\t$0, %s\n", mov.c_str(), r10.c_str());
+		else
+		{
+			emit_load(instruction.arg1, "%r10", type);
+			if (is_negative)
+				emit("\t%s\t%s\n", format_typed_instr("neg", type).c_str(), r10.c_str());
+		}
+	}
+	else if ((d & (d - 1)) == 0 && d <= (1ULL << 30))
+	{
+		int shift = __builtin_ctzll(d);
+		emit_load(instruction.arg1, "%r10", type);
+
+		if (!is_signed)
+		{
+			if (is_mod)
+				emit("\t%s\t$%llu, %s\n", format_typed_instr("and", type).c_str(), d - 1, r10.c_str());
+			else
+				emit("\t%s\t$%d, %s\n", format_typed_instr("shr", type).c_str(), shift, r10.c_str());
+		}
+		else
+		{
+			// Negative values have d - 1 added first so the shift rounds towards zero
+			emit("\t%s\t%s, %s\n", mov.c_str(), r10.c_str(), r11.c_str());
+			emit("\t%s\t$%d, %s\n", format_typed_instr("sar", type).c_str(), width - 1, r11.c_str());
+			emit("\t%s\t$%d, %s\n", format_typed_instr("shr", type).c_str(), width - shift, r11.c_str());
+
+			if (is_mod)
+			{
+				emit("\t%s\t%s, %s\n", format_typed_instr("add", type).c_str(), r10.c_str(), r11.c_str());
+				emit("\t%s\t$%lld, %s\n", format_typed_instr("and", type).c_str(),
+						-static_cast<long long>(d), r11.c_str());
+				emit("\t%s\t%s, %s\n", format_typed_instr("sub", type).c_str(), r11.c_str(), r10.c_str());
+			}
+			else
+			{
+				emit("\t%s\t%s, %s\n", format_typed_instr("add", type).c_str(), r11.c_str(), r10.c_str());
+				emit("\t%s\t$%d, %s\n", format_typed_instr("sar", type).c_str(), shift, r10.c_str());
+				if (is_negative)
+					emit("\t%s\t%s\n", format_typed_instr("neg", type).c_str(), r10.c_str());
+			}
+		}
+	}
+	else
+	{
+		MagicNumber magic = is_signed ? get_signed_magic(d, width) : get_unsigned_magic(d, width);
+
+		// The dividend stays in %r11 whilst the high half of the product ends up in %rdx
+		emit_load(instruction.arg1, "%r11", type);
+
+		if (width == 64 && !fits_imm32(static_cast<long long>(magic.multiplier)))
+			emit("\tmovabsq\t$%llu, %%rax\n", magic.multiplier);
+		else
+			emit("\t%s\t$%lld, %s\n", mov.c_str(),
+					width == 64 ? static_cast<long long>(magic.multiplier)
+								: static_cast<long long>(static_cast<int32_t>(magic.multiplier)),
+					rax.c_str());
+
+		emit("\t%s\t%s\n", format_typed_instr("imul", type).c_str(), r11.c_str());
+
+		if (is_signed)
+		{
+			// A negative multiplier (as a signed value) needs the dividend added back on
+			if (magic.multiplier >> (width - 1))
+				emit("\t%s\t%s, %s\n", format_typed_instr("add", type).c_str(), r11.c_str(), rdx.c_str());
+			if (magic.shift > 0)
+				emit("\t%s\t$%d, %s\n", format_typed_instr("sar", type).c_str(), magic.shift, rdx.c_str());
+
+			// Round towards zero by adding one for negative dividends
+			emit("\t%s\t%s, %s\n", mov.c_str(), r11.c_str(), rax.c_str());
+			emit("\t%s\t$%d, %s\n", format_typed_instr("shr", type).c_str(), width - 1, rax.c_str());
+			emit("\t%s\t%s, %s\n", format_typed_instr("add", type).c_str(), rax.c_str(), rdx.c_str());
+		}
+		else if (magic.add)
+		{
+			emit("\t%s\t%s, %s\n", mov.c_str(), r11.c_str(), rax.c_str());
+			emit("\t%s\t%s, %s\n", format_typed_instr("sub", type).c_str(), rdx.c_str(), rax.c_str());
+			emit("\t%s\t$1, %s\n", format_typed_instr("shr", type).c_str(), rax.c_str());
+			emit("\t%s\t%s, %s\n", format_typed_instr("add", type).c_str(), rax.c_str(), rdx.c_str());
+			if (magic.shift > 1)
+				emit("\t%s\t$%d, %s\n", format_typed_instr("shr", type).c_str(), magic.shift - 1,
+						rdx.c_str());
+		}
+		else if (magic.shift > 0)
+			emit("\t%s\t$%d, %s\n", format_typed_instr("shr", type).c_str(), magic.shift, rdx.c_str());
+
+		if (is_mod)
+		{
+			// n - q * d (the sign of d doesn't matter for the remainder)
+			if (fits_imm32(static_cast<long long>(d)))
+				emit("\t%s\t$%llu, %s, %s\n", width == 64 ? "imulq" : "imull", d, rdx.c_str(), rdx.c_str());
+			else
+			{
+				emit("\tmovabsq\t$%llu, %%rax\n", d);
+				emit("\timulq\t%%rax, %%rdx\n");
+			}
+
+			emit("\t%s\t%s, %s\n", mov.c_str(), r11.c_str(), r10.c_str());
+			emit("\t%s\t%s, %s\n", format_typed_instr("sub", type).c_str(), rdx.c_str(), r10.c_str());
+		}
+		else
+		{
+			emit("\t%s\t%s, %s\n", mov.c_str(), rdx.c_str(), r10.c_str());
+			if (is_negative)
+				emit("\t%s\t%s\n", format_typed_instr("neg", type).c_str(), r10.c_str());
+		}
+	}
+
+	emit_store(instruction.result, "%r10", type);
+
+	emit("\n");
+	return true;
+}
+
 void Assembler::emit_unary_op(const TACInstruction &instruction,
 							  const std::string &op)
 {
@@ -733,11 +1383,11 @@ void Assembler::emit_unary_op(const TACInstruction &instruction,
 		emit_load(instruction.arg1, "%xmm0", instruction.type);
 		emit_load(instruction.arg2, "%xmm1", instruction.type);
 
-		fprintf(file, "\txorpd\t%%xmm1, %%xmm0\n");
+		emit("\txorpd\t%%xmm1, %%xmm0\n");
 
 		emit_store(instruction.result, "%xmm0", instruction.type);
 
-		fprintf(file, "\n");
+		emit("\n");
 		return;
 	}
 
@@ -745,7 +1395,7 @@ void Assembler::emit_unary_op(const TACInstruction &instruction,
 	std::string op_text = format_typed_instr(op, instruction.type);
 
 	emit_load(instruction.arg1, reg.c_str(), instruction.type);
-	fprintf(file, "\t%s\t%s\n", op_text.c_str(), reg.c_str());
+	emit("\t%s\t%s\n", op_text.c_str(), reg.c_str());
 	emit_store(instruction.result, reg.c_str(), instruction.type);
 }
 
@@ -763,7 +1413,7 @@ void Assembler::emit_not(const TACInstruction &instruction)
 
 	emit_store(instruction.result, "%r10", instruction.type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_section(const TACInstruction &instruction)
@@ -776,33 +1426,33 @@ void Assembler::emit_section(const TACInstruction &instruction)
 	{
 	case TACOp::ENTER_TEXT:
 	{
-		fprintf(file, ".text\n");
+		emit(".text\n");
 		current_var_type = VarType::TEXT;
 		break;
 	}
 	case TACOp::ENTER_BSS:
 	{
-		fprintf(file, ".bss\n");
-		fprintf(file, ".balign 8\n");
+		emit(".bss\n");
+		emit(".balign 8\n");
 		current_var_type = VarType::BSS;
 		break;
 	}
 	case TACOp::ENTER_DATA:
 	{
-		fprintf(file, ".data\n");
-		fprintf(file, ".balign 8\n");
+		emit(".data\n");
+		emit(".balign 8\n");
 		current_var_type = VarType::DATA;
 		break;
 	}
 	case TACOp::ENTER_LITERAL8:
 	{
-		fprintf(file, ".section __TEXT,__literal8,8byte_literals\n");
+		emit(".section __TEXT,__literal8,8byte_literals\n");
 		current_var_type = VarType::LITERAL8;
 		break;
 	}
 	case TACOp::ENTER_STR:
 	{
-		fprintf(file, ".section __TEXT,__cstring,cstring_literals\n");
+		emit(".section __TEXT,__cstring,cstring_literals\n");
 		current_var_type = VarType::STR;
 		break;
 	}
@@ -813,11 +1463,12 @@ void Assembler::emit_section(const TACInstruction &instruction)
 
 void Assembler::emit_convert_type(const TACInstruction &instruction)
 {
-	Symbol *src = gst->get_symbol(instruction.arg1);
-	Symbol *dst = gst->get_symbol(instruction.result);
+	std::string src = format_mem_operand(instruction.arg1);
+	std::string dst = format_mem_operand(instruction.result);
 
-	Type src_type = instruction.type;
-	Type dst_type = get_type_from_str(instruction.arg2);
+	// CONVERT_TYPE src, src_type -> dst (dst_type)
+	Type src_type = get_type_from_str(instruction.arg2);
+	Type dst_type = instruction.type;
 
 	emit_comment_instr(instruction);
 
@@ -825,17 +1476,17 @@ void Assembler::emit_convert_type(const TACInstruction &instruction)
 	if (src_type.has_base_type(BaseType::INT) &&
 		dst_type.has_base_type(BaseType::LONG))
 	{
-		fprintf(file, "\tmovl %d(%%rbp), %%r10d\n", src->stack_offset);
-		fprintf(file, "\tmovslq %%r10d, %%r10\n");
-		fprintf(file, "\tmovq %%r10, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovl %s, %%r10d\n", src.c_str());
+		emit("\tmovslq %%r10d, %%r10\n");
+		emit("\tmovq %%r10, %s\n", dst.c_str());
 	}
 	// uint -> ulong (zero extend)
 	else if (src_type.has_base_type(BaseType::UINT) &&
 			 dst_type.has_base_type(BaseType::ULONG))
 	{
-		fprintf(file, "\tmovl %d(%%rbp), %%r10d\n", src->stack_offset);
-		fprintf(file, "\tmovzxd %%r10d, %%r10\n"); // zero extend using movzx
-		fprintf(file, "\tmovq %%r10, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovl %s, %%r10d\n", src.c_str());
+		emit("\tmovzxd %%r10d, %%r10\n"); // zero extend using movzx
+		emit("\tmovq %%r10, %s\n", dst.c_str());
 	}
 	// long/ulong -> int/uint (truncate)
 	else if ((src_type.has_base_type(BaseType::LONG) ||
@@ -843,10 +1494,10 @@ void Assembler::emit_convert_type(const TACInstruction &instruction)
 			 (dst_type.has_base_type(BaseType::INT) ||
 			  dst_type.has_base_type(BaseType::UINT)))
 	{
-		fprintf(file, "\tmovq %d(%%rbp), %%r10\n", src->stack_offset);
-		fprintf(file, "\tmovl %%r10d, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovq %s, %%r10\n", src.c_str());
+		emit("\tmovl %%r10d, %s\n", dst.c_str());
 		if (dst_type.has_base_type(BaseType::UINT))
-			fprintf(file, "\tandl $0xFFFFFFFF, %d(%%rbp)\n", dst->stack_offset);
+			emit("\tandl $0xFFFFFFFF, %s\n", dst.c_str());
 	}
 	// int <-> uint (reinterpret, but mask for uint)
 	else if ((src_type.has_base_type(BaseType::INT) &&
@@ -854,51 +1505,57 @@ void Assembler::emit_convert_type(const TACInstruction &instruction)
 			 (src_type.has_base_type(BaseType::UINT) &&
 			  dst_type.has_base_type(BaseType::INT)))
 	{
-		fprintf(file, "\tmovl %d(%%rbp), %%r10d\n", src->stack_offset);
-		fprintf(file, "\tmovl %%r10d, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovl %s, %%r10d\n", src.c_str());
+		emit("\tmovl %%r10d, %s\n", dst.c_str());
 		if (dst_type.has_base_type(BaseType::UINT))
-			fprintf(file, "\tandl $0xFFFFFFFF, %d(%%rbp)\n", dst->stack_offset);
+			emit("\tandl $0xFFFFFFFF, %s\n", dst.c_str());
 	}
 	// double -> int
 	else if (src_type.has_base_type(BaseType::DOUBLE) &&
 			 dst_type.has_base_type(BaseType::INT))
 	{
-		fprintf(file, "\tmovsd %d(%%rbp), %%xmm0\n", src->stack_offset);
-		fprintf(file,
+		emit("\tmovsd %s, %%xmm0\n", src.c_str());
+		emit(
 				"\tcvttsd2si %%xmm0, %%r10d\n"); // truncate double to signed int
-		fprintf(file, "\tmovl %%r10d, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovl %%r10d, %s\n", dst.c_str());
 	}
 	// double -> uint
 	else if (src_type.has_base_type(BaseType::DOUBLE) &&
 			 dst_type.has_base_type(BaseType::UINT))
 	{
-		fprintf(file, "\tmovsd %d(%%rbp), %%xmm0\n", src->stack_offset);
-		fprintf(file,
+		emit("\tmovsd %s, %%xmm0\n", src.c_str());
+		emit(
 				"\tcvttsd2si %%xmm0, %%r10d\n"); // truncate double to signed int
-		fprintf(file, "\tmovl %%r10d, %d(%%rbp)\n", dst->stack_offset);
-		fprintf(file, "\tandl $0xFFFFFFFF, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovl %%r10d, %s\n", dst.c_str());
+		emit("\tandl $0xFFFFFFFF, %s\n", dst.c_str());
 	}
 	// int -> double
 	else if (src_type.has_base_type(BaseType::INT) &&
 			 dst_type.has_base_type(BaseType::DOUBLE))
 	{
-		fprintf(file, "\tmovl %d(%%rbp), %%r10d\n", src->stack_offset);
-		fprintf(file,
+		emit("\tmovl %s, %%r10d\n", src.c_str());
+		emit(
 				"\tcvtsi2sd %%r10d, %%xmm0\n"); // convert signed int to double
-		fprintf(file, "\tmovsd %%xmm0, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovsd %%xmm0, %s\n", dst.c_str());
 	}
 	// uint -> double
 	else if (src_type.has_base_type(BaseType::UINT) &&
 			 dst_type.has_base_type(BaseType::DOUBLE))
 	{
-		fprintf(file, "\tmovl %d(%%rbp), %%r10d\n", src->stack_offset);
-		fprintf(file, "\tmovl %%r10d, %%r10d\n"); // zero extend to 64 bits
-		fprintf(file,
+		emit("\tmovl %s, %%r10d\n", src.c_str());
+		emit("\tmovl %%r10d, %%r10d\n"); // zero extend to 64 bits
+		emit(
 				"\tcvtsi2sd %%r10, %%xmm0\n"); // convert unsigned int to double
-		fprintf(file, "\tmovsd %%xmm0, %d(%%rbp)\n", dst->stack_offset);
+		emit("\tmovsd %%xmm0, %s\n", dst.c_str());
+	}
+	// Unknown source (e.g. a struct field read with a variable index) so the value is just copied
+	else if (src_type.is_void())
+	{
+		emit_load(instruction.arg1, "%r10", dst_type);
+		emit_store(instruction.result, "%r10", dst_type);
 	}
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_deref(const TACInstruction &instruction)
@@ -909,16 +1566,16 @@ void Assembler::emit_deref(const TACInstruction &instruction)
 	Symbol *dst = gst->get_symbol(instruction.result);
 
 	// First, get the pointer value into a register
-	fprintf(file, "\tmovq\t%d(%%rbp), %%rax\n", src->stack_offset);
+	emit("\tmovq\t%d(%s), %%rax\n", src->stack_offset, frame_reg.c_str());
 
 	std::string mov = select_mov_instr(instruction.type);
 	std::string reg = select_reg_name("%r10", instruction.type);
 
 	// Now dereference it and store the value
-	fprintf(file, "\t%s\t(%%rax), %s\n", mov.c_str(), reg.c_str());
+	emit("\t%s\t(%%rax), %s\n", mov.c_str(), reg.c_str());
 	emit_store(instruction.result, "%r10", instruction.type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_addr_of(const TACInstruction &instruction)
@@ -932,15 +1589,15 @@ void Assembler::emit_addr_of(const TACInstruction &instruction)
 		report_error("Pointer should be 8 bytes");
 
 	// Address-of always produces an 8-byte pointer
-	fprintf(file, "\tleaq %d(%%rbp), %%rax\n", src->stack_offset);
-	fprintf(file, "\tmovq %%rax, %d(%%rbp)\n\n", dst->stack_offset);
+	emit("\tleaq %d(%s), %%rax\n", src->stack_offset, frame_reg.c_str());
+	emit("\tmovq %%rax, %d(%s)\n\n", dst->stack_offset, frame_reg.c_str());
 }
 
 void Assembler::emit_struct_init(const TACInstruction &instruction)
 {
 	// No assembly needed - struct space is already allocated on stack
 	emit_comment_instr(instruction);
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_logical_and(const TACInstruction &instruction)
@@ -965,11 +1622,11 @@ void Assembler::emit_logical_op(const TACInstruction &instruction,
 	emit_load(instruction.arg1, "%r11", instruction.type);
 	emit_load(instruction.arg2, "%r10", instruction.type);
 
-	fprintf(file, "\t%s\t%s, %s\n", instr.c_str(), reg_a.c_str(), reg_b.c_str());
+	emit("\t%s\t%s, %s\n", instr.c_str(), reg_a.c_str(), reg_b.c_str());
 
 	emit_store(instruction.result, "%r10", instruction.type);
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_assign_deref(const TACInstruction &instruction)
@@ -979,7 +1636,7 @@ void Assembler::emit_assign_deref(const TACInstruction &instruction)
 	Symbol *ptr = gst->get_symbol(instruction.arg1);
 
 	// First, get the pointer value into a register
-	fprintf(file, "\tmovq\t%s, %%rax\n",
+	emit("\tmovq\t%s, %%rax\n",
 			format_mem_operand(instruction.arg1).c_str());
 
 	std::string mov = select_mov_instr(instruction.type);
@@ -992,26 +1649,182 @@ void Assembler::emit_assign_deref(const TACInstruction &instruction)
 	if (instruction.arg2 != "")
 	{
 		int offset = std::stoi(instruction.arg2);
-		fprintf(file, "\t%s\t%s, %d(%%rax)\n", mov.c_str(), reg.c_str(), offset);
+		emit("\t%s\t%s, %d(%%rax)\n", mov.c_str(), reg.c_str(), offset);
 	}
 	else
 	{
-		fprintf(file, "\t%s\t%s, (%%rax)\n", mov.c_str(), reg.c_str());
+		emit("\t%s\t%s, (%%rax)\n", mov.c_str(), reg.c_str());
 	}
 
-	fprintf(file, "\n");
+	emit("\n");
 }
 
 void Assembler::emit_push(const TACInstruction &instruction)
 {
 	emit_comment_instr(instruction);
-	fprintf(file, "\tpushq\t%s\n\n", instruction.arg1.c_str());
+	emit("\tpushq\t%s\n\n", instruction.arg1.c_str());
 }
 
 void Assembler::emit_pop(const TACInstruction &instruction)
 {
 	emit_comment_instr(instruction);
-	fprintf(file, "\tpopq\t%s\n\n", instruction.arg1.c_str());
+	emit("\tpopq\t%s\n\n", instruction.arg1.c_str());
+}
+
+/*
+	%vN is xmmN (or ymmN when using AVX2)
+*/
+std::string Assembler::select_vec_reg(const std::string &reg)
+{
+	return (options.avx2 ? "%ymm" : "%xmm") + reg.substr(2);
+}
+
+std::string Assembler::select_vec_mov(const Type &type)
+{
+	std::string mov = type.has_base_type(BaseType::DOUBLE) ? "movupd" : "movdqu";
+	return options.avx2 ? "v" + mov : mov;
+}
+
+/*
+	The vector starting at array[index] (the index is the element number rather than a byte offset)
+	Loads the index into %r11
+*/
+std::string Assembler::format_vec_mem_operand(const std::string &array, const std::string &index, const Type &type)
+{
+	Symbol *sym = gst->get_symbol(array);
+	if (!sym || !sym->type.is_array())
+		report_error("Vector access of a non array: " + array);
+
+	return format_indexed_operand(frame_reg, index, "%r11", type.get_size(), sym->stack_offset);
+}
+
+void Assembler::emit_vec_load(const TACInstruction &instruction)
+{
+	emit_comment_instr(instruction);
+
+	std::string mem = format_vec_mem_operand(instruction.arg1, instruction.arg2, instruction.type);
+	emit("\t%s\t%s, %s\n\n", select_vec_mov(instruction.type).c_str(), mem.c_str(),
+			select_vec_reg(instruction.result).c_str());
+}
+
+void Assembler::emit_vec_store(const TACInstruction &instruction)
+{
+	emit_comment_instr(instruction);
+
+	std::string mem = format_vec_mem_operand(instruction.arg1, instruction.arg2, instruction.type);
+	emit("\t%s\t%s, %s\n\n", select_vec_mov(instruction.type).c_str(),
+			select_vec_reg(instruction.result).c_str(), mem.c_str());
+}
+
+void Assembler::emit_vec_splat(const TACInstruction &instruction)
+{
+	emit_comment_instr(instruction);
+
+	const Type &type = instruction.type;
+	std::string reg = select_vec_reg(instruction.result);
+	std::string xmm = "%xmm" + instruction.result.substr(2);
+
+	if (type.has_base_type(BaseType::DOUBLE))
+	{
+		emit_load(instruction.arg1, "%xmm0", type);
+
+		if (options.avx2)
+			emit("\tvbroadcastsd\t%%xmm0, %s\n\n", reg.c_str());
+		else
+		{
+			emit("\tmovapd\t%%xmm0, %s\n", reg.c_str());
+			emit("\tunpcklpd\t%s, %s\n\n", reg.c_str(), reg.c_str());
+		}
+		return;
+	}
+
+	emit_load(instruction.arg1, "%r10", type);
+	std::string scratch = select_reg_name("%r10", type);
+
+	// SSE2 has no broadcast so the lowest element is shuffled into the rest
+	if (type.is_size_8())
+	{
+		if (options.avx2)
+		{
+			emit("\tvmovq\t%s, %s\n", scratch.c_str(), xmm.c_str());
+			emit("\tvpbroadcastq\t%s, %s\n\n", xmm.c_str(), reg.c_str());
+		}
+		else
+		{
+			emit("\tmovq\t%s, %s\n", scratch.c_str(), reg.c_str());
+			emit("\tpunpcklqdq\t%s, %s\n\n", reg.c_str(), reg.c_str());
+		}
+	}
+	else
+	{
+		if (options.avx2)
+		{
+			emit("\tvmovd\t%s, %s\n", scratch.c_str(), xmm.c_str());
+			emit("\tvpbroadcastd\t%s, %s\n\n", xmm.c_str(), reg.c_str());
+		}
+		else
+		{
+			emit("\tmovd\t%s, %s\n", scratch.c_str(), reg.c_str());
+			emit("\tpshufd\t$0, %s, %s\n\n", reg.c_str(), reg.c_str());
+		}
+	}
+}
+
+void Assembler::emit_vec_bin_op(const TACInstruction &instruction, const std::string &op)
+{
+	emit_comment_instr(instruction);
+
+	const Type &type = instruction.type;
+	std::string a = select_vec_reg(instruction.arg1);
+	std::string b = select_vec_reg(instruction.arg2);
+	std::string result = select_vec_reg(instruction.result);
+
+	std::string instr;
+	if (type.has_base_type(BaseType::DOUBLE))
+		instr = op + "pd";
+	else if (op == "mul")
+		instr = "pmulld";
+	else
+		instr = "p" + op + (type.is_size_8() ? "q" : "d");
+
+	if (options.avx2)
+		emit("\tv%s\t%s, %s, %s\n\n", instr.c_str(), b.c_str(), a.c_str(), result.c_str());
+	else if (instr == "pmulld")
+		emit_vec_int_mul(a, b, result);
+	else
+	{
+		// The result is always a register of its own so a can be copied in first
+		std::string mov = type.has_base_type(BaseType::DOUBLE) ? "movapd" : "movdqa";
+		emit("\t%s\t%s, %s\n", mov.c_str(), a.c_str(), result.c_str());
+		emit("\t%s\t%s, %s\n\n", instr.c_str(), b.c_str(), result.c_str());
+	}
+}
+
+/*
+	SSE2 can only multiply the even 32 bit lanes (into 64 bit products)
+	So the even and odd lanes are multiplied separately and the low halves interleaved back together
+*/
+void Assembler::emit_vec_int_mul(const std::string &a, const std::string &b, const std::string &result)
+{
+	emit("\tmovdqa\t%s, %s\n", a.c_str(), result.c_str());
+	emit("\tpmuludq\t%s, %s\n", b.c_str(), result.c_str());
+	emit("\tmovdqa\t%s, %%xmm0\n", a.c_str());
+	emit("\tpsrlq\t$32, %%xmm0\n");
+	emit("\tmovdqa\t%s, %%xmm1\n", b.c_str());
+	emit("\tpsrlq\t$32, %%xmm1\n");
+	emit("\tpmuludq\t%%xmm1, %%xmm0\n");
+	emit("\tpshufd\t$8, %s, %s\n", result.c_str(), result.c_str());
+	emit("\tpshufd\t$8, %%xmm0, %%xmm0\n");
+	emit("\tpunpckldq\t%%xmm0, %s\n\n", result.c_str());
+}
+
+void Assembler::emit_vec_end(const TACInstruction &instruction)
+{
+	emit_comment_instr(instruction);
+
+	// Avoids the penalty of mixing AVX with the SSE instructions used for scalar doubles
+	if (options.avx2)
+		emit("\tvzeroupper\n\n");
 }
 
 std::string Assembler::encode_double_hex(const double &value)
@@ -1101,9 +1914,13 @@ std::string Assembler::select_reg_name(const char *base_reg, const Type &type)
 	{
 		/*
 			Note that doubles use XMM registers
+			XMM registers are passed through as is
 			Otherwise just default to xmm1 for now
 		*/
 
+		if (std::string(base_reg).rfind("%xmm", 0) == 0)
+			return base_reg;
+
 		if (std::string(base_reg) == "%rax")
 			return "%xmm0";
 
@@ -1150,10 +1967,13 @@ std::string Assembler::format_mem_operand(const std::string &sym_name)
 	if (!sym)
 		return "$" + sym_name;
 
+	if (!sym->reg.empty())
+		return select_reg_name(sym->reg.c_str(), sym->type);
+
 	if (sym->has_static_sd() || sym->is_literal8)
 		return "_" + sym->name + "(%rip)";
 	else
-		return std::to_string(sym->stack_offset) + "(%rbp)";
+		return std::to_string(sym->stack_offset) + "(" + frame_reg + ")";
 }
 
 std::string Assembler::select_conditional_jmp(const BinOpType &op,
@@ -1180,7 +2000,7 @@ std::string Assembler::select_conditional_jmp(const BinOpType &op,
 
 void Assembler::emit_comment_instr(const TACInstruction &instr)
 {
-	fprintf(file, "\t# %s\n", TacGenerator::gen_tac_str(instr).c_str());
+	emit("\t# %s\n", TacGenerator::gen_tac_str(instr).c_str());
 }
 
 void Assembler::report_error(const std::string &message)
@@ -175,7 +175,7 @@ void DoubleLiteral::print(int tabs) {
 
 AggregateLiteral::AggregateLiteral(Type t, SourceLocation loc) : ASTNode(NodeType::NODE_AGGREGATE_INIT, loc), type(t) {}
 
-void AggregateLiteral::add_element(std::unique_ptr<ASTNode> e) { values.push_back(std::move(e)); }
+void AggregateLiteral::add_element(ASTNode* e) { values.push_back(e); }
 
 void AggregateLiteral::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "AggregateLiteral:" << std::endl;
@@ -222,8 +222,8 @@ NullLiteral::NullLiteral(SourceLocation loc) : ASTNode(NodeType::NODE_NULL, loc)
 
 void NullLiteral::print(int tabs) { std::cout << std::string(tabs, ' ') << "Null" << std::endl; }
 
-CastNode::CastNode(std::unique_ptr<ASTNode> e, Type t1, Type t2, SourceLocation loc)
-	: ASTNode(NodeType::NODE_CAST, loc), expr(std::move(e)), target_type(t1), src_type(t2) {}
+CastNode::CastNode(ASTNode* e, Type t1, Type t2, SourceLocation loc)
+	: ASTNode(NodeType::NODE_CAST, loc), expr(e), target_type(t1), src_type(t2) {}
 
 void CastNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "Cast: " << std::endl;
@@ -232,8 +232,8 @@ void CastNode::print(int tabs) {
 	expr->print(tabs + 1);
 }
 
-RtnNode::RtnNode(std::unique_ptr<ASTNode> v, SourceLocation loc)
-	: ASTNode(NodeType::NODE_RETURN, loc), value(std::move(v)) {}
+RtnNode::RtnNode(ASTNode* v, SourceLocation loc)
+	: ASTNode(NodeType::NODE_RETURN, loc), value(v) {}
 
 void RtnNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "Rtn: " << std::endl;
@@ -261,7 +261,7 @@ void FuncNode::print(int tabs) {
 	for (auto& stmt : elements) stmt->print(tabs + 2);
 }
 
-std::string FuncNode::get_param_name(int i) { return dynamic_cast<VarDeclNode*>(params[i].get())->var->name; }
+std::string FuncNode::get_param_name(int i) { return dynamic_cast<VarDeclNode*>(params[i])->var->name; }
 
 FuncCallNode::FuncCallNode(const std::string& n, SourceLocation loc)
 	: ASTNode(NodeType::NODE_FUNC_CALL, loc), name(n) {}
@@ -278,8 +278,8 @@ void ProgramNode::print(int tabs) {
 	for (auto& decl : decls) decl->print(tabs + 1);
 }
 
-UnaryNode::UnaryNode(UnaryOpType o, std::unique_ptr<ASTNode> v, SourceLocation loc)
-	: ASTNode(NodeType::NODE_UNARY, loc), op(o), value(std::move(v)) {}
+UnaryNode::UnaryNode(UnaryOpType o, ASTNode* v, SourceLocation loc)
+	: ASTNode(NodeType::NODE_UNARY, loc), op(o), value(v) {}
 
 void UnaryNode::print(int tabs) {
 	auto get_unary_op_string = [](UnaryOpType o) -> std::string {
@@ -304,8 +304,8 @@ void UnaryNode::print(int tabs) {
 	value->print(tabs + 1);
 }
 
-PostfixNode::PostfixNode(TokenType o, std::unique_ptr<ASTNode> v, SourceLocation loc)
-	: ASTNode(NodeType::NODE_POSTFIX, loc), op(o), value(std::move(v)) {}
+PostfixNode::PostfixNode(TokenType o, ASTNode* v, SourceLocation loc)
+	: ASTNode(NodeType::NODE_POSTFIX, loc), op(o), value(v) {}
 
 void PostfixNode::print(int tabs) {
 	auto get_postfix_op_string = [](TokenType o) -> std::string {
@@ -330,8 +330,8 @@ void PostfixNode::print(int tabs) {
 	value->print(tabs + 1);
 }
 
-BinaryNode::BinaryNode(BinOpType o, std::unique_ptr<ASTNode> l, std::unique_ptr<ASTNode> r, SourceLocation loc)
-	: ASTNode(NodeType::NODE_BINARY, loc), op(o), left(std::move(l)), right(std::move(r)) {}
+BinaryNode::BinaryNode(BinOpType o, ASTNode* l, ASTNode* r, SourceLocation loc)
+	: ASTNode(NodeType::NODE_BINARY, loc), op(o), left(l), right(r) {}
 
 void BinaryNode::print(int tabs) {
 	auto get_binary_op_string = [](BinOpType o) -> std::string {
@@ -383,8 +383,8 @@ void VarNode::print(int tabs) {
 	std::cout << std::string(tabs + 1, ' ') << "Specifiers: " << get_str_from_specifiers(specifiers) << std::endl;
 }
 
-VarAssignNode::VarAssignNode(std::unique_ptr<ASTNode> v, std::unique_ptr<ASTNode> val, SourceLocation loc)
-	: ASTNode(NodeType::NODE_VAR_ASSIGN, loc), var(std::move(v)), value(std::move(val)) {}
+VarAssignNode::VarAssignNode(ASTNode* v, ASTNode* val, SourceLocation loc)
+	: ASTNode(NodeType::NODE_VAR_ASSIGN, loc), var(v), value(val) {}
 
 void VarAssignNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "VarAssign: " << std::endl;
@@ -392,8 +392,8 @@ void VarAssignNode::print(int tabs) {
 	value->print(tabs + 1);
 }
 
-VarDeclNode::VarDeclNode(std::unique_ptr<VarNode> v, std::unique_ptr<ASTNode> val, SourceLocation loc)
-	: ASTNode(NodeType::NODE_VAR_DECL, loc), var(std::move(v)), value(std::move(val)) {}
+VarDeclNode::VarDeclNode(VarNode* v, ASTNode* val, SourceLocation loc)
+	: ASTNode(NodeType::NODE_VAR_DECL, loc), var(v), value(val) {}
 
 void VarDeclNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "VarDecl: " << std::endl;
@@ -401,7 +401,7 @@ void VarDeclNode::print(int tabs) {
 	if (value != nullptr) value->print(tabs + 1);
 }
 
-StructDeclNode::StructDeclNode(const std::string& n, std::vector<std::unique_ptr<ASTNode>> m, SourceLocation loc)
+StructDeclNode::StructDeclNode(const std::string& n, std::vector<ASTNode*> m, SourceLocation loc)
 	: ASTNode(NodeType::NODE_STRUCT_DECL, loc), name(n), members(std::move(m)) {}
 
 void StructDeclNode::print(int tabs) {
@@ -409,10 +409,9 @@ void StructDeclNode::print(int tabs) {
 	for (auto& member : members) member->print(tabs + 1);
 }
 
-IfNode::IfNode(std::unique_ptr<ASTNode> c, std::vector<std::unique_ptr<ASTNode>> t,
-			   std::vector<std::unique_ptr<ASTNode>> e, SourceLocation loc)
+IfNode::IfNode(ASTNode* c, std::vector<ASTNode*> t, std::vector<ASTNode*> e, SourceLocation loc)
 	: ASTNode(NodeType::NODE_IF, loc),
-	  condition(std::move(c)),
+	  condition(c),
 	  then_elements(std::move(t)),
 	  else_elements(std::move(e)) {}
 
@@ -427,8 +426,8 @@ void IfNode::print(int tabs) {
 	for (auto& statement : else_elements) statement->print(tabs + 2);
 }
 
-WhileNode::WhileNode(std::unique_ptr<ASTNode> c, std::vector<std::unique_ptr<ASTNode>> e, SourceLocation loc)
-	: ASTNode(NodeType::NODE_WHILE, loc), condition(std::move(c)), elements(std::move(e)) {}
+WhileNode::WhileNode(ASTNode* c, std::vector<ASTNode*> e, SourceLocation loc)
+	: ASTNode(NodeType::NODE_WHILE, loc), condition(c), elements(std::move(e)) {}
 
 void WhileNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "While: " << std::endl;
@@ -437,12 +436,11 @@ void WhileNode::print(int tabs) {
 	for (auto& element : elements) element->print(tabs + 2);
 }
 
-ForNode::ForNode(std::unique_ptr<ASTNode> i, std::unique_ptr<BinaryNode> c, std::unique_ptr<ASTNode> p,
-				 std::vector<std::unique_ptr<ASTNode>> e, SourceLocation loc)
+ForNode::ForNode(ASTNode* i, ASTNode* c, ASTNode* p, std::vector<ASTNode*> e, SourceLocation loc)
 	: ASTNode(NodeType::NODE_FOR, loc),
-	  init(std::move(i)),
-	  condition(std::move(c)),
-	  post(std::move(p)),
+	  init(i),
+	  condition(c),
+	  post(p),
 	  elements(std::move(e)) {}
 
 void ForNode::print(int tabs) {
@@ -462,12 +460,12 @@ void LoopControl::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << typeText << label << std::endl;
 }
 
-ArrayAccessNode::ArrayAccessNode(std::unique_ptr<VarNode> arr, std::unique_ptr<ASTNode> idx, SourceLocation loc)
-	: ASTNode(NodeType::NODE_ARRAY_ACCESS, loc), array(std::move(arr)), index(std::move(idx)) {}
+ArrayAccessNode::ArrayAccessNode(VarNode* arr, ASTNode* idx, SourceLocation loc)
+	: ASTNode(NodeType::NODE_ARRAY_ACCESS, loc), array(arr), index(idx) {}
 
-ArrayAccessNode::ArrayAccessNode(const ArrayAccessNode& other, SourceLocation loc)
+ArrayAccessNode::ArrayAccessNode(const ArrayAccessNode& other, ASTArena& arena, SourceLocation loc)
 	: ASTNode(NodeType::NODE_ARRAY_ACCESS, loc),
-	  array(std::make_unique<VarNode>(*other.array)),
+	  array(arena.create<VarNode>(*other.array)),
 	  index(other.index ? other.index->clone() : nullptr) {}
 void ArrayAccessNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "ArrayAccess: " << std::endl;
@@ -480,8 +478,8 @@ void ArrayAccessNode::print(int tabs) {
 
 SizeOfNode::SizeOfNode(Type t, SourceLocation loc) : ASTNode(NodeType::NODE_SIZE_OF, loc), type(t) {}
 
-SizeOfNode::SizeOfNode(std::unique_ptr<VarNode> v, SourceLocation loc)
-	: ASTNode(NodeType::NODE_SIZE_OF, loc), var(std::move(v)) {}
+SizeOfNode::SizeOfNode(VarNode* v, SourceLocation loc)
+	: ASTNode(NodeType::NODE_SIZE_OF, loc), var(v) {}
 
 void SizeOfNode::print(int tabs) {
 	std::cout << std::string(tabs, ' ') << "SizeOf: " << std::endl;
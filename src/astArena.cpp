@@ -0,0 +1,27 @@
+#include "../include/astArena.h"
+
+#include <algorithm>
+
+#include "../include/ast.h"
+
+ASTArena::~ASTArena()
+{
+	// Newest first (the same order they would have been freed in had each node owned its children)
+	for (auto it = nodes.rbegin(); it != nodes.rend(); it++)
+		(*it)->~ASTNode();
+}
+
+void *ASTArena::allocate(size_t size, size_t alignment)
+{
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+
+	if (start + size > BLOCK_SIZE)
+	{
+		// Nodes are far smaller than a block but anything larger still gets one of its own
+		blocks.emplace_back(new char[std::max(size, BLOCK_SIZE)]);
+		start = 0;
+	}
+
+	used = start + size;
+	return blocks.back().get() + start;
+}
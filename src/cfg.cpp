@@ -0,0 +1,416 @@
+#include "../include/cfg.h"
+
+#include <algorithm>
+
+bool Loop::contains(int block) const
+{
+	return std::find(blocks.begin(), blocks.end(), block) != blocks.end();
+}
+
+ControlFlowGraph::ControlFlowGraph(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool ControlFlowGraph::is_terminator(const TACInstruction &instruction)
+{
+	return instruction.op == TACOp::GOTO || instruction.op == TACOp::IF || instruction.op == TACOp::RETURN;
+}
+
+void ControlFlowGraph::build(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	blocks.clear();
+
+	auto start_block = [&]()
+	{
+		BasicBlock block;
+		block.id = blocks.size();
+		blocks.push_back(block);
+	};
+
+	start_block();
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		bool is_leader = instruction.op == TACOp::LABEL || instruction.op == TACOp::FUNC_END;
+		if (is_leader && !blocks.back().instructions.empty())
+			start_block();
+
+		if (instruction.op == TACOp::LABEL && blocks.back().instructions.empty())
+			blocks.back().label = instruction.arg1;
+
+		blocks.back().instructions.push_back(instruction);
+
+		if (is_terminator(instruction) && i + 1 < end)
+			start_block();
+	}
+
+	rebuild_edges();
+}
+
+void ControlFlowGraph::rebuild_edges()
+{
+	label_blocks.clear();
+	for (auto &block : blocks)
+	{
+		block.preds.clear();
+		block.succs.clear();
+
+		if (!block.label.empty())
+			label_blocks[block.label] = block.id;
+	}
+
+	auto add_edge = [&](int from, int to)
+	{
+		auto &succs = blocks[from].succs;
+		if (std::find(succs.begin(), succs.end(), to) != succs.end())
+			return;
+
+		succs.push_back(to);
+		blocks[to].preds.push_back(from);
+	};
+
+	for (auto &block : blocks)
+	{
+		if (block.id == get_exit())
+			continue;
+
+		if (block.instructions.empty())
+		{
+			add_edge(block.id, block.id + 1);
+			continue;
+		}
+
+		const TACInstruction &last = block.instructions.back();
+		switch (last.op)
+		{
+		case TACOp::GOTO:
+		case TACOp::IF:
+		{
+			auto it = label_blocks.find(last.result);
+			add_edge(block.id, it != label_blocks.end() ? it->second : get_exit());
+
+			if (last.op == TACOp::IF)
+				add_edge(block.id, block.id + 1);
+			break;
+		}
+		case TACOp::RETURN:
+			add_edge(block.id, get_exit());
+			break;
+		default:
+			add_edge(block.id, block.id + 1);
+			break;
+		}
+	}
+
+	// Drop phi operands for edges which no longer exist
+	for (auto &block : blocks)
+		for (auto &instruction : block.instructions)
+		{
+			if (instruction.op != TACOp::PHI)
+				continue;
+
+			auto &args = instruction.phi_args;
+			args.erase(std::remove_if(args.begin(), args.end(),
+									  [&](const std::pair<int, std::string> &arg)
+									  {
+										  return std::find(block.preds.begin(), block.preds.end(), arg.first) ==
+												 block.preds.end();
+									  }),
+					   args.end());
+		}
+}
+
+bool ControlFlowGraph::remove_unreachable_blocks()
+{
+	compute_dominators();
+
+	auto is_kept = [&](const BasicBlock &block)
+	{ return is_reachable(block.id) || block.id == get_exit(); };
+
+	if (std::all_of(blocks.begin(), blocks.end(), is_kept))
+		return false;
+
+	std::vector<int> new_ids(blocks.size(), -1);
+	std::vector<BasicBlock> kept;
+
+	for (auto &block : blocks)
+	{
+		if (!is_kept(block))
+			continue;
+
+		new_ids[block.id] = kept.size();
+		kept.push_back(std::move(block));
+	}
+
+	blocks = std::move(kept);
+
+	for (auto &block : blocks)
+	{
+		block.id = new_ids[block.id];
+
+		for (auto &instruction : block.instructions)
+			for (auto &arg : instruction.phi_args)
+				arg.first = new_ids[arg.first];
+	}
+
+	// Operands from removed blocks now have a predecessor of -1 so are dropped here
+	rebuild_edges();
+	compute_dominators();
+
+	return true;
+}
+
+int ControlFlowGraph::insert_block(int position)
+{
+	BasicBlock block;
+	block.label = ".L" + gst->get_current_func() + "_block" + std::to_string(new_label_count++);
+	block.instructions.emplace_back(TACOp::LABEL, block.label);
+
+	blocks.insert(blocks.begin() + position, block);
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		blocks[i].id = i;
+
+		for (auto &instruction : blocks[i].instructions)
+			for (auto &arg : instruction.phi_args)
+				if (arg.first >= position)
+					arg.first++;
+	}
+
+	return position;
+}
+
+std::vector<Loop> ControlFlowGraph::find_loops() const
+{
+	std::vector<Loop> loops;
+
+	for (int block : rpo)
+		for (int succ : blocks[block].succs)
+		{
+			if (!dominates(succ, block))
+				continue;
+
+			auto it = std::find_if(loops.begin(), loops.end(), [&](const Loop &loop)
+								   { return loop.header == succ; });
+			if (it == loops.end())
+			{
+				loops.push_back({succ, {succ}, {}});
+				it = loops.end() - 1;
+			}
+
+			Loop &loop = *it;
+			loop.latches.push_back(block);
+
+			// Everything which reaches the latch without going through the header
+			std::vector<int> worklist = {block};
+			while (!worklist.empty())
+			{
+				int current = worklist.back();
+				worklist.pop_back();
+
+				if (loop.contains(current))
+					continue;
+
+				loop.blocks.push_back(current);
+				for (int pred : blocks[current].preds)
+					if (is_reachable(pred))
+						worklist.push_back(pred);
+			}
+		}
+
+	std::stable_sort(loops.begin(), loops.end(), [](const Loop &a, const Loop &b)
+					 { return a.blocks.size() < b.blocks.size(); });
+
+	return loops;
+}
+
+int ControlFlowGraph::get_preheader(const Loop &loop)
+{
+	int header = loop.header;
+	const std::string label = blocks[header].label;
+
+	std::vector<int> outside;
+	for (int pred : blocks[header].preds)
+		if (!loop.contains(pred))
+			outside.push_back(pred);
+
+	if (outside.size() == 1 && blocks[outside[0]].succs.size() == 1)
+		return outside[0];
+
+	bool has_phis = std::any_of(blocks[header].instructions.begin(), blocks[header].instructions.end(),
+								[](const TACInstruction &instruction)
+								{ return instruction.op == TACOp::PHI; });
+
+	// Splitting PHIs between several ways in isn't supported
+	if (label.empty() || outside.empty() || (has_phis && outside.size() > 1))
+		return -1;
+
+	// A block within the loop falling through into the header must now jump there instead
+	int previous = header - 1;
+	if (loop.contains(previous) && std::find(blocks[header].preds.begin(), blocks[header].preds.end(), previous) !=
+									   blocks[header].preds.end())
+	{
+		auto &instructions = blocks[previous].instructions;
+		if (!instructions.empty() && instructions.back().op == TACOp::IF)
+			return -1;
+
+		if (instructions.empty() || !is_terminator(instructions.back()))
+			instructions.emplace_back(TACOp::GOTO, "", "", label);
+	}
+
+	int preheader = insert_block(header);
+	header++;
+
+	for (int &pred : outside)
+	{
+		if (pred >= preheader)
+			pred++;
+
+		// Anything which jumped to the header jumps to the preheader instead (anything falling through already does)
+		auto &instructions = blocks[pred].instructions;
+		if (!instructions.empty() && (instructions.back().op == TACOp::GOTO || instructions.back().op == TACOp::IF) &&
+			instructions.back().result == label)
+			instructions.back().result = blocks[preheader].label;
+	}
+
+	for (auto &instruction : blocks[header].instructions)
+		for (auto &arg : instruction.phi_args)
+			if (arg.first == outside[0])
+				arg.first = preheader;
+
+	rebuild_edges();
+	compute_dominators();
+
+	return preheader;
+}
+
+std::vector<TACInstruction> ControlFlowGraph::flatten() const
+{
+	std::vector<TACInstruction> instructions;
+
+	for (auto &block : blocks)
+		instructions.insert(instructions.end(), block.instructions.begin(), block.instructions.end());
+
+	return instructions;
+}
+
+void ControlFlowGraph::compute_rpo()
+{
+	rpo.clear();
+	rpo_index.assign(blocks.size(), -1);
+
+	std::vector<bool> visited(blocks.size(), false);
+	std::vector<int> postorder;
+
+	// Iterative DFS (block, next successor to visit)
+	std::vector<std::pair<int, size_t>> stack = {{get_entry(), 0}};
+	visited[get_entry()] = true;
+
+	while (!stack.empty())
+	{
+		auto &[block, next] = stack.back();
+
+		if (next < blocks[block].succs.size())
+		{
+			int succ = blocks[block].succs[next++];
+			if (!visited[succ])
+			{
+				visited[succ] = true;
+				stack.emplace_back(succ, 0);
+			}
+			continue;
+		}
+
+		postorder.push_back(block);
+		stack.pop_back();
+	}
+
+	rpo.assign(postorder.rbegin(), postorder.rend());
+	for (size_t i = 0; i < rpo.size(); i++)
+		rpo_index[rpo[i]] = i;
+}
+
+int ControlFlowGraph::intersect(int a, int b) const
+{
+	while (a != b)
+	{
+		while (rpo_index[a] > rpo_index[b])
+			a = idom[a];
+		while (rpo_index[b] > rpo_index[a])
+			b = idom[b];
+	}
+
+	return a;
+}
+
+void ControlFlowGraph::compute_dominators()
+{
+	compute_rpo();
+
+	idom.assign(blocks.size(), -1);
+	idom[get_entry()] = get_entry();
+
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (int block : rpo)
+		{
+			if (block == get_entry())
+				continue;
+
+			int new_idom = -1;
+			for (int pred : blocks[block].preds)
+			{
+				if (idom[pred] == -1)
+					continue;
+
+				new_idom = new_idom == -1 ? pred : intersect(pred, new_idom);
+			}
+
+			if (new_idom != idom[block])
+			{
+				idom[block] = new_idom;
+				changed = true;
+			}
+		}
+	}
+
+	dom_children.assign(blocks.size(), {});
+	for (int block : rpo)
+		if (block != get_entry())
+			dom_children[idom[block]].push_back(block);
+
+	dominance_frontier.assign(blocks.size(), {});
+	for (int block : rpo)
+	{
+		if (blocks[block].preds.size() < 2)
+			continue;
+
+		for (int pred : blocks[block].preds)
+		{
+			if (!is_reachable(pred))
+				continue;
+
+			for (int runner = pred; runner != idom[block]; runner = idom[runner])
+			{
+				auto &frontier = dominance_frontier[runner];
+				if (std::find(frontier.begin(), frontier.end(), block) == frontier.end())
+					frontier.push_back(block);
+			}
+		}
+	}
+}
+
+bool ControlFlowGraph::dominates(int a, int b) const
+{
+	if (!is_reachable(a) || !is_reachable(b))
+		return false;
+
+	while (b != a && b != get_entry())
+		b = idom[b];
+
+	return b == a;
+}
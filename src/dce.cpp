@@ -0,0 +1,201 @@
+#include "../include/dce.h"
+
+#include <unordered_map>
+
+DeadCodeElimination::DeadCodeElimination(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool DeadCodeElimination::is_pure(const TACInstruction &instruction) const
+{
+	switch (instruction.op)
+	{
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::DIV:
+	case TACOp::MOD:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	case TACOp::CONVERT_TYPE:
+	case TACOp::DEREF:
+	case TACOp::ADDR_OF:
+	case TACOp::PHI:
+	case TACOp::ASSIGN:
+		return true;
+	case TACOp::MOV_BETWEEN_REG:
+		return instruction.result == "store";
+	default:
+		return false;
+	}
+}
+
+TACField DeadCodeElimination::get_target_field(const TACInstruction &instruction) const
+{
+	if (instruction.op == TACOp::ASSIGN || instruction.op == TACOp::MOV_BETWEEN_REG)
+		return &TACInstruction::arg1;
+
+	return &TACInstruction::result;
+}
+
+bool DeadCodeElimination::remove_dead_stores(ControlFlowGraph &cfg)
+{
+	std::unordered_set<std::string> read;
+	std::unordered_set<std::string> written;
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			// Taking the address means it could be read through a pointer
+			if (instruction.op == TACOp::ADDR_OF)
+				read.insert(instruction.arg1);
+
+			for (TACField field : get_tac_use_fields(instruction, gst.get()))
+			{
+				// Storing into an element isn't a read of the rest of the array/struct
+				if (instruction.op == TACOp::ASSIGN && field == &TACInstruction::arg1)
+					continue;
+
+				read.insert(instruction.*field);
+			}
+
+			if (is_pure(instruction) && instruction.op != TACOp::PHI)
+				written.insert(instruction.*get_target_field(instruction));
+		}
+
+	bool changed = false;
+
+	for (auto &block : cfg.blocks)
+	{
+		auto &instructions = block.instructions;
+		size_t kept = 0;
+
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			const TACInstruction &instruction = instructions[i];
+
+			bool is_dead = false;
+			if (is_pure(instruction) && instruction.op != TACOp::PHI)
+			{
+				const std::string &target = instruction.*get_target_field(instruction);
+				is_dead = written.count(target) && !read.count(target) && !ssa->is_ssa_value(target) &&
+						  is_local_symbol(gst->get_symbol(target));
+			}
+
+			if (is_dead)
+			{
+				changed = true;
+				continue;
+			}
+
+			if (kept != i)
+				instructions[kept] = std::move(instructions[i]);
+			kept++;
+		}
+
+		instructions.erase(instructions.begin() + kept, instructions.end());
+	}
+
+	return changed;
+}
+
+bool DeadCodeElimination::remove_dead_instructions(ControlFlowGraph &cfg)
+{
+	// Where each SSA value is defined (block, index)
+	std::unordered_map<std::string, std::pair<int, size_t>> def_sites;
+	std::vector<std::vector<bool>> live(cfg.blocks.size());
+	std::vector<std::pair<int, size_t>> worklist;
+
+	for (auto &block : cfg.blocks)
+	{
+		live[block.id].assign(block.instructions.size(), false);
+
+		for (size_t i = 0; i < block.instructions.size(); i++)
+		{
+			const TACInstruction &instruction = block.instructions[i];
+			auto defs = get_tac_def_fields(instruction, gst.get());
+
+			bool only_defines_values = !defs.empty();
+			for (TACField field : defs)
+			{
+				if (ssa->is_ssa_value(instruction.*field))
+					def_sites[instruction.*field] = {block.id, i};
+				else
+					only_defines_values = false;
+			}
+
+			// Only writes to SSA values can go (anything else e.g. a global or a store through a pointer has to stay)
+			bool removable = is_pure(instruction) && only_defines_values &&
+							 defs.size() == 1 && defs[0] == get_target_field(instruction);
+
+			if (!removable)
+			{
+				live[block.id][i] = true;
+				worklist.emplace_back(block.id, i);
+			}
+		}
+	}
+
+	while (!worklist.empty())
+	{
+		auto [block, index] = worklist.back();
+		worklist.pop_back();
+
+		for (auto &name : get_tac_uses(cfg.blocks[block].instructions[index], gst.get()))
+		{
+			auto it = def_sites.find(name);
+			if (it == def_sites.end())
+				continue;
+
+			auto [def_block, def_index] = it->second;
+			if (!live[def_block][def_index])
+			{
+				live[def_block][def_index] = true;
+				worklist.emplace_back(def_block, def_index);
+			}
+		}
+	}
+
+	bool changed = false;
+
+	for (auto &block : cfg.blocks)
+	{
+		auto &instructions = block.instructions;
+		size_t kept = 0;
+
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			if (!live[block.id][i] || instructions[i].op == TACOp::NOP)
+			{
+				changed = true;
+				continue;
+			}
+
+			if (kept != i)
+				instructions[kept] = std::move(instructions[i]);
+			kept++;
+		}
+
+		instructions.erase(instructions.begin() + kept, instructions.end());
+	}
+
+	return changed;
+}
+
+bool DeadCodeElimination::run(ControlFlowGraph &cfg, const SSA &ssa)
+{
+	this->ssa = &ssa;
+
+	bool changed = cfg.remove_unreachable_blocks();
+	changed |= remove_dead_stores(cfg);
+	changed |= remove_dead_instructions(cfg);
+
+	return changed;
+}
@@ -0,0 +1,195 @@
+#include "../include/frameLayout.h"
+
+#include <algorithm>
+
+FrameLayout::FrameLayout(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+void FrameLayout::layout(const std::vector<TACInstruction> &instructions)
+{
+	for (auto [begin, end] : find_func_ranges(instructions))
+	{
+		gst->enter_func_scope(instructions[begin].arg1);
+		layout_func(instructions, begin, end);
+		gst->leave_func_scope();
+	}
+}
+
+int FrameLayout::get_alignment(int size)
+{
+	// Scalars are naturally aligned, anything bigger only needs to be 8 byte aligned
+	if (size >= 8)
+		return 8;
+	if (size >= 4)
+		return 4;
+	return size >= 2 ? 2 : 1;
+}
+
+std::unordered_set<std::string> FrameLayout::find_unpackable(const std::vector<TACInstruction> &instructions,
+															 size_t begin, size_t end)
+{
+	/*
+		Whilst a symbol is only ever accessed by name its lifetime is what liveness says it is
+		This isn't the case when:
+		- Its address is taken (it can be reached through the pointer at any time)
+		- It is an aggregate or char pointer (accessed piecewise/by address, see Assembler::emit_load)
+		- An instruction accesses it as something larger than it is
+	*/
+	std::unordered_set<std::string> unpackable;
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		if (instruction.op == TACOp::ADDR_OF)
+			unpackable.insert(instruction.arg1);
+
+		for (const std::string *name : {&instruction.arg1, &instruction.arg2, &instruction.result})
+		{
+			Symbol *symbol = st->get_symbol(*name);
+			if (!symbol)
+				continue;
+
+			if (is_aggregate(symbol->type) ||
+				(symbol->type.has_base_type(BaseType::CHAR) && symbol->type.is_pointer()))
+				unpackable.insert(*name);
+			else if (!symbol->type.is_pointer() && name != &instruction.arg2 && instruction.op != TACOp::CONVERT_TYPE &&
+					 instruction.type.get_size() > symbol->type.get_size())
+				unpackable.insert(*name);
+		}
+	}
+
+	return unpackable;
+}
+
+std::vector<FrameLayout::Slot> FrameLayout::build_slots(const std::vector<TACInstruction> &instructions, size_t begin,
+														size_t end, const Liveness &liveness)
+{
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+	std::unordered_set<std::string> unpackable = find_unpackable(instructions, begin, end);
+
+	// Every symbol still on the stack along with where it is mentioned
+	std::vector<std::string> names;
+	std::unordered_map<std::string, std::vector<int>> mentions;
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		for (const std::string *name : {&instruction.arg1, &instruction.arg2, &instruction.result})
+		{
+			Symbol *symbol = st->get_symbol(*name);
+			if (!is_local_symbol(symbol) || !symbol->reg.empty())
+				continue;
+
+			auto [it, inserted] = mentions.try_emplace(*name);
+			if (inserted)
+				names.push_back(*name);
+			it->second.push_back(i - begin);
+		}
+	}
+
+	const auto &live_in = liveness.get_live_in();
+	const auto &live_out = liveness.get_live_out();
+	int last = end - begin;
+
+	std::vector<Slot> slots;
+
+	for (auto &name : names)
+	{
+		Symbol *symbol = st->get_symbol(name);
+
+		// Anything which isn't sized (e.g. the result of a struct field load) is still accessed with movl
+		int size = symbol->type.get_size();
+		if (!is_aggregate(symbol->type))
+			size = std::max(size, 4);
+
+		Slot slot{name, size, 0, last};
+
+		if (symbol->type.is_struct() && !symbol->type.is_pointer())
+		{
+			slot.depth = -symbol->stack_offset;
+			slot.fixed = true;
+		}
+		else if (!unpackable.count(name))
+		{
+			const std::vector<int> &points = mentions[name];
+			slot.start = points.front();
+			slot.end = points.back();
+
+			int id = liveness.get_var_id(name);
+			if (id != -1)
+				for (int i = 0; i <= last; i++)
+					if (live_in[i][id] || live_out[i][id])
+					{
+						slot.start = std::min(slot.start, i);
+						slot.end = std::max(slot.end, i);
+					}
+		}
+
+		slots.push_back(slot);
+	}
+
+	return slots;
+}
+
+void FrameLayout::layout_func(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	Liveness liveness(gst);
+	liveness.analyse(instructions, begin, end);
+
+	std::vector<Slot> slots = build_slots(instructions, begin, end, liveness);
+
+	std::vector<Slot> placed;
+	for (auto &slot : slots)
+		if (slot.fixed)
+			placed.push_back(slot);
+
+	// Largest first (then in order of appearance) so smaller slots fill in behind them
+	std::stable_sort(slots.begin(), slots.end(),
+					 [](const Slot &a, const Slot &b)
+					 { return get_alignment(a.size) > get_alignment(b.size); });
+
+	auto align_to = [](int size, int alignment)
+	{ return (size + alignment - 1) & ~(alignment - 1); };
+
+	for (auto &slot : slots)
+	{
+		if (slot.fixed)
+			continue;
+
+		int alignment = get_alignment(slot.size);
+		slot.depth = align_to(slot.size, alignment);
+
+		// Move further down past anything it would overlap whilst both are alive
+		bool moved = true;
+		while (moved)
+		{
+			moved = false;
+			for (auto &other : placed)
+			{
+				bool overlaps_time = slot.start <= other.end && other.start <= slot.end;
+				bool overlaps_memory = other.depth - other.size < slot.depth && slot.depth - slot.size < other.depth;
+
+				if (overlaps_time && overlaps_memory)
+				{
+					slot.depth = align_to(other.depth + slot.size, alignment);
+					moved = true;
+				}
+			}
+		}
+
+		placed.push_back(slot);
+	}
+
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+
+	int frame_size = 0;
+	for (auto &slot : placed)
+	{
+		st->get_symbol(slot.name)->stack_offset = -slot.depth;
+		frame_size = std::max(frame_size, slot.depth);
+	}
+
+	st->set_stack_size(frame_size);
+}
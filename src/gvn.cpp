@@ -0,0 +1,215 @@
+#include "../include/gvn.h"
+
+#include <algorithm>
+
+#include "../include/sccp.h"
+
+GlobalValueNumbering::GlobalValueNumbering(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool GlobalValueNumbering::is_numbered_op(TACOp op) const
+{
+	switch (op)
+	{
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::DIV:
+	case TACOp::MOD:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	case TACOp::CONVERT_TYPE:
+	case TACOp::ADDR_OF:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool GlobalValueNumbering::is_commutative(TACOp op) const
+{
+	return op == TACOp::ADD || op == TACOp::MUL || op == TACOp::EQUAL || op == TACOp::NOT_EQUAL ||
+		   op == TACOp::AND || op == TACOp::OR;
+}
+
+bool GlobalValueNumbering::is_invariant_operand(const std::string &operand) const
+{
+	long long value;
+	if (operand.empty() || parse_int_literal(operand, value))
+		return true;
+
+	Symbol *symbol = gst->get_symbol(operand);
+	return symbol && (symbol->is_literal8 || ssa->is_ssa_value(operand));
+}
+
+const std::string &GlobalValueNumbering::get_leader(const std::string &name) const
+{
+	const std::string *leader = &name;
+
+	for (auto it = leaders.find(*leader); it != leaders.end(); it = leaders.find(*leader))
+		leader = &it->second;
+
+	return *leader;
+}
+
+bool GlobalValueNumbering::get_key(const TACInstruction &instruction, std::string &key) const
+{
+	Symbol *result = gst->get_symbol(instruction.result);
+	if (!result)
+		return false;
+
+	std::string a = instruction.arg1;
+	std::string b = instruction.arg2;
+
+	if (instruction.op == TACOp::ADDR_OF)
+	{
+		// The address of a variable never changes
+		if (!gst->get_symbol(a))
+			return false;
+	}
+	else
+	{
+		if (!is_invariant_operand(a) || !is_invariant_operand(b))
+			return false;
+
+		a = get_leader(a);
+
+		// CONVERT_TYPE holds the source type in arg2
+		if (instruction.op != TACOp::CONVERT_TYPE)
+			b = get_leader(b);
+	}
+
+	if (is_commutative(instruction.op) && b < a)
+		std::swap(a, b);
+
+	key = std::to_string(static_cast<int>(instruction.op)) + "|" + instruction.type.to_string() + "|" +
+		  result->type.to_string() + "|" + a + "|" + b;
+	return true;
+}
+
+bool GlobalValueNumbering::number_block(ControlFlowGraph &cfg, int block)
+{
+	bool changed = false;
+	std::vector<std::string> inserted;
+
+	for (auto &instruction : cfg.blocks[block].instructions)
+	{
+		if (instruction.op == TACOp::PHI)
+		{
+			// A PHI merging the same value from everywhere (other than itself) is just that value
+			std::string value = "";
+			bool is_redundant = !instruction.phi_args.empty();
+
+			for (auto &[pred, arg] : instruction.phi_args)
+			{
+				const std::string &leader = get_leader(arg);
+				if (leader == instruction.result)
+					continue;
+
+				if (value.empty())
+					value = leader;
+				else if (value != leader)
+					is_redundant = false;
+			}
+
+			Symbol *symbol = gst->get_symbol(value);
+			if (is_redundant && symbol && ssa->is_ssa_value(value) &&
+				symbol->type == gst->get_symbol(instruction.result)->type)
+				leaders[instruction.result] = value;
+
+			continue;
+		}
+
+		auto defs = get_tac_def_fields(instruction, gst.get());
+		if (defs.size() != 1 || !ssa->is_ssa_value(instruction.*defs[0]))
+			continue;
+
+		// Copies just give the value another name
+		if (instruction.op == TACOp::ASSIGN)
+		{
+			if (!instruction.arg2.empty() || !ssa->is_ssa_value(instruction.result))
+				continue;
+
+			if (gst->get_symbol(instruction.arg1)->type == gst->get_symbol(instruction.result)->type)
+				leaders[instruction.arg1] = get_leader(instruction.result);
+			continue;
+		}
+
+		std::string key;
+		if (!is_numbered_op(instruction.op) || defs[0] != &TACInstruction::result || !get_key(instruction, key))
+			continue;
+
+		auto it = available.find(key);
+		if (it == available.end())
+		{
+			available[key] = instruction.result;
+			inserted.push_back(key);
+			continue;
+		}
+
+		Type type = gst->get_symbol(instruction.result)->type;
+		leaders[instruction.result] = it->second;
+		instruction = TACInstruction(TACOp::ASSIGN, instruction.result, "", it->second, type);
+		changed = true;
+	}
+
+	for (int child : cfg.get_dom_children(block))
+		changed |= number_block(cfg, child);
+
+	for (auto &key : inserted)
+		available.erase(key);
+
+	return changed;
+}
+
+bool GlobalValueNumbering::replace_uses(ControlFlowGraph &cfg)
+{
+	bool changed = false;
+
+	auto replace = [&](std::string &operand)
+	{
+		const std::string &leader = get_leader(operand);
+		if (leader == operand)
+			return;
+
+		operand = leader;
+		changed = true;
+	};
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			if (instruction.op == TACOp::PHI)
+			{
+				for (auto &arg : instruction.phi_args)
+					replace(arg.second);
+				continue;
+			}
+
+			for (TACField field : get_tac_use_fields(instruction, gst.get()))
+				replace(instruction.*field);
+		}
+
+	return changed;
+}
+
+bool GlobalValueNumbering::run(ControlFlowGraph &cfg, const SSA &ssa)
+{
+	this->ssa = &ssa;
+
+	leaders.clear();
+	available.clear();
+
+	bool changed = number_block(cfg, cfg.get_entry());
+	changed |= replace_uses(cfg);
+
+	return changed;
+}
@@ -0,0 +1,347 @@
+#include "../include/inliner.h"
+
+#include <functional>
+
+#include "../include/cfg.h"
+#include "../include/liveness.h"
+
+Inliner::Inliner(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options) : gst(gst), options(options) {}
+
+size_t Inliner::get_cost(const std::vector<TACInstruction> &body) const
+{
+	// Roughly the number of instructions a call would copy
+	size_t cost = 0;
+	for (auto &instruction : body)
+	{
+		switch (instruction.op)
+		{
+		case TACOp::FUNC_BEGIN:
+		case TACOp::FUNC_END:
+		case TACOp::LABEL:
+		case TACOp::NOP:
+			break;
+		case TACOp::MOV_BETWEEN_REG:
+			if (instruction.result == "load")
+				cost++;
+			break;
+		default:
+			cost++;
+			break;
+		}
+	}
+
+	return cost;
+}
+
+std::unordered_map<std::string, Inliner::Param> Inliner::get_params(const std::vector<TACInstruction> &body) const
+{
+	// FUNC_BEGIN is followed by each parameter being stored from the register it was passed in
+	std::unordered_map<std::string, Param> params;
+	for (size_t i = 1; i < body.size(); i++)
+	{
+		if (body[i].op != TACOp::MOV_BETWEEN_REG || body[i].result != "store")
+			break;
+
+		params[body[i].arg2] = {body[i].arg1, body[i].type};
+	}
+
+	return params;
+}
+
+bool Inliner::is_inlinable(const std::string &callee, const std::string &caller)
+{
+	auto it = functions.find(callee);
+	if (callee == caller || callee == "main" || it == functions.end())
+		return false;
+
+	const std::vector<TACInstruction> &body = it->second;
+	if (body.front().arg2 == "global" || get_cost(body) > (size_t)options.inline_threshold)
+		return false;
+
+	// Parameters passed on the stack aren't stored at the start
+	FuncSymbol *func = gst->get_func_symbol(callee);
+	auto params = get_params(body);
+	if (!func || (int)params.size() != func->arg_count)
+		return false;
+
+	SymbolTable *callee_st = gst->get_func_st(callee);
+	SymbolTable *caller_st = gst->get_func_st(caller);
+
+	for (auto &instruction : body)
+	{
+		switch (instruction.op)
+		{
+		case TACOp::CALL:
+			if (instruction.arg1 == callee)
+				return false;
+			break;
+		case TACOp::INCREMENT:
+		case TACOp::DECREMENT:
+		case TACOp::STRUCT_INIT:
+		case TACOp::PHI:
+			return false;
+		default:
+			break;
+		}
+
+		for (const std::string *name : {&instruction.arg1, &instruction.arg2, &instruction.result})
+		{
+			Symbol *symbol = callee_st->get_symbol(*name);
+			if (!symbol)
+				continue;
+
+			// Copies of aggregates/char pointers aren't plain value copies
+			if (is_local_symbol(symbol))
+			{
+				if (is_aggregate(symbol->type) ||
+					(symbol->type.has_base_type(BaseType::CHAR) && symbol->type.is_pointer()))
+					return false;
+				continue;
+			}
+
+			// Statics (and constants) are shared so keep their name, which mustn't mean something else in the caller
+			Symbol *existing = caller_st->get_symbol(*name);
+			if (!symbol->is_global && existing && (is_local_symbol(existing) || existing->is_literal8 != symbol->is_literal8))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool Inliner::inline_call(const std::string &caller, const std::string &callee, size_t call)
+{
+	std::vector<TACInstruction> &instructions = functions[caller];
+	const std::vector<TACInstruction> &body = functions[callee];
+
+	FuncSymbol *func = gst->get_func_symbol(callee);
+	auto params = get_params(body);
+
+	// Find where each argument is loaded into its register (the arguments can't be split up by another call)
+	std::unordered_map<std::string, size_t> loads;
+	for (size_t i = call; i-- > 0 && loads.size() < params.size();)
+	{
+		const TACInstruction &instruction = instructions[i];
+		if (instruction.op == TACOp::MOV_BETWEEN_REG && instruction.result == "load" &&
+			params.count(instruction.arg2) && !loads.count(instruction.arg2))
+			loads[instruction.arg2] = i;
+		else if (instruction.op == TACOp::MOV_BETWEEN_REG || instruction.op == TACOp::CALL ||
+				 instruction.op == TACOp::PUSH || instruction.op == TACOp::POP || instruction.op == TACOp::LABEL ||
+				 ControlFlowGraph::is_terminator(instruction))
+			return false;
+	}
+
+	if (loads.size() != params.size())
+		return false;
+
+	std::string result;
+	bool has_result_store = call + 1 < instructions.size() &&
+							instructions[call + 1].op == TACOp::MOV_BETWEEN_REG &&
+							instructions[call + 1].result == "store" &&
+							(instructions[call + 1].arg2 == "%rax" || instructions[call + 1].arg2 == "%xmm0");
+	if (has_result_store)
+		result = instructions[call + 1].arg1;
+
+	int site = site_count++;
+	std::string prefix = ".L" + caller + "_inline" + std::to_string(site);
+	std::string label_end = prefix + "_end";
+
+	/*
+		Copy the body with every local of the callee renamed (so it can be inlined more than once)
+		This has to be done in the callee's scope so its symbols can be found
+	*/
+	std::unordered_map<std::string, std::string> renamed;
+	std::unordered_map<std::string, Type> new_locals;
+	std::vector<std::pair<std::string, Symbol *>> shared;
+	std::vector<TACInstruction> copy;
+
+	auto rename = [&](const std::string &name)
+	{
+		auto it = renamed.find(name);
+		if (it != renamed.end())
+			return it->second;
+
+		std::string new_name = name + "." + callee + std::to_string(site);
+		renamed[name] = new_name;
+		new_locals[new_name] = gst->get_symbol(name)->type;
+		return new_name;
+	};
+
+	int label_count = 0;
+	auto rename_label = [&](const std::string &label)
+	{
+		auto it = renamed.find(label);
+		if (it != renamed.end())
+			return it->second;
+
+		return renamed[label] = prefix + "_" + std::to_string(label_count++);
+	};
+
+	gst->enter_func_scope(callee);
+
+	for (size_t i = 1 + params.size(); i < body.size(); i++)
+	{
+		TACInstruction instruction = body[i];
+
+		for (TACField field : get_tac_use_fields(instruction, gst.get()))
+			instruction.*field = rename(instruction.*field);
+		for (TACField field : get_tac_def_fields(instruction, gst.get()))
+			instruction.*field = rename(instruction.*field);
+
+		for (const std::string *name : {&instruction.arg1, &instruction.arg2, &instruction.result})
+		{
+			Symbol *symbol = gst->get_symbol(*name);
+			if (symbol && !is_local_symbol(symbol) && !symbol->is_global)
+				shared.emplace_back(*name, symbol);
+		}
+
+		switch (instruction.op)
+		{
+		case TACOp::LABEL:
+			instruction.arg1 = rename_label(instruction.arg1);
+			copy.push_back(instruction);
+			break;
+		case TACOp::GOTO:
+		case TACOp::IF:
+			instruction.result = rename_label(instruction.result);
+			copy.push_back(instruction);
+			break;
+		case TACOp::RETURN:
+			if (!result.empty() && !instruction.arg1.empty())
+				copy.emplace_back(TACOp::ASSIGN, result, "", instruction.arg1, func->return_type);
+			copy.emplace_back(TACOp::GOTO, "", "", label_end);
+			break;
+		case TACOp::FUNC_END:
+			copy.emplace_back(TACOp::LABEL, label_end);
+			break;
+		default:
+			copy.push_back(instruction);
+			break;
+		}
+	}
+
+	// Each argument load becomes a copy into its (renamed) parameter
+	std::vector<std::pair<size_t, TACInstruction>> arg_copies;
+	for (auto &[reg, index] : loads)
+	{
+		const Param &param = params[reg];
+		arg_copies.emplace_back(index, TACInstruction(TACOp::ASSIGN, rename(param.name), "", instructions[index].arg1,
+													  param.type));
+	}
+
+	gst->leave_func_scope();
+	gst->enter_func_scope(caller);
+
+	for (auto &[name, type] : new_locals)
+		gst->declare_temp_var(name, type);
+
+	for (auto &[name, symbol] : shared)
+	{
+		if (gst->get_symbol(name))
+			continue;
+
+		if (symbol->is_literal8)
+			gst->declare_const_var(name, symbol->type);
+		else
+			gst->declare_str_var(name, symbol->type);
+	}
+
+	gst->leave_func_scope();
+
+	// A jump to the end straight before it isn't needed
+	if (copy.size() >= 2 && copy[copy.size() - 2].op == TACOp::GOTO && copy[copy.size() - 2].result == label_end)
+		copy.erase(copy.end() - 2);
+
+	for (auto &[index, arg_copy] : arg_copies)
+		instructions[index] = arg_copy;
+
+	instructions.erase(instructions.begin() + call, instructions.begin() + call + (has_result_store ? 2 : 1));
+	instructions.insert(instructions.begin() + call, copy.begin(), copy.end());
+
+	return true;
+}
+
+void Inliner::inline_calls(const std::string &caller)
+{
+	for (size_t i = 0; i < functions[caller].size(); i++)
+	{
+		const TACInstruction &instruction = functions[caller][i];
+		if (instruction.op != TACOp::CALL || !is_inlinable(instruction.arg1, caller))
+			continue;
+
+		std::string callee = instruction.arg1;
+		size_t size = functions[caller].size();
+
+		if (!inline_call(caller, callee, i))
+			continue;
+
+		inlined.insert(callee);
+
+		// The copied body has already had its own calls inlined
+		i += functions[caller].size() - size;
+	}
+}
+
+bool Inliner::run(std::vector<TACInstruction> &instructions)
+{
+	functions.clear();
+	inlined.clear();
+
+	auto ranges = find_func_ranges(instructions);
+
+	std::vector<std::string> names;
+	for (auto [begin, end] : ranges)
+	{
+		names.push_back(instructions[begin].arg1);
+		functions[names.back()] = std::vector<TACInstruction>(instructions.begin() + begin,
+															  instructions.begin() + end + 1);
+	}
+
+	// Callees before their callers
+	std::vector<std::string> order;
+	std::unordered_set<std::string> visited;
+
+	std::function<void(const std::string &)> visit = [&](const std::string &name)
+	{
+		if (!visited.insert(name).second)
+			return;
+
+		for (auto &instruction : functions[name])
+			if (instruction.op == TACOp::CALL && functions.count(instruction.arg1))
+				visit(instruction.arg1);
+
+		order.push_back(name);
+	};
+
+	for (auto &name : names)
+		visit(name);
+
+	for (auto &name : order)
+		inline_calls(name);
+
+	if (inlined.empty())
+		return false;
+
+	// Functions which are no longer called from anywhere in the module
+	std::unordered_set<std::string> called;
+	for (auto &[name, body] : functions)
+		for (auto &instruction : body)
+			if (instruction.op == TACOp::CALL)
+				called.insert(instruction.arg1);
+
+	// Work backwards so replacing a function doesn't move the ones still to be done
+	for (size_t i = ranges.size(); i-- > 0;)
+	{
+		auto [begin, end] = ranges[i];
+		const std::string &name = names[i];
+
+		std::vector<TACInstruction> replacement;
+		if (!inlined.count(name) || called.count(name))
+			replacement = functions[name];
+
+		instructions.erase(instructions.begin() + begin, instructions.begin() + end + 1);
+		instructions.insert(instructions.begin() + begin, replacement.begin(), replacement.end());
+	}
+
+	return true;
+}
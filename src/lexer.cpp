@@ -1,13 +1,21 @@
 #include <iostream>
 #include <string>
-#include <unordered_set>
 
 #include "../include/lexer.h"
+#include "../include/simdScan.h"
 
-Token::Token(TokenType t, const std::string &txt, size_t l, size_t i)
+Token::Token(TokenType t, std::string_view txt, size_t l, size_t i)
     : type(t), text(txt), line(l), index(i) {}
 
-std::unordered_map<std::string, TokenType> string_to_token = {
+namespace {
+
+struct Spelling {
+  std::string_view text;
+  TokenType type;
+};
+
+// How every keyword and symbol is written (only used to recognise keywords and for error messages)
+constexpr Spelling spellings[] = {
     {"int", TOKEN_INT},
     {"void", TOKEN_VOID},
     {"if", TOKEN_IF},
@@ -75,48 +83,101 @@ std::unordered_map<std::string, TokenType> string_to_token = {
     {"null", TOKEN_NULL},
 };
 
-Lexer::Lexer(const std::string &src) : source(src), index(0) {}
+constexpr bool is_keyword(const Spelling &spelling) {
+  return spelling.text[0] >= 'a' && spelling.text[0] <= 'z';
+}
+
+/*
+    Keywords are recognised with a perfect hash (no two of them hash to the same slot)
+    so an identifier is only ever compared against the one keyword it could be
+    The table is built at compile time and the static_assert below fails if a keyword
+    is added which collides (in which case the multipliers need changing)
+*/
+constexpr size_t KEYWORD_TABLE_SIZE = 64;
+
+constexpr size_t keyword_hash(std::string_view text) {
+  return ((unsigned char)text[0] + (unsigned char)text[1] * 5 +
+          (unsigned char)text.back() * 35 + text.length()) %
+         KEYWORD_TABLE_SIZE;
+}
+
+struct KeywordTable {
+  Spelling slots[KEYWORD_TABLE_SIZE] = {};
+
+  constexpr KeywordTable() {
+    for (const Spelling &spelling : spellings)
+      if (is_keyword(spelling))
+        slots[keyword_hash(spelling.text)] = spelling;
+  }
+};
+
+constexpr KeywordTable keyword_table;
+
+constexpr bool is_perfect_hash() {
+  for (const Spelling &spelling : spellings)
+    if (is_keyword(spelling) &&
+        keyword_table.slots[keyword_hash(spelling.text)].text != spelling.text)
+      return false;
+  return true;
+}
+
+static_assert(is_perfect_hash(), "Two keywords hash to the same slot");
+
+TokenType keyword_type(std::string_view text) {
+  // Every keyword is at least two characters long
+  if (text.length() < 2)
+    return TOKEN_IDENTIFIER;
+
+  const Spelling &slot = keyword_table.slots[keyword_hash(text)];
+  return slot.text == text ? slot.type : TOKEN_IDENTIFIER;
+}
+
+} // namespace
+
+Lexer::Lexer(std::string_view src) : source(src), index(0) {}
 
-std::string Lexer::process_number() {
-  std::string temp_number;
+// The character offset past the current one (or '\0' past the end of the source)
+char Lexer::peek(size_t offset) const {
+  return index + offset < source.length() ? source[index + offset] : '\0';
+}
+
+std::string_view Lexer::process_number() {
+  size_t start = index;
   bool has_decimal = false;
   bool has_exponent = false;
 
   // Process integer part or leading decimal
-  while (index < source.length() &&
-         (std::isdigit(source[index]) || source[index] == '.')) {
-    if (source[index] == '.') {
-      if (has_decimal)
-        break; // Second decimal point - stop
-      has_decimal = true;
-    }
-    temp_number += source[index++];
+  while (true) {
+    index = skip_digits(source, index);
+    if (peek() != '.' || has_decimal)
+      break; // Second decimal point - stop
+    has_decimal = true;
+    index++;
   }
 
   // Process exponent part if it exists
   if (index < source.length() &&
       (source[index] == 'e' || source[index] == 'E')) {
-    temp_number += source[index++];
+    index++;
     has_exponent = true;
 
     // Handle optional sign in exponent
     if (index < source.length() &&
         (source[index] == '+' || source[index] == '-'))
-      temp_number += source[index++];
+      index++;
 
     // Process exponent digits
-    bool has_exp_digits = false;
-    while (index < source.length() && std::isdigit(source[index])) {
-      temp_number += source[index++];
-      has_exp_digits = true;
-    }
+    size_t exp_start = index;
+    index = skip_digits(source, index);
 
     // If no digits after E, it's invalid
-    if (!has_exp_digits)
+    if (index == exp_start)
       throw std::runtime_error("Lexer Error: Invalid number format on line " +
                                std::to_string(line));
   }
 
+  std::string_view temp_number = source.substr(start, index - start);
+
   // Validate the number format
   if (temp_number == ".")
     throw std::runtime_error("Lexer Error: Invalid number format on line " +
@@ -125,40 +186,105 @@ std::string Lexer::process_number() {
   return temp_number;
 }
 
-std::string Lexer::process_identifier() {
-  std::string temp_identifier;
+std::string_view Lexer::process_identifier() {
+  size_t start = index;
 
-  while (index < source.length() && std::isalnum(source[index]))
-    temp_identifier += source[index++];
+  index = skip_alnum(source, index);
 
-  return temp_identifier;
+  return source.substr(start, index - start);
 }
 
-std::string Lexer::process_symbol() {
-  static const std::unordered_set<std::string> multi_char_symbols = {
-      "&&", "||", "==", "!=", ">=", "<=", "++",
-      "--", "->", "+=", "-=", "*=", "/=", "%="};
+Token Lexer::process_symbol() {
+  size_t init_index = index;
+  char next = peek(1);
+  TokenType type = TOKEN_UNKNOWN_SYMBOL;
+
+  // Two character symbols first (which all start with what would otherwise be a symbol on its own)
+  switch (source[index]) {
+  case '&':
+    type = next == '&' ? TOKEN_AND : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '|':
+    type = next == '|' ? TOKEN_OR : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '=':
+    type = next == '=' ? TOKEN_EQUALS : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '!':
+    type = next == '=' ? TOKEN_NOT_EQUALS : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '<':
+    type = next == '=' ? TOKEN_LE : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '>':
+    type = next == '=' ? TOKEN_GE : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '+':
+    type = next == '+'   ? TOKEN_INCREMENT
+           : next == '=' ? TOKEN_PLUS_EQUALS
+                         : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '-':
+    type = next == '-'   ? TOKEN_DECREMENT
+           : next == '>' ? TOKEN_ARROW
+           : next == '=' ? TOKEN_MINUS_EQUALS
+                         : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '*':
+    type = next == '=' ? TOKEN_STAR_EQUALS : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '/':
+    type = next == '=' ? TOKEN_SLASH_EQUALS : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  case '%':
+    type = next == '=' ? TOKEN_MODULUS_EQUALS : TOKEN_UNKNOWN_SYMBOL;
+    break;
+  }
 
-  std::string symbol(1, source[index++]);
+  if (type != TOKEN_UNKNOWN_SYMBOL) {
+    index += 2;
+    return Token(type, source.substr(init_index, 2), line, init_index);
+  }
 
-  if (index < source.length()) {
-    std::string potential_symbol = symbol + source[index];
-    if (multi_char_symbols.find(potential_symbol) != multi_char_symbols.end()) {
-      symbol = potential_symbol;
-      index++;
-    }
+  switch (source[index]) {
+  case '(': type = TOKEN_LPAREN; break;
+  case ')': type = TOKEN_RPAREN; break;
+  case '{': type = TOKEN_LBRACE; break;
+  case '}': type = TOKEN_RBRACE; break;
+  case '[': type = TOKEN_LSBRACE; break;
+  case ']': type = TOKEN_RSBRACE; break;
+  case ';': type = TOKEN_SEMICOLON; break;
+  case ',': type = TOKEN_COMMA; break;
+  case '.': type = TOKEN_DOT; break;
+  case '?': type = TOKEN_QUESTION_MARK; break;
+  case ':': type = TOKEN_COLON; break;
+  case '+': type = TOKEN_PLUS; break;
+  case '-': type = TOKEN_MINUS; break;
+  case '*': type = TOKEN_STAR; break;
+  case '/': type = TOKEN_SLASH; break;
+  case '%': type = TOKEN_PERCENT; break;
+  case '=': type = TOKEN_ASSIGN; break;
+  case '!': type = TOKEN_EXCLAMATION; break;
+  case '~': type = TOKEN_TILDA; break;
+  case '<': type = TOKEN_LT; break;
+  case '>': type = TOKEN_GT; break;
+  case '&': type = TOKEN_AMPERSAND; break;
+  default:
+    std::cout << "Lexer Error: Unknown symbol\n";
   }
 
-  return symbol;
+  index += 1;
+  return Token(type, source.substr(init_index, 1), line, init_index);
 }
 
 Token Lexer::process_char() {
   size_t init_index = index;
   char value;
 
-  if (source[++index] == '\\') {
+  index += 1;
+  if (peek() == '\\') {
     index += 1;
-    switch (source[index]) {
+    switch (peek()) {
     case 'n':
       value = '\n';
       break;
@@ -179,67 +305,90 @@ Token Lexer::process_char() {
                                std::to_string(line));
     }
   } else {
-    value = source[index];
+    value = peek();
   }
 
-  if (source[++index] != '\'')
+  index += 1;
+  if (peek() != '\'')
     throw std::runtime_error("Lexer Error: Unterminanted char on line " +
                              std::to_string(line));
 
   index += 1;
-  state_stack.push({init_index, line});
-  return Token(TOKEN_CHAR, std::string(1, value), line, init_index);
+
+  // Without an escape the character is already in the source
+  if (index - init_index == 3)
+    return Token(TOKEN_CHAR, source.substr(init_index + 1, 1), line, init_index);
+
+  unescaped.emplace_back(1, value);
+  return Token(TOKEN_CHAR, unescaped.back(), line, init_index);
 }
 
 Token Lexer::process_string() {
   size_t init_index = index;
   std::string str;
+  bool has_escape = false;
 
   index += 1;
 
-  while (source[index] != '"' && index <= source.length()) {
-    if (source[index] == '\\') {
-      index += 1;
-      switch (source[index]) {
-      case 'n':
-        str += '\n';
-        break;
-      case 't':
-        str += '\t';
-        break;
-      case '\\':
-        str += '\\';
-        break;
-      case '"':
-        str += '"';
-        break;
-      default:
-        str += source[index];
-      }
-    } else {
-      str += source[index];
+  while (index < source.length()) {
+    // Everything up to the next quote or escape is taken as it is
+    size_t stop = find_either_char(source, index, '"', '\\');
+    if (has_escape)
+      str.append(source.substr(index, stop - index));
+    index = stop;
+
+    if (index >= source.length() || source[index] == '"')
+      break;
+
+    // Only copied out of the source once there is an escape in it
+    if (!has_escape)
+      str = source.substr(init_index + 1, index - init_index - 1);
+    has_escape = true;
+    index += 1;
+    switch (peek()) {
+    case 'n':
+      str += '\n';
+      break;
+    case 't':
+      str += '\t';
+      break;
+    case '\\':
+      str += '\\';
+      break;
+    case '"':
+      str += '"';
+      break;
+    default:
+      str += peek();
     }
     index += 1;
   }
 
-  if (source[index] != '"')
+  if (peek() != '"')
     throw std::runtime_error("Lexer Error: Unterminated string on line " +
                              std::to_string(line));
 
   index += 1;
-  state_stack.push({init_index, line});
-  return Token(TOKEN_STRING, str, line, init_index);
+
+  // Only a string with escapes in it differs from what is between the quotes
+  if (!has_escape)
+    return Token(TOKEN_STRING, source.substr(init_index + 1, index - init_index - 2), line, init_index);
+
+  unescaped.push_back(std::move(str));
+  return Token(TOKEN_STRING, unescaped.back(), line, init_index);
 }
 
 Token Lexer::get_next_token() {
+  // Whitespace is skipped a whole run at a time (counting the lines it covers)
+  size_t end = skip_whitespace(source, index);
+  line += count_newlines(source, index, end);
+  index = end;
+
   if (index >= source.length())
     return Token(TOKEN_EOF, "", line, index);
 
   char c = source[index];
 
-  if (c == '\n')
-    line++;
-
   if (c == '\'')
     return process_char();
   else if (c == '"')
@@ -253,9 +402,7 @@ Token Lexer::get_next_token() {
             - Consume until the end of the line
             - return the next token
     */
-    index += 2;
-    while (index < source.length() && source[index] != '\n')
-      index++;
+    index = find_char(source, index + 2, '\n');
     return get_next_token();
   } else if (c == '/' && index + 1 < source.length() &&
              source[index + 1] == '*') {
@@ -267,108 +414,75 @@ Token Lexer::get_next_token() {
             - Return the next token
     */
     index += 2; // Skip '/*'
+    size_t comment_start = index;
+    bool is_terminated = false;
 
-    while (index + 1 < source.length()) {
-      if (source[index] == '*' && source[index + 1] == '/') {
-        index += 2; // Skip '*/'
+    // Only a '*' can start the end of the comment
+    while ((index = find_char(source, index, '*')) + 1 < source.length()) {
+      if (source[index + 1] == '/') {
+        is_terminated = true;
         break;
       }
-      if (source[index] == '\n')
-        line++; // Track line numbers
       index++;
     }
 
+    line += count_newlines(source, comment_start, index); // Track line numbers
+
     // If we hit EOF without finding */, that's a lexing error
-    if (index >= source.length())
+    if (!is_terminated)
       throw std::runtime_error("Unterminated block comment at line " +
                                std::to_string(line));
 
+    index += 2; // Skip '*/'
+
     return get_next_token();
   } else if (isdigit(c) || c == '.') {
     size_t init_index = index;
 
-    if (c == '.' && !isdigit(source[index + 1])) {
+    if (c == '.' && !isdigit(peek(1))) {
       index += 1;
-      state_stack.push({init_index, line});
       return Token(TOKEN_DOT, ".", line, init_index);
     }
 
-    std::string num = process_number();
+    std::string_view num = process_number();
     if (num.find('.') != std::string::npos ||
         num.find('e') != std::string::npos ||
         num.find('E') != std::string::npos) {
-      state_stack.push({init_index, line});
       return Token(TOKEN_FPN, num, line, init_index);
     }
-    state_stack.push({init_index, line});
     return Token(TOKEN_NUMBER, num, line, init_index);
   } else if (isalpha(c)) {
     size_t init_index = index;
-    std::string temp_identifier = process_identifier();
-
-    auto it = string_to_token.find(temp_identifier);
-    TokenType token_type =
-        (it != string_to_token.end()) ? it->second : TOKEN_IDENTIFIER;
-
-    state_stack.push({init_index, line});
-    return Token(token_type, temp_identifier, line, init_index);
-  } else if (!isspace(c)) {
-    size_t init_index = index;
-    std::string temp_symbol = process_symbol();
-
-    auto it = string_to_token.find(temp_symbol);
-    TokenType token_type =
-        (it != string_to_token.end()) ? it->second : TOKEN_UNKNOWN_SYMBOL;
-
-    if (token_type == TOKEN_UNKNOWN_SYMBOL)
-      std::cout << "Lexer Error: Unknown symbol\n";
-
-    state_stack.push({init_index, line});
-    return Token(token_type, temp_symbol, line, init_index);
+    std::string_view temp_identifier = process_identifier();
+    return Token(keyword_type(temp_identifier), temp_identifier, line, init_index);
   }
 
-  index++;
-  return get_next_token();
+  return process_symbol();
 }
 
-Token Lexer::rewind(int iterations) {
-  if (state_stack.size() > 1) {
-    for (int i = 0; i < iterations; i++)
-      state_stack.pop();
+const std::vector<Token> &Lexer::tokenise() {
+  if (!tokens.empty())
+    return tokens;
 
-    LexerState state = state_stack.top();
-    index = state.index;
-    line = state.line;
-    return get_next_token();
-  }
+  // Roughly a token per few characters, saving the vector regrowing as often
+  tokens.reserve(source.length() / 4 + 1);
 
-  state_stack.push({index, line});
-  return Token(TOKEN_EOF, "", line, index);
-}
+  do
+    tokens.push_back(get_next_token());
+  while (tokens.back().type != TOKEN_EOF);
 
-void Lexer::print_all_tokens() {
-  Token next_token = get_next_token();
-  while (next_token.type != TOKEN_EOF) {
-    std::cout << next_token.text << std::endl;
-    next_token = get_next_token();
-  }
+  return tokens;
 }
 
-void Lexer::print_stack() {
-  std::stack<LexerState> temp_stack = state_stack;
-  std::cout << "Stack size is " << temp_stack.size() << std::endl;
-  std::cout << "Stack contents (top to bottom):\n";
-  while (!temp_stack.empty()) {
-    LexerState state = temp_stack.top();
-    std::cout << "Index: " << state.index << ", Line: " << state.line
-              << ", Char: " << source[state.index] << "\n";
-    temp_stack.pop();
-  }
+void Lexer::print_all_tokens() {
+  for (const Token &token : tokenise())
+    if (token.type != TOKEN_EOF)
+      std::cout << token.text << std::endl;
 }
 
 std::string Lexer::token_to_string(const TokenType &token_type) {
-  for (const auto &pair : string_to_token)
-    if (pair.second == token_type)
-      return pair.first;
+  for (const Spelling &spelling : spellings)
+    if (spelling.type == token_type)
+      return std::string(spelling.text);
   return "Unknown (" + std::to_string(static_cast<int>(token_type)) + ")";
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "../include/licm.h"
+
+#include <algorithm>
+#include <map>
+
+#include "../include/sccp.h"
+
+LoopInvariantCodeMotion::LoopInvariantCodeMotion(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool LoopInvariantCodeMotion::is_hoistable_op(const TACInstruction &instruction) const
+{
+	switch (instruction.op)
+	{
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	case TACOp::CONVERT_TYPE:
+	case TACOp::ADDR_OF:
+		return true;
+	case TACOp::DIV:
+	case TACOp::MOD:
+	{
+		// Only when it can't fault (the loop might not have run it)
+		long long value;
+		return parse_int_literal(instruction.arg2, value) && value != 0 && value != -1;
+	}
+	default:
+		return false;
+	}
+}
+
+bool LoopInvariantCodeMotion::is_hoistable_load(const TACInstruction &instruction) const
+{
+	/*
+		ASSIGN dst, index -> src
+		Only loads from a variable (or a constant index into one) which isn't stored to
+	*/
+	if (instruction.op != TACOp::ASSIGN || has_unknown_stores)
+		return false;
+
+	Symbol *src = gst->get_symbol(instruction.result);
+	if (!src || src->is_literal8 || ssa->is_ssa_value(instruction.result) || written.count(instruction.result))
+		return false;
+
+	long long index;
+	if (instruction.arg2.empty())
+		return !is_aggregate(src->type);
+
+	return is_aggregate(src->type) && parse_int_literal(instruction.arg2, index);
+}
+
+void LoopInvariantCodeMotion::find_stores(const ControlFlowGraph &cfg, const Loop &loop)
+{
+	written.clear();
+	has_unknown_stores = false;
+
+	for (int block : loop.blocks)
+		for (auto &instruction : cfg.blocks[block].instructions)
+		{
+			switch (instruction.op)
+			{
+			case TACOp::ASSIGN:
+			case TACOp::VEC_STORE:
+				written.insert(instruction.arg1);
+				break;
+			case TACOp::MOV_BETWEEN_REG:
+				if (instruction.result == "store")
+					written.insert(instruction.arg1);
+				break;
+			case TACOp::CALL:
+			case TACOp::PRINTF:
+			case TACOp::ASSIGN_DEREF:
+			case TACOp::STRUCT_INIT:
+			case TACOp::INCREMENT:
+			case TACOp::DECREMENT:
+			case TACOp::POP:
+				has_unknown_stores = true;
+				break;
+			default:
+				if (!instruction.result.empty())
+					written.insert(instruction.result);
+				break;
+			}
+		}
+}
+
+std::vector<std::pair<int, size_t>> LoopInvariantCodeMotion::find_invariants(const ControlFlowGraph &cfg,
+																			   const Loop &loop)
+{
+	find_stores(cfg, loop);
+
+	std::unordered_set<std::string> defined_in_loop;
+	for (int block : loop.blocks)
+		for (auto &instruction : cfg.blocks[block].instructions)
+			for (auto &def : get_tac_defs(instruction, gst.get()))
+				defined_in_loop.insert(def);
+
+	std::vector<int> order = loop.blocks;
+	std::sort(order.begin(), order.end(), [&](int a, int b)
+			  { return std::find(cfg.get_rpo().begin(), cfg.get_rpo().end(), a) <
+					   std::find(cfg.get_rpo().begin(), cfg.get_rpo().end(), b); });
+
+	std::unordered_set<std::string> invariant;
+	std::vector<std::pair<int, size_t>> found;
+
+	auto is_invariant_operand = [&](const std::string &operand)
+	{
+		long long value;
+		if (operand.empty() || parse_int_literal(operand, value))
+			return true;
+
+		Symbol *symbol = gst->get_symbol(operand);
+		if (!symbol)
+			return false;
+
+		if (symbol->is_literal8)
+			return true;
+
+		if (ssa->is_ssa_value(operand))
+			return !defined_in_loop.count(operand) || invariant.count(operand);
+
+		// Read straight from memory (e.g. a global)
+		return !has_unknown_stores && !written.count(operand) && !is_aggregate(symbol->type);
+	};
+
+	// Repeat as hoisting one instruction can make those using its result invariant
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (int block : order)
+		{
+			auto &instructions = cfg.blocks[block].instructions;
+			for (size_t i = 0; i < instructions.size(); i++)
+			{
+				const TACInstruction &instruction = instructions[i];
+
+				auto defs = get_tac_def_fields(instruction, gst.get());
+				if (defs.size() != 1 || !ssa->is_ssa_value(instruction.*defs[0]) ||
+					invariant.count(instruction.*defs[0]))
+					continue;
+
+				bool is_invariant = false;
+				if (instruction.op == TACOp::ASSIGN)
+					is_invariant = is_hoistable_load(instruction) && is_invariant_operand(instruction.arg2);
+				else if (instruction.op == TACOp::ADDR_OF)
+					is_invariant = true;
+				else if (is_hoistable_op(instruction))
+					is_invariant = is_invariant_operand(instruction.arg1) &&
+								   (instruction.op == TACOp::CONVERT_TYPE || is_invariant_operand(instruction.arg2));
+
+				if (!is_invariant)
+					continue;
+
+				invariant.insert(instruction.*defs[0]);
+				found.emplace_back(block, i);
+				changed = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+bool LoopInvariantCodeMotion::hoist(ControlFlowGraph &cfg, const std::string &header_label)
+{
+	auto find_loop = [&](Loop &loop)
+	{
+		for (auto &candidate : cfg.find_loops())
+			if (cfg.blocks[candidate.header].label == header_label)
+			{
+				loop = candidate;
+				return true;
+			}
+
+		return false;
+	};
+
+	Loop loop;
+	if (!find_loop(loop) || find_invariants(cfg, loop).empty())
+		return false;
+
+	int preheader = cfg.get_preheader(loop);
+	if (preheader < 0)
+		return false;
+
+	// Inserting the preheader renumbers the blocks
+	if (!find_loop(loop))
+		return false;
+
+	auto invariants = find_invariants(cfg, loop);
+
+	auto &destination = cfg.blocks[preheader].instructions;
+	auto position = !destination.empty() && ControlFlowGraph::is_terminator(destination.back()) ? destination.end() - 1
+																								 : destination.end();
+
+	std::vector<TACInstruction> hoisted;
+	for (auto [block, i] : invariants)
+		hoisted.push_back(cfg.blocks[block].instructions[i]);
+	destination.insert(position, hoisted.begin(), hoisted.end());
+
+	// Remove from the back of each block so the earlier indexes stay valid
+	std::map<int, std::vector<size_t>> removed;
+	for (auto [block, i] : invariants)
+		removed[block].push_back(i);
+
+	for (auto &[block, indexes] : removed)
+	{
+		std::sort(indexes.rbegin(), indexes.rend());
+		for (size_t i : indexes)
+			cfg.blocks[block].instructions.erase(cfg.blocks[block].instructions.begin() + i);
+	}
+
+	return true;
+}
+
+bool LoopInvariantCodeMotion::run(ControlFlowGraph &cfg, const SSA &ssa)
+{
+	this->ssa = &ssa;
+
+	bool changed = false;
+	std::unordered_set<std::string> done;
+
+	cfg.compute_dominators();
+
+	// Each loop is looked at once (innermost first) by the label of its header
+	while (true)
+	{
+		std::string header_label = "";
+		for (auto &loop : cfg.find_loops())
+		{
+			const std::string &label = cfg.blocks[loop.header].label;
+			if (!label.empty() && !done.count(label))
+			{
+				header_label = label;
+				break;
+			}
+		}
+
+		if (header_label.empty())
+			break;
+
+		done.insert(header_label);
+		changed |= hoist(cfg, header_label);
+	}
+
+	return changed;
+}
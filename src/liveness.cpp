@@ -0,0 +1,304 @@
+#include "../include/liveness.h"
+
+#include <algorithm>
+
+bool is_local_symbol(Symbol *symbol)
+{
+	return symbol && !symbol->has_static_sd() && !symbol->is_literal8 && !symbol->is_global;
+}
+
+static void add_if_local(std::vector<TACField> &fields, const TACInstruction &instruction, TACField field,
+						 GlobalSymbolTable *gst)
+{
+	const std::string &name = instruction.*field;
+
+	if (name.empty())
+		return;
+
+	if (is_local_symbol(gst->get_symbol(name)))
+		fields.push_back(field);
+}
+
+std::vector<TACField> get_tac_use_fields(const TACInstruction &instruction, GlobalSymbolTable *gst)
+{
+	std::vector<TACField> uses;
+
+	switch (instruction.op)
+	{
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::DIV:
+	case TACOp::MOD:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	case TACOp::IF:
+	case TACOp::RETURN:
+		add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		add_if_local(uses, instruction, &TACInstruction::arg2, gst);
+		break;
+	case TACOp::CONVERT_TYPE:
+	case TACOp::DEREF:
+	case TACOp::ADDR_OF:
+	case TACOp::PUSH:
+	case TACOp::VEC_SPLAT:
+		add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		break;
+	case TACOp::VEC_LOAD:
+	case TACOp::VEC_STORE:
+		// Like ASSIGN, storing into some of the array means the rest of it is read
+		add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		add_if_local(uses, instruction, &TACInstruction::arg2, gst);
+		break;
+	case TACOp::ASSIGN:
+	{
+		/*
+			ASSIGN dst, index -> src
+			Storing into an element of an array/struct only partially writes it
+			Hence the aggregate itself is also read
+		*/
+		add_if_local(uses, instruction, &TACInstruction::result, gst);
+		add_if_local(uses, instruction, &TACInstruction::arg2, gst);
+
+		Symbol *dst = gst->get_symbol(instruction.arg1);
+		if (dst && is_aggregate(dst->type))
+			add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		break;
+	}
+	case TACOp::ASSIGN_DEREF:
+		add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		add_if_local(uses, instruction, &TACInstruction::arg2, gst);
+		add_if_local(uses, instruction, &TACInstruction::result, gst);
+		break;
+	case TACOp::MOV_BETWEEN_REG:
+		if (instruction.result == "load")
+			add_if_local(uses, instruction, &TACInstruction::arg1, gst);
+		break;
+	default:
+		break;
+	}
+
+	return uses;
+}
+
+std::vector<TACField> get_tac_def_fields(const TACInstruction &instruction, GlobalSymbolTable *gst)
+{
+	std::vector<TACField> defs;
+
+	switch (instruction.op)
+	{
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::DIV:
+	case TACOp::MOD:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	case TACOp::CONVERT_TYPE:
+	case TACOp::DEREF:
+	case TACOp::ADDR_OF:
+	case TACOp::PHI:
+		add_if_local(defs, instruction, &TACInstruction::result, gst);
+		break;
+	case TACOp::ASSIGN:
+	{
+		Symbol *dst = gst->get_symbol(instruction.arg1);
+		if (dst && !is_aggregate(dst->type))
+			add_if_local(defs, instruction, &TACInstruction::arg1, gst);
+		break;
+	}
+	case TACOp::MOV_BETWEEN_REG:
+		if (instruction.result == "store")
+			add_if_local(defs, instruction, &TACInstruction::arg1, gst);
+		break;
+	default:
+		break;
+	}
+
+	return defs;
+}
+
+std::vector<std::string> get_tac_uses(const TACInstruction &instruction, GlobalSymbolTable *gst)
+{
+	std::vector<std::string> uses;
+
+	// Phi operands live outside of the usual fields
+	if (instruction.op == TACOp::PHI)
+	{
+		for (auto &[pred, value] : instruction.phi_args)
+			if (is_local_symbol(gst->get_symbol(value)))
+				uses.push_back(value);
+		return uses;
+	}
+
+	for (TACField field : get_tac_use_fields(instruction, gst))
+		uses.push_back(instruction.*field);
+
+	return uses;
+}
+
+std::vector<std::string> get_tac_defs(const TACInstruction &instruction, GlobalSymbolTable *gst)
+{
+	std::vector<std::string> defs;
+
+	for (TACField field : get_tac_def_fields(instruction, gst))
+		defs.push_back(instruction.*field);
+
+	return defs;
+}
+
+bool is_aggregate(const Type &type)
+{
+	return type.is_array() || (type.is_struct() && !type.is_pointer());
+}
+
+std::vector<std::pair<size_t, size_t>> find_func_ranges(const std::vector<TACInstruction> &instructions)
+{
+	std::vector<std::pair<size_t, size_t>> ranges;
+
+	size_t begin = 0;
+	for (size_t i = 0; i < instructions.size(); i++)
+	{
+		if (instructions[i].op == TACOp::FUNC_BEGIN)
+			begin = i;
+		else if (instructions[i].op == TACOp::FUNC_END)
+			ranges.emplace_back(begin, i);
+	}
+
+	return ranges;
+}
+
+Liveness::Liveness(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+int Liveness::intern_var(const std::string &name)
+{
+	auto it = var_ids.find(name);
+	if (it != var_ids.end())
+		return it->second;
+
+	int id = vars.size();
+	vars.push_back(name);
+	var_ids[name] = id;
+	return id;
+}
+
+int Liveness::get_var_id(const std::string &name) const
+{
+	auto it = var_ids.find(name);
+	return it != var_ids.end() ? it->second : -1;
+}
+
+void Liveness::analyse(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	this->begin = begin;
+	size_t count = end - begin + 1;
+
+	vars.clear();
+	var_ids.clear();
+	uses.assign(count, {});
+	defs.assign(count, {});
+	successors.assign(count, {});
+
+	std::unordered_map<std::string, size_t> labels;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const TACInstruction &instruction = instructions[begin + i];
+
+		for (auto &name : get_tac_uses(instruction, gst.get()))
+			uses[i].push_back(intern_var(name));
+		for (auto &name : get_tac_defs(instruction, gst.get()))
+			defs[i].push_back(intern_var(name));
+
+		if (instruction.op == TACOp::LABEL)
+			labels[instruction.arg1] = i;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const TACInstruction &instruction = instructions[begin + i];
+
+		switch (instruction.op)
+		{
+		case TACOp::GOTO:
+		case TACOp::IF:
+		{
+			auto it = labels.find(instruction.result);
+			successors[i].push_back(it != labels.end() ? it->second : count - 1);
+
+			if (instruction.op == TACOp::IF)
+				successors[i].push_back(i + 1);
+			break;
+		}
+		case TACOp::RETURN:
+			successors[i].push_back(count - 1);
+			break;
+		case TACOp::FUNC_END:
+			break;
+		default:
+			successors[i].push_back(i + 1);
+			break;
+		}
+	}
+
+	live_in.assign(count, std::vector<bool>(vars.size(), false));
+	live_out.assign(count, std::vector<bool>(vars.size(), false));
+
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (size_t n = count; n-- > 0;)
+		{
+			std::vector<bool> out(vars.size(), false);
+			for (size_t succ : successors[n])
+				for (size_t v = 0; v < vars.size(); v++)
+					if (live_in[succ][v])
+						out[v] = true;
+
+			std::vector<bool> in = out;
+			for (int v : defs[n])
+				in[v] = false;
+			for (int v : uses[n])
+				in[v] = true;
+
+			if (in != live_in[n] || out != live_out[n])
+			{
+				live_in[n] = std::move(in);
+				live_out[n] = std::move(out);
+				changed = true;
+			}
+		}
+	}
+}
+
+bool Liveness::is_live_in(size_t index, const std::string &name) const
+{
+	int id = get_var_id(name);
+	return id >= 0 && live_in[index - begin][id];
+}
+
+bool Liveness::is_live_out(size_t index, const std::string &name) const
+{
+	int id = get_var_id(name);
+	return id >= 0 && live_out[index - begin][id];
+}
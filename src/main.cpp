@@ -3,25 +3,90 @@
 #include <string>
 #include <sstream>
 #include <memory>
+#include <vector>
+#include <cctype>
 
 #include "../include/module.h"
 #include "../include/globalSymbolTable.h"
 
+// The value of a size threshold option (i.e. the 32 in -finline-limit=32) which has to be a non-negative integer
+static bool parse_limit(const std::string &value, int &limit)
+{
+    // Any more digits could overflow an int
+    if (value.empty() || value.size() > 9)
+        return false;
+
+    for (char c : value)
+        if (!std::isdigit(static_cast<unsigned char>(c)))
+            return false;
+
+    limit = std::stoi(value);
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     std::shared_ptr<GlobalSymbolTable> gst = std::make_shared<GlobalSymbolTable>();
 
     std::unordered_map<std::string, int> modules;
+    std::vector<std::string> paths;
+
+    CompilerOptions options;
 
     for (int i = 1; i < argc; ++i)
     {
-        if (modules.find(argv[i]) != modules.end())
+        std::string arg = argv[i];
+
+        // Optimisation level (i.e. -O0, -O1, -O2)
+        if (arg.size() == 3 && arg.rfind("-O", 0) == 0 && std::isdigit(arg[2]))
+        {
+            options.opt_level = arg[2] - '0';
+            continue;
+        }
+
+        // Size threshold for inlining (i.e. -finline-limit=32)
+        if (arg.rfind("-finline-limit=", 0) == 0)
+        {
+            if (!parse_limit(arg.substr(15), options.inline_threshold))
+            {
+                std::cerr << "Compiler Error: -finline-limit= expects a non-negative integer but found '"
+                          << arg.substr(15) << "'" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+
+        // Size threshold for unrolling (i.e. -funroll-limit=128)
+        if (arg.rfind("-funroll-limit=", 0) == 0)
+        {
+            if (!parse_limit(arg.substr(15), options.unroll_threshold))
+            {
+                std::cerr << "Compiler Error: -funroll-limit= expects a non-negative integer but found '"
+                          << arg.substr(15) << "'" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+
+        // Use AVX2 for vectorised loops
+        if (arg == "-mavx2")
+        {
+            options.avx2 = true;
+            continue;
+        }
+
+        paths.push_back(arg);
+    }
+
+    for (auto &path : paths)
+    {
+        if (modules.find(path) != modules.end())
         {
-            std::cerr << "Compiler Error: Duplicate module name: " << argv[i] << std::endl;
+            std::cerr << "Compiler Error: Duplicate module name: " << path << std::endl;
             return 1;
         }
 
-        Module module(argv[i], gst);
+        Module module(path, gst, options);
         module.compile();
     }
 
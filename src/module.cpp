@@ -1,18 +1,20 @@
-#include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
 
+#include "../include/addressFolding.h"
 #include "../include/assembler.h"
 #include "../include/ast.h"
+#include "../include/frameLayout.h"
 #include "../include/lexer.h"
 #include "../include/module.h"
+#include "../include/optimiser.h"
 #include "../include/parser.h"
+#include "../include/registerAllocator.h"
 #include "../include/semanticAnalyser.h"
 #include "../include/tacGenerator.h"
 
-Module::Module(const std::string &path, std::shared_ptr<GlobalSymbolTable> gst)
-    : gst(gst)
+Module::Module(const std::string &path, std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options)
+    : gst(gst), options(options)
 {
   auto get_filename = [](const std::string &filepath) -> std::string
   {
@@ -33,19 +35,9 @@ Module::Module(const std::string &path, std::shared_ptr<GlobalSymbolTable> gst)
 
 void Module::check_file()
 {
-  std::ifstream code_file(filepath, std::ios::in);
+  source.open(filepath);
 
-  if (!code_file)
-    throw std::runtime_error("File Error: Error opening file: " + filepath);
-
-  std::stringstream buffer;
-  buffer << code_file.rdbuf();
-
-  file_contents = buffer.str();
-
-  code_file.close();
-
-  if (file_contents.empty())
+  if (source.get_contents().empty())
     throw std::runtime_error("File Error: File is empty: " + filepath);
 }
 
@@ -53,14 +45,17 @@ void Module::compile()
 {
   gst->current_module = name;
 
-  Lexer lexer(file_contents);
+  // Owns the module's AST, all of which is released in one go once the module has been compiled
+  ASTArena arena;
 
-  Parser parser(lexer, name);
+  Lexer lexer(source.get_contents());
 
-  std::shared_ptr<ProgramNode> program = parser.parse();
+  Parser parser(lexer, name, arena);
+
+  ProgramNode *program = parser.parse();
 
   std::shared_ptr<SemanticAnalyser> sem_analyser =
-      std::make_shared<SemanticAnalyser>(gst, name);
+      std::make_shared<SemanticAnalyser>(gst, name, arena);
   sem_analyser->analyse(program);
 
 #ifdef DEBUG
@@ -83,6 +78,26 @@ void Module::compile()
 
   tacGenerator.print_all_tac();
 
-  Assembler assembler(gst, name + ".s");
+  if (options.opt_level > 0)
+  {
+    Optimiser optimiser(gst, options);
+    optimiser.optimise(instructions);
+
+    AddressFolding address_folding(gst);
+    address_folding.run(instructions);
+
+#ifdef DEBUG
+    tacGenerator.print_all_tac();
+#endif
+
+    RegisterAllocator register_allocator(gst, options.opt_level >= 2 ? AllocStrategy::GRAPH_COLOURING
+                                                                     : AllocStrategy::LINEAR_SCAN);
+    register_allocator.allocate(instructions);
+
+    FrameLayout frame_layout(gst);
+    frame_layout.layout(instructions);
+  }
+
+  Assembler assembler(gst, name + ".s", options);
   assembler.assemble(instructions);
 }
\ No newline at end of file
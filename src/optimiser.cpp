@@ -0,0 +1,113 @@
+#include "../include/optimiser.h"
+
+#include "../include/dce.h"
+#include "../include/gvn.h"
+#include "../include/inliner.h"
+#include "../include/licm.h"
+#include "../include/liveness.h"
+#include "../include/sccp.h"
+#include "../include/strengthReduction.h"
+#include "../include/tailRecursion.h"
+#include "../include/unroller.h"
+#include "../include/vectoriser.h"
+
+Optimiser::Optimiser(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options)
+	: gst(gst), options(options) {}
+
+void Optimiser::optimise(std::vector<TACInstruction> &instructions)
+{
+	find_const_globals(instructions);
+
+	Inliner inliner(gst, options);
+	inliner.run(instructions);
+
+	// Before SSA so the loops still look the way they were generated
+	LoopVectoriser vectoriser(gst, options);
+	vectoriser.run(instructions);
+
+	LoopUnroller unroller(gst, options);
+	unroller.run(instructions);
+
+	auto ranges = find_func_ranges(instructions);
+
+	// Work backwards so replacing a function doesn't move the ones still to be done
+	for (auto it = ranges.rbegin(); it != ranges.rend(); it++)
+	{
+		auto [begin, end] = *it;
+
+		gst->enter_func_scope(instructions[begin].arg1);
+
+		ControlFlowGraph cfg(gst);
+		cfg.build(instructions, begin, end);
+
+		// Done first so the loops it makes are optimised like any other
+		TailRecursionElimination tail_recursion(gst);
+		tail_recursion.run(cfg);
+
+		SSA ssa(gst);
+		ssa.construct(cfg);
+		optimise_func(cfg, ssa);
+		ssa.destruct(cfg);
+
+		std::vector<TACInstruction> optimised = cfg.flatten();
+		instructions.erase(instructions.begin() + begin, instructions.begin() + end + 1);
+		instructions.insert(instructions.begin() + begin, optimised.begin(), optimised.end());
+
+		gst->leave_func_scope();
+	}
+}
+
+void Optimiser::find_const_globals(const std::vector<TACInstruction> &instructions)
+{
+	const_globals.clear();
+
+	bool in_data = false;
+	for (auto &instruction : instructions)
+	{
+		switch (instruction.op)
+		{
+		case TACOp::ENTER_DATA:
+			in_data = true;
+			break;
+		case TACOp::ENTER_BSS:
+		case TACOp::ENTER_TEXT:
+		case TACOp::ENTER_STR:
+		case TACOp::ENTER_LITERAL8:
+			in_data = false;
+			break;
+		case TACOp::ASSIGN:
+		{
+			if (!in_data || !instruction.arg2.empty())
+				break;
+
+			Symbol *symbol = gst->get_symbol(instruction.arg1);
+			long long value;
+
+			if (symbol && symbol->is_global && symbol->is_const() && symbol->type.is_integral() &&
+				!symbol->type.is_pointer() && !symbol->type.is_array() && parse_int_literal(instruction.result, value))
+				const_globals[instruction.arg1] = normalise_int(value, symbol->type);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+void Optimiser::optimise_func(ControlFlowGraph &cfg, SSA &ssa)
+{
+	SCCP sccp(gst, const_globals);
+	sccp.run(cfg, ssa);
+
+	GlobalValueNumbering gvn(gst);
+	gvn.run(cfg, ssa);
+
+	LoopInvariantCodeMotion licm(gst);
+	licm.run(cfg, ssa);
+
+	StrengthReduction strength_reduction(gst);
+	strength_reduction.run(cfg, ssa);
+
+	DeadCodeElimination dce(gst);
+	dce.run(cfg, ssa);
+}
@@ -22,10 +22,8 @@ std::unordered_map<BinOpType, int> precedence_map = {
     {BinOpType::MOD, 40},
 };
 
-Parser::Parser(Lexer &l, std::string source_file)
-    : lexer(l), current_token(TOKEN_EOF, "", 1, 0), source_file(source_file) {
-  advance();
-}
+Parser::Parser(Lexer &l, std::string source_file, ASTArena &arena)
+    : lexer(l), tokens(l.tokenise()), arena(arena), current_token(tokens.front()), source_file(source_file) {}
 
 bool Parser::match(const TokenType &type) { return current_token.type == type; }
 
@@ -34,15 +32,21 @@ bool Parser::match(const std::vector<TokenType> &tokens) {
          tokens.end();
 }
 
-void Parser::advance() { current_token = lexer.get_next_token(); }
+// Past the end it stays on the TOKEN_EOF
+void Parser::advance() {
+  if (position + 1 < tokens.size())
+    position++;
+  current_token = tokens[position];
+}
 
 void Parser::retreat(int iterations) {
-  current_token = lexer.rewind(iterations);
+  position = (size_t)iterations < position ? position - iterations : 0;
+  current_token = tokens[position];
 }
 
 void Parser::error(const std::string &message) {
   throw std::runtime_error("Parser Error: " + message + " but found '" +
-                           current_token.text + "' on line " +
+                           std::string(current_token.text) + "' on line " +
                            std::to_string(current_token.line) + " in module '" +
                            source_file + "'");
 }
@@ -72,8 +76,8 @@ void Parser::advance_and_expect(const TokenType &token_type) {
   expect(token_type);
 }
 
-std::shared_ptr<ProgramNode> Parser::parse() {
-  std::shared_ptr<ProgramNode> program = std::make_shared<ProgramNode>();
+ProgramNode *Parser::parse() {
+  ProgramNode *program = arena.create<ProgramNode>();
 
   while (current_token.type != TOKEN_EOF) {
     if (match(TOKEN_FN))
@@ -123,15 +127,15 @@ std::shared_ptr<ProgramNode> Parser::parse() {
   return program;
 }
 
-std::unique_ptr<ASTNode> Parser::parse_struct_decl() {
+ASTNode *Parser::parse_struct_decl() {
   expect_and_advance(TOKEN_STRUCT);
 
-  std::string struct_name = current_token.text;
+  std::string struct_name(current_token.text);
   expect_and_advance(TOKEN_IDENTIFIER);
 
   advance();
 
-  std::vector<std::unique_ptr<ASTNode>> members;
+  std::vector<ASTNode *> members;
 
   while (!match(TOKEN_RBRACE)) {
     members.emplace_back(parse_var_decl(std::nullopt));
@@ -142,12 +146,12 @@ std::unique_ptr<ASTNode> Parser::parse_struct_decl() {
 
   expect(TOKEN_SEMICOLON);
 
-  return std::make_unique<StructDeclNode>(
+  return arena.create<StructDeclNode>(
       struct_name, std::move(members),
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<FuncNode> Parser::parse_func_decl(
+FuncNode *Parser::parse_func_decl(
     const std::optional<std::vector<TokenType>> specifiers) {
   expect_and_advance(TOKEN_FN);
 
@@ -159,8 +163,8 @@ std::unique_ptr<FuncNode> Parser::parse_func_decl(
   else
     specs = {};
 
-  std::unique_ptr<FuncNode> func =
-      std::make_unique<FuncNode>(current_token.text, specs);
+  FuncNode *func =
+      arena.create<FuncNode>(std::string(current_token.text), specs);
 
   advance();
 
@@ -174,23 +178,23 @@ std::unique_ptr<FuncNode> Parser::parse_func_decl(
 
   func->return_type = parse_type();
 
-  std::vector<std::unique_ptr<ASTNode>> elements = parse_block();
+  std::vector<ASTNode *> elements = parse_block();
 
   for (auto &element : elements)
-    func->elements.push_back(std::move(element));
+    func->elements.push_back(element);
 
   return func;
 }
 
-void Parser::parse_param_list(std::unique_ptr<FuncNode> &func) {
+void Parser::parse_param_list(FuncNode *func) {
   if (match(TOKEN_RPAREN))
     return;
 
   while (!match(TOKEN_RPAREN)) {
-    std::unique_ptr<VarNode> var = parse_var_declarator(std::nullopt);
+    VarNode *var = parse_var_declarator(std::nullopt);
 
-    func->params.emplace_back(std::make_unique<VarDeclNode>(
-        std::move(var), nullptr,
+    func->params.emplace_back(arena.create<VarDeclNode>(
+        var, nullptr,
         SourceLocation{current_token.line, current_token.index}));
 
     if (!match(TOKEN_RPAREN))
@@ -198,10 +202,10 @@ void Parser::parse_param_list(std::unique_ptr<FuncNode> &func) {
   }
 }
 
-std::vector<std::unique_ptr<ASTNode>> Parser::parse_block() {
+std::vector<ASTNode *> Parser::parse_block() {
   expect_and_advance(TOKEN_LBRACE);
 
-  std::vector<std::unique_ptr<ASTNode>> elements = {};
+  std::vector<ASTNode *> elements = {};
 
   while (current_token.type != TOKEN_RBRACE) {
     if (match(TOKEN_RTN))
@@ -266,31 +270,31 @@ std::vector<std::unique_ptr<ASTNode>> Parser::parse_block() {
   return elements;
 }
 
-std::unique_ptr<RtnNode> Parser::parse_rtn() {
+RtnNode *Parser::parse_rtn() {
   advance();
 
   if (match(TOKEN_SEMICOLON))
-    return std::make_unique<RtnNode>(
+    return arena.create<RtnNode>(
         nullptr, SourceLocation{current_token.line, current_token.index});
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
+  ASTNode *expr = parse_expr();
 
   expect(TOKEN_SEMICOLON);
 
-  return std::make_unique<RtnNode>(
-      std::move(expr), SourceLocation{current_token.line, current_token.index});
+  return arena.create<RtnNode>(
+      expr, SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<IfNode> Parser::parse_if_stmt() {
+IfNode *Parser::parse_if_stmt() {
   advance();
   expect_and_advance(TOKEN_LPAREN);
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
+  ASTNode *expr = parse_expr();
 
   expect_and_advance(TOKEN_RPAREN);
 
-  std::vector<std::unique_ptr<ASTNode>> then_elements = parse_block();
-  std::vector<std::unique_ptr<ASTNode>> else_elements;
+  std::vector<ASTNode *> then_elements = parse_block();
+  std::vector<ASTNode *> else_elements;
 
   advance();
 
@@ -300,55 +304,53 @@ std::unique_ptr<IfNode> Parser::parse_if_stmt() {
   } else
     retreat();
 
-  return std::make_unique<IfNode>(
-      std::move(expr), std::move(then_elements), std::move(else_elements),
+  return arena.create<IfNode>(
+      expr, std::move(then_elements), std::move(else_elements),
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<WhileNode> Parser::parse_while_stmt() {
+WhileNode *Parser::parse_while_stmt() {
   advance();
 
   expect_and_advance(TOKEN_LPAREN);
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
+  ASTNode *expr = parse_expr();
 
   expect_and_advance(TOKEN_RPAREN);
 
-  std::vector<std::unique_ptr<ASTNode>> elements = parse_block();
+  std::vector<ASTNode *> elements = parse_block();
 
-  return std::make_unique<WhileNode>(
-      std::move(expr), std::move(elements),
+  return arena.create<WhileNode>(
+      expr, std::move(elements),
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<ForNode> Parser::parse_for_stmt() {
+ForNode *Parser::parse_for_stmt() {
   advance();
 
   expect_and_advance(TOKEN_LPAREN);
 
-  std::unique_ptr<ASTNode> init = parse_for_init();
+  ASTNode *init = parse_for_init();
 
   advance();
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
-  std::unique_ptr<BinaryNode> condition =
-      std::unique_ptr<BinaryNode>(dynamic_cast<BinaryNode *>(expr.release()));
+  ASTNode *condition = parse_expr();
 
   expect_and_advance(TOKEN_SEMICOLON);
 
-  std::unique_ptr<ASTNode> post = parse_expr();
+  ASTNode *post = parse_expr();
 
   expect_and_advance(TOKEN_RPAREN);
 
-  std::vector<std::unique_ptr<ASTNode>> elements = parse_block();
+  std::vector<ASTNode *> elements = parse_block();
 
-  return std::make_unique<ForNode>(
-      std::move(init), std::move(condition), std::move(post),
+  return arena.create<ForNode>(
+      init, condition, post,
       std::move(elements),
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<ASTNode> Parser::parse_for_init() {
+ASTNode *Parser::parse_for_init() {
   if (match(addressable_types))
     return parse_var_decl(std::nullopt);
   else if (match(TOKEN_IDENTIFIER))
@@ -357,22 +359,22 @@ std::unique_ptr<ASTNode> Parser::parse_for_init() {
     error("Parser Error: Expected valid for init");
 }
 
-std::unique_ptr<ASTNode> Parser::parse_loop_control() {
+ASTNode *Parser::parse_loop_control() {
   TokenType token_type = current_token.type;
 
   advance_and_expect(TOKEN_SEMICOLON);
 
-  return std::make_unique<LoopControl>(
+  return arena.create<LoopControl>(
       token_type, "", SourceLocation{current_token.line, current_token.index});
 }
 
 // Parses name, type, array dims, etc for declaration
-std::unique_ptr<VarNode> Parser::parse_var_declarator(
+VarNode *Parser::parse_var_declarator(
     const std::optional<std::vector<TokenType>> specifiers) {
   Type var_type = parse_type();
 
   expect(TOKEN_IDENTIFIER);
-  std::string var_name = current_token.text;
+  std::string var_name(current_token.text);
   advance();
 
   while (match(TOKEN_LSBRACE)) {
@@ -388,8 +390,8 @@ std::unique_ptr<VarNode> Parser::parse_var_declarator(
       break;
     }
 
-    std::unique_ptr<ASTNode> size_expr = parse_expr();
-    if (auto num = dynamic_cast<IntegerLiteral *>(size_expr.get()))
+    ASTNode *size_expr = parse_expr();
+    if (auto num = dynamic_cast<IntegerLiteral *>(size_expr))
       var_type.add_array_dimension(num->value);
     else
       error("Array size must be a constant integer");
@@ -402,16 +404,16 @@ std::unique_ptr<VarNode> Parser::parse_var_declarator(
   else
     specs = {};
 
-  return std::make_unique<VarNode>(
+  return arena.create<VarNode>(
       var_name, var_type, specs,
       SourceLocation{current_token.line, current_token.index});
 }
 
 // Uses method above to capture type of variable
 // Specifier is static/extern
-std::unique_ptr<VarDeclNode>
+VarDeclNode *
 Parser::parse_var_decl(const std::optional<std::vector<TokenType>> specifiers) {
-  std::unique_ptr<VarNode> var = parse_var_declarator(specifiers);
+  VarNode *var = parse_var_declarator(specifiers);
   Type var_type = var->type;
   std::vector<TokenType> excepted_tokens =
       std::vector<TokenType>{TOKEN_ASSIGN, TOKEN_SEMICOLON};
@@ -419,7 +421,7 @@ Parser::parse_var_decl(const std::optional<std::vector<TokenType>> specifiers) {
 
   if (match(TOKEN_ASSIGN)) {
     advance();
-    std::unique_ptr<ASTNode> init_expr;
+    ASTNode *init_expr = nullptr;
 
     if ((match(TOKEN_LBRACE) && var_type.is_array()) ||
         (match(TOKEN_LBRACE) && var_type.is_struct()))
@@ -428,13 +430,13 @@ Parser::parse_var_decl(const std::optional<std::vector<TokenType>> specifiers) {
       init_expr = parse_expr();
 
     expect(TOKEN_SEMICOLON);
-    return std::make_unique<VarDeclNode>(
-        std::move(var), std::move(init_expr),
+    return arena.create<VarDeclNode>(
+        var, init_expr,
         SourceLocation{current_token.line, current_token.index});
   }
 
-  return std::make_unique<VarDeclNode>(
-      std::move(var), nullptr,
+  return arena.create<VarDeclNode>(
+      var, nullptr,
       SourceLocation{current_token.line, current_token.index});
 }
 
@@ -465,7 +467,7 @@ Type Parser::determine_type(const std::vector<TokenType> &types) {
   }
 
   if (is_struct) {
-    std::string struct_name = current_token.text;
+    std::string struct_name(current_token.text);
     advance();
 
     /*
@@ -498,7 +500,7 @@ Type Parser::determine_type(const std::vector<TokenType> &types) {
       base_type = BaseType::CHAR;
       break;
     case TOKEN_IDENTIFIER:
-      return Type(current_token.text, ptr_level);
+      return Type(std::string(current_token.text), ptr_level);
     case TOKEN_BOOL:
       base_type = BaseType::BOOL;
       break;
@@ -513,70 +515,70 @@ Type Parser::determine_type(const std::vector<TokenType> &types) {
   return Type(base_type, ptr_level);
 }
 
-std::unique_ptr<VarAssignNode> Parser::parse_var_assign() {
+VarAssignNode *Parser::parse_var_assign() {
   if (match(TOKEN_STAR)) {
     advance_and_expect(TOKEN_IDENTIFIER);
 
-    std::unique_ptr<VarNode> var = std::make_unique<VarNode>(
-        current_token.text,
+    VarNode *var = arena.create<VarNode>(
+        std::string(current_token.text),
         SourceLocation{current_token.line, current_token.index});
-    std::unique_ptr<UnaryNode> deref = std::make_unique<UnaryNode>(
-        get_unary_op_type(TOKEN_STAR), std::move(var),
+    UnaryNode *deref = arena.create<UnaryNode>(
+        get_unary_op_type(TOKEN_STAR), var,
         SourceLocation{current_token.line, current_token.index});
 
     advance_and_expect(TOKEN_ASSIGN);
 
     advance();
 
-    std::unique_ptr<ASTNode> expr = parse_expr();
+    ASTNode *expr = parse_expr();
     expect(TOKEN_SEMICOLON);
-    return std::make_unique<VarAssignNode>(
-        std::move(deref), std::move(expr),
+    return arena.create<VarAssignNode>(
+        deref, expr,
         SourceLocation{current_token.line, current_token.index});
   }
 
-  std::unique_ptr<ASTNode> target = parse_lvalue();
+  ASTNode *target = parse_lvalue();
   TokenType assign_type = current_token.type;
 
   expect_and_advance(assign_tokens);
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
+  ASTNode *expr = parse_expr();
 
   if (assign_type == TOKEN_ASSIGN) {
-    return std::make_unique<VarAssignNode>(
-        std::move(target), std::move(expr),
+    return arena.create<VarAssignNode>(
+        target, expr,
         SourceLocation{current_token.line, current_token.index});
   } else {
     auto bin_op_type = get_bin_op_type(assign_type);
 
-    std::unique_ptr<ASTNode> target_clone;
-    if (auto var_node = dynamic_cast<VarNode *>(target.get()))
-      target_clone = std::make_unique<VarNode>(*var_node);
-    else if (auto array_access = dynamic_cast<ArrayAccessNode *>(target.get()))
-      target_clone = std::make_unique<ArrayAccessNode>(
-          *array_access,
+    ASTNode *target_clone = nullptr;
+    if (auto var_node = dynamic_cast<VarNode *>(target))
+      target_clone = arena.create<VarNode>(*var_node);
+    else if (auto array_access = dynamic_cast<ArrayAccessNode *>(target))
+      target_clone = arena.create<ArrayAccessNode>(
+          *array_access, arena,
           SourceLocation{current_token.line, current_token.index});
 
-    auto right = std::make_unique<BinaryNode>(
-        bin_op_type, std::move(target_clone), std::move(expr),
+    auto right = arena.create<BinaryNode>(
+        bin_op_type, target_clone, expr,
         SourceLocation{current_token.line, current_token.index});
-    return std::make_unique<VarAssignNode>(
-        std::move(target), std::move(right),
+    return arena.create<VarAssignNode>(
+        target, right,
         SourceLocation{current_token.line, current_token.index});
   }
 }
 
-std::unique_ptr<ASTNode> Parser::parse_expr(int min_presedence) {
-  std::unique_ptr<ASTNode> left = parse_factor();
+ASTNode *Parser::parse_expr(int min_presedence) {
+  ASTNode *left = parse_factor();
 
   advance();
 
   if (match(TOKEN_INCREMENT) || match(TOKEN_DECREMENT)) {
-    if (dynamic_cast<VarNode *>(left.get()) == nullptr)
+    if (dynamic_cast<VarNode *>(left) == nullptr)
       error("Postfix operator requires a variable");
 
-    left = std::make_unique<PostfixNode>(
-        current_token.type, std::move(left),
+    left = arena.create<PostfixNode>(
+        current_token.type, left,
         SourceLocation{current_token.line, current_token.index});
 
     advance();
@@ -588,40 +590,40 @@ std::unique_ptr<ASTNode> Parser::parse_expr(int min_presedence) {
 
     advance();
 
-    std::unique_ptr<ASTNode> right = parse_expr(get_precedence(op) + 1);
+    ASTNode *right = parse_expr(get_precedence(op) + 1);
 
-    left = std::make_unique<BinaryNode>(
-        get_bin_op_type(op), std::move(left), std::move(right),
+    left = arena.create<BinaryNode>(
+        get_bin_op_type(op), left, right,
         SourceLocation{current_token.line, current_token.index});
   }
 
   return left;
 }
 
-std::unique_ptr<ASTNode> Parser::parse_factor() {
+ASTNode *Parser::parse_factor() {
   if (match(TOKEN_NUMBER)) {
     return parse_number_literal();
   } else if (match(TOKEN_FPN)) {
     try {
-      return std::make_unique<DoubleLiteral>(
-          std::stod(current_token.text),
+      return arena.create<DoubleLiteral>(
+          std::stod(std::string(current_token.text)),
           SourceLocation{current_token.line, current_token.index});
     } catch (const std::exception &e) {
       error("Number out of range");
     }
   } else if (match(TOKEN_TRUE) || match(TOKEN_FALSE)) {
-    return std::make_unique<BoolLiteral>(
+    return arena.create<BoolLiteral>(
         current_token.type == TOKEN_TRUE,
         SourceLocation{current_token.line, current_token.index});
   } else if (match(TOKEN_CHAR)) {
-    return std::make_unique<CharLiteral>(
+    return arena.create<CharLiteral>(
         current_token.text[0], Type(BaseType::CHAR),
         SourceLocation{current_token.line, current_token.index});
   } else if (match(TOKEN_STRING)) {
     Type string_type(BaseType::CHAR);
     string_type.add_array_dimension(current_token.text.length());
-    return std::make_unique<StringLiteral>(
-        current_token.text, string_type,
+    return arena.create<StringLiteral>(
+        std::string(current_token.text), string_type,
         SourceLocation{current_token.line, current_token.index});
   } else if (match(un_op_tokens)) {
     return parse_unary_operation();
@@ -642,12 +644,12 @@ std::unique_ptr<ASTNode> Parser::parse_factor() {
 
     return expr;
   } else if (match(TOKEN_IDENTIFIER)) {
-    std::string identifier = current_token.text;
+    std::string identifier(current_token.text);
 
-    std::unique_ptr<ASTNode> potential_var = parse_lvalue();
+    ASTNode *potential_var = parse_lvalue();
 
     if (match(TOKEN_LPAREN)) {
-      std::unique_ptr<FuncCallNode> func_call = std::make_unique<FuncCallNode>(
+      FuncCallNode *func_call = arena.create<FuncCallNode>(
           identifier, SourceLocation{current_token.line, current_token.index});
       parse_args_list(func_call);
       expect(TOKEN_RPAREN);
@@ -663,14 +665,14 @@ std::unique_ptr<ASTNode> Parser::parse_factor() {
   } else if (match(TOKEN_SIZEOF))
     return parse_sizeof();
   else if (match(TOKEN_NULL)) {
-    return std::make_unique<NullLiteral>(
+    return arena.create<NullLiteral>(
         SourceLocation{current_token.line, current_token.index});
   } else
     error("Expected expression");
 }
 
-std::unique_ptr<ASTNode> Parser::parse_number_literal() {
-  std::string num_text = current_token.text;
+ASTNode *Parser::parse_number_literal() {
+  std::string num_text(current_token.text);
   try {
     // Check for suffixes first
     bool is_unsigned = (num_text.find('u') != std::string::npos ||
@@ -687,25 +689,25 @@ std::unique_ptr<ASTNode> Parser::parse_number_literal() {
                    num_text.end());
 
     if (is_unsigned && is_long)
-      return std::make_unique<ULongLiteral>(
+      return arena.create<ULongLiteral>(
           std::stoull(num_text),
           SourceLocation{current_token.line, current_token.index});
     else if (is_unsigned)
-      return std::make_unique<UIntegerLiteral>(
+      return arena.create<UIntegerLiteral>(
           std::stoul(num_text),
           SourceLocation{current_token.line, current_token.index});
     else if (is_long)
-      return std::make_unique<LongLiteral>(
+      return arena.create<LongLiteral>(
           std::stoll(num_text),
           SourceLocation{current_token.line, current_token.index});
 
     // Attempt to fit in smallest type possible
     try {
-      return std::make_unique<IntegerLiteral>(
+      return arena.create<IntegerLiteral>(
           std::stoi(num_text),
           SourceLocation{current_token.line, current_token.index});
     } catch (const std::out_of_range &) {
-      return std::make_unique<LongLiteral>(
+      return arena.create<LongLiteral>(
           std::stoll(num_text),
           SourceLocation{current_token.line, current_token.index});
     }
@@ -716,22 +718,22 @@ std::unique_ptr<ASTNode> Parser::parse_number_literal() {
   return nullptr; // Unreachable but silences compiler warnings
 }
 
-std::unique_ptr<ASTNode> Parser::parse_unary_operation() {
+ASTNode *Parser::parse_unary_operation() {
   auto op = current_token.type;
   advance();
 
   auto expr = parse_factor();
 
-  return std::make_unique<UnaryNode>(
-      get_unary_op_type(op), std::move(expr),
+  return arena.create<UnaryNode>(
+      get_unary_op_type(op), expr,
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<AggregateLiteral>
+AggregateLiteral *
 Parser::parse_aggregate_literal(const Type &array_type) {
   expect_and_advance(TOKEN_LBRACE);
 
-  auto init_node = std::make_unique<AggregateLiteral>(
+  auto init_node = arena.create<AggregateLiteral>(
       array_type, SourceLocation{current_token.line, current_token.index});
 
   if (!match(TOKEN_RBRACE)) {
@@ -751,20 +753,20 @@ Parser::parse_aggregate_literal(const Type &array_type) {
   return init_node;
 }
 
-void Parser::parse_args_list(std::unique_ptr<FuncCallNode> &func_call) {
+void Parser::parse_args_list(FuncCallNode *func_call) {
   advance();
 
   if (match(TOKEN_RPAREN))
     return;
 
-  std::unique_ptr<ASTNode> expr = parse_expr();
+  ASTNode *expr = parse_expr();
 
-  func_call->args.push_back(std::move(expr));
+  func_call->args.push_back(expr);
 
   while (match(TOKEN_COMMA)) {
     advance();
     expr = parse_expr();
-    func_call->args.push_back(std::move(expr));
+    func_call->args.push_back(expr);
   }
 }
 
@@ -772,10 +774,10 @@ int Parser::get_precedence(const TokenType &op) {
   return precedence_map.at(get_bin_op_type(op));
 }
 
-std::unique_ptr<ASTNode> Parser::parse_lvalue(const Specifier &specifier) {
+ASTNode *Parser::parse_lvalue(const Specifier &specifier) {
   expect(TOKEN_IDENTIFIER);
-  std::string var_name = current_token.text;
-  std::unique_ptr<VarNode> var = std::make_unique<VarNode>(
+  std::string var_name(current_token.text);
+  VarNode *var = arena.create<VarNode>(
       var_name, SourceLocation{current_token.line, current_token.index});
   advance();
 
@@ -784,20 +786,20 @@ std::unique_ptr<ASTNode> Parser::parse_lvalue(const Specifier &specifier) {
     auto index = parse_expr();
     expect_and_advance(TOKEN_RSBRACE);
 
-    return std::make_unique<ArrayAccessNode>(
-        std::move(var), std::move(index),
+    return arena.create<ArrayAccessNode>(
+        var, index,
         SourceLocation{current_token.line, current_token.index});
   } else if (match(TOKEN_DOT) || match(TOKEN_ARROW)) {
     TokenType op = current_token.type;
     advance();
     expect(TOKEN_IDENTIFIER);
 
-    std::string field_name = current_token.text;
+    std::string field_name(current_token.text);
 
-    std::unique_ptr<ASTNode> test = parse_factor();
+    ASTNode *test = parse_factor();
 
-    std::unique_ptr<PostfixNode> postfix = std::make_unique<PostfixNode>(
-        op, std::move(test),
+    PostfixNode *postfix = arena.create<PostfixNode>(
+        op, test,
         SourceLocation{current_token.line, current_token.index});
     postfix->struct_name = var_name;
     postfix->field_name = field_name;
@@ -808,38 +810,38 @@ std::unique_ptr<ASTNode> Parser::parse_lvalue(const Specifier &specifier) {
     return var;
 }
 
-std::unique_ptr<ASTNode> Parser::parse_cast() {
+ASTNode *Parser::parse_cast() {
   expect_and_advance(TOKEN_LPAREN);
 
   Type type = parse_type();
 
   expect_and_advance(TOKEN_RPAREN);
 
-  std::unique_ptr<ASTNode> factor = parse_factor();
+  ASTNode *factor = parse_factor();
 
   if (!factor)
     error("Expected expression after cast");
 
-  return std::make_unique<CastNode>(
-      std::move(factor), type, Type(BaseType::VOID),
+  return arena.create<CastNode>(
+      factor, type, Type(BaseType::VOID),
       SourceLocation{current_token.line, current_token.index});
 }
 
-std::unique_ptr<ASTNode> Parser::parse_sizeof() {
+ASTNode *Parser::parse_sizeof() {
   expect_and_advance(TOKEN_SIZEOF);
   expect_and_advance(TOKEN_LPAREN);
 
-  std::unique_ptr<SizeOfNode> sizeof_node = nullptr;
+  SizeOfNode *sizeof_node = nullptr;
 
   if (match(TOKEN_IDENTIFIER)) {
-    std::string var_name = current_token.text;
+    std::string var_name(current_token.text);
     advance();
-    sizeof_node = std::make_unique<SizeOfNode>(
-        std::make_unique<VarNode>(
+    sizeof_node = arena.create<SizeOfNode>(
+        arena.create<VarNode>(
             var_name, SourceLocation{current_token.line, current_token.index}),
         SourceLocation{current_token.line, current_token.index});
   } else
-    sizeof_node = std::make_unique<SizeOfNode>(
+    sizeof_node = arena.create<SizeOfNode>(
         parse_type(), SourceLocation{current_token.line, current_token.index});
 
   expect(TOKEN_RPAREN);
@@ -847,7 +849,7 @@ std::unique_ptr<ASTNode> Parser::parse_sizeof() {
   return sizeof_node;
 }
 
-std::unique_ptr<ASTNode> Parser::parse_import() {
+ASTNode *Parser::parse_import() {
   expect_and_advance(TOKEN_IMPORT);
   expect_and_advance(TOKEN_LBRACE);
 
@@ -859,9 +861,9 @@ std::unique_ptr<ASTNode> Parser::parse_import() {
 
       expect(TOKEN_IDENTIFIER);
 
-      includes.push_back("struct " + current_token.text);
+      includes.push_back("struct " + std::string(current_token.text));
     } else
-      includes.push_back(current_token.text);
+      includes.emplace_back(current_token.text);
 
     advance();
   }
@@ -870,11 +872,11 @@ std::unique_ptr<ASTNode> Parser::parse_import() {
 
   expect_and_advance(TOKEN_FROM);
 
-  std::string module_name = current_token.text;
+  std::string module_name(current_token.text);
 
   advance_and_expect(TOKEN_SEMICOLON);
 
-  return std::make_unique<IncludeNode>(
+  return arena.create<IncludeNode>(
       module_name, includes,
       SourceLocation{current_token.line, current_token.index});
 }
\ No newline at end of file
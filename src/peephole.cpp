@@ -0,0 +1,520 @@
+#include "../include/peephole.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+static std::string trim(const std::string &str)
+{
+	size_t start = str.find_first_not_of(" \t");
+	if (start == std::string::npos)
+		return "";
+
+	size_t end = str.find_last_not_of(" \t");
+	return str.substr(start, end - start + 1);
+}
+
+MachineInstr MachineInstr::parse(const std::string &line)
+{
+	MachineInstr instr = {Kind::COMMENT, "", {}, line};
+
+	std::string stripped = trim(line);
+	if (stripped.empty() || stripped[0] == '#')
+		return instr;
+
+	size_t end = stripped.find_first_of(" \t");
+	std::string first = stripped.substr(0, end);
+
+	if (first.back() == ':')
+	{
+		instr.kind = Kind::LABEL;
+		instr.op = first.substr(0, first.size() - 1);
+		return instr;
+	}
+
+	if (first[0] == '.')
+	{
+		instr.kind = Kind::DIRECTIVE;
+		return instr;
+	}
+
+	instr.kind = Kind::INSTRUCTION;
+	instr.op = first;
+
+	if (end == std::string::npos)
+		return instr;
+
+	// Operands are separated by commas (other than those within a memory operand)
+	std::string rest = stripped.substr(end);
+	std::string operand = "";
+	int depth = 0;
+
+	for (char c : rest)
+	{
+		if (c == '#')
+			break;
+
+		if (c == '(')
+			depth++;
+		else if (c == ')')
+			depth--;
+
+		if (c == ',' && depth == 0)
+		{
+			instr.operands.push_back(trim(operand));
+			operand.clear();
+			continue;
+		}
+
+		operand += c;
+	}
+
+	if (!trim(operand).empty())
+		instr.operands.push_back(trim(operand));
+
+	return instr;
+}
+
+void MachineInstr::set(const std::string &new_op, const std::vector<std::string> &new_operands)
+{
+	op = new_op;
+	operands = new_operands;
+
+	text = "\t" + op;
+	for (size_t i = 0; i < operands.size(); i++)
+		text += (i == 0 ? "\t" : ", ") + operands[i];
+}
+
+static bool is_immediate(const std::string &operand)
+{
+	return !operand.empty() && operand[0] == '$';
+}
+
+static bool is_register(const std::string &operand)
+{
+	return !operand.empty() && operand[0] == '%';
+}
+
+static bool is_memory(const std::string &operand)
+{
+	return !is_immediate(operand) && !is_register(operand);
+}
+
+static bool mentions(const std::string &operand, const std::string &reg)
+{
+	return operand.find(reg) != std::string::npos;
+}
+
+static bool is_move(const std::string &op)
+{
+	return op == "movl" || op == "movq" || op == "movb" || op == "movw" || op == "movsd";
+}
+
+// The part of a general purpose register's name shared by all its sizes (%rdi, %edi and %dil are all "di")
+static std::string register_base(const std::string &operand)
+{
+	std::string base = operand.substr(1);
+	if (!base.empty() && (base[0] == 'r' || base[0] == 'e'))
+		base = base.substr(1);
+	while (base.size() > 1 && (base.back() == 'd' || base.back() == 'w' || base.back() == 'b' || base.back() == 'l' ||
+							   base.back() == 'x'))
+		base.pop_back();
+
+	return base;
+}
+
+// The scratch register (%r10 or %r11) an operand is exactly (in a 32/64 bit form), if any
+static std::string get_scratch(const std::string &operand)
+{
+	for (std::string reg : {"%r10", "%r11"})
+		if (operand == reg || operand == reg + "d")
+			return reg;
+
+	return "";
+}
+
+static const std::unordered_map<std::string, std::string> inverse_conditions = {
+	{"e", "ne"}, {"ne", "e"}, {"l", "ge"}, {"ge", "l"}, {"le", "g"}, {"g", "le"},
+	{"b", "ae"}, {"ae", "b"}, {"be", "a"}, {"a", "be"},
+};
+
+size_t PeepholeOptimiser::next(size_t i) const
+{
+	auto &instrs = *instructions;
+
+	for (i++; i < instrs.size(); i++)
+		if (instrs[i].kind != MachineInstr::Kind::COMMENT)
+			break;
+
+	return i;
+}
+
+void PeepholeOptimiser::erase(size_t i)
+{
+	instructions->erase(instructions->begin() + i);
+}
+
+bool PeepholeOptimiser::is_scratch_dead_after(size_t i, const std::string &reg) const
+{
+	auto &instrs = *instructions;
+
+	for (size_t j = next(i); j < instrs.size(); j = next(j))
+	{
+		const MachineInstr &instr = instrs[j];
+
+		if (instr.kind == MachineInstr::Kind::LABEL)
+			return true;
+		if (instr.kind != MachineInstr::Kind::INSTRUCTION)
+			continue;
+
+		const std::string &op = instr.op;
+		if (op[0] == 'j' || op == "call" || op == "retq" || op == "ret")
+			return true;
+
+		if (instr.operands.empty())
+			continue;
+
+		for (size_t k = 0; k + 1 < instr.operands.size(); k++)
+			if (mentions(instr.operands[k], reg))
+				return false;
+
+		const std::string &last = instr.operands.back();
+		if (!mentions(last, reg))
+			continue;
+
+		// Completely overwritten without being read first
+		bool is_definition = instr.operands.size() > 1 && (op.rfind("mov", 0) == 0 || op.rfind("lea", 0) == 0 ||
+														   op.rfind("cvt", 0) == 0);
+		return (is_definition || op == "popq") && get_scratch(last) == reg;
+	}
+
+	return true;
+}
+
+bool PeepholeOptimiser::remove_self_moves()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	for (size_t i = 0; i < instrs.size();)
+	{
+		const MachineInstr &instr = instrs[i];
+
+		// movl zero extends the upper half so isn't a no-op
+		if (instr.kind == MachineInstr::Kind::INSTRUCTION && is_move(instr.op) && instr.op != "movl" &&
+			instr.operands.size() == 2 && instr.operands[0] == instr.operands[1])
+		{
+			erase(i);
+			changed = true;
+			continue;
+		}
+
+		i++;
+	}
+
+	return changed;
+}
+
+bool PeepholeOptimiser::forward_stores()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	for (size_t i = 0; i < instrs.size(); i++)
+	{
+		const MachineInstr &store = instrs[i];
+		if (store.kind != MachineInstr::Kind::INSTRUCTION || !is_move(store.op) || store.operands.size() != 2)
+			continue;
+
+		size_t j = next(i);
+		if (j >= instrs.size())
+			break;
+
+		MachineInstr &load = instrs[j];
+		const std::string &src = store.operands[0];
+		const std::string &dst = store.operands[1];
+
+		if (load.kind != MachineInstr::Kind::INSTRUCTION || load.op != store.op || load.operands.size() != 2 ||
+			load.operands[0] != dst || src == dst || is_immediate(dst))
+			continue;
+
+		// mov A, B then mov B, A (the value is still there)
+		if (load.operands[1] == src)
+		{
+			erase(j);
+			changed = true;
+			continue;
+		}
+
+		// mov A, B then mov B, C can copy from A instead (unless that turns a register move into a load)
+		// An immediate can't be moved straight into an xmm register
+		if (!is_memory(src) && !(is_immediate(src) && (is_memory(load.operands[1]) || mentions(load.operands[1], "%xmm"))) &&
+			load.operands[0] != src)
+		{
+			load.set(load.op, {src, load.operands[1]});
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+bool PeepholeOptimiser::fold_scratch_ops()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	static const std::vector<std::string> binary_ops = {"add", "sub", "and", "or", "xor", "imul", "shl", "shr", "sar"};
+	static const std::vector<std::string> unary_ops = {"neg", "not"};
+
+	for (size_t i = 0; i < instrs.size(); i++)
+	{
+		/*
+			mov A, %r10
+			op S, %r10
+			mov %r10, A
+			Becomes op S, A (and mov A, %r10 then cmp S, %r10 becomes cmp S, A)
+		*/
+		const MachineInstr &load = instrs[i];
+		if (load.kind != MachineInstr::Kind::INSTRUCTION || (load.op != "movl" && load.op != "movq") ||
+			load.operands.size() != 2)
+			continue;
+
+		const std::string &value = load.operands[0];
+		std::string reg = get_scratch(load.operands[1]);
+		if (reg.empty() || mentions(value, reg) || is_immediate(value))
+			continue;
+
+		size_t j = next(i);
+		if (j >= instrs.size())
+			break;
+
+		const MachineInstr &op = instrs[j];
+		const char suffix = load.op.back();
+
+		// A value only loaded to be compared can be compared where it is
+		if (op.kind == MachineInstr::Kind::INSTRUCTION && op.op == std::string("cmp") + suffix &&
+			op.operands.size() == 2 && op.operands[1] == load.operands[1] && !mentions(op.operands[0], reg) &&
+			!(is_memory(value) && is_memory(op.operands[0])) && is_scratch_dead_after(j, reg))
+		{
+			std::vector<std::string> operands = {op.operands[0], value};
+			erase(j);
+			instrs[i].set(std::string("cmp") + suffix, operands);
+			changed = true;
+			continue;
+		}
+
+		size_t k = next(j);
+		if (k >= instrs.size())
+			break;
+
+		const MachineInstr &store = instrs[k];
+
+		if (op.kind != MachineInstr::Kind::INSTRUCTION || store.kind != MachineInstr::Kind::INSTRUCTION ||
+			store.op != load.op || store.operands.size() != 2 || store.operands[0] != load.operands[1] ||
+			store.operands[1] != value)
+			continue;
+
+		auto is_op = [&](const std::vector<std::string> &ops)
+		{
+			for (auto &name : ops)
+				if (op.op == name + suffix)
+					return true;
+			return false;
+		};
+
+		std::vector<std::string> operands;
+		if (is_op(binary_ops) && op.operands.size() == 2 && op.operands[1] == load.operands[1] &&
+			!mentions(op.operands[0], reg))
+		{
+			// Memory destinations can't be multiplied into or take a memory source
+			if (is_memory(value) && (op.op.rfind("imul", 0) == 0 || is_memory(op.operands[0])))
+				continue;
+			operands = {op.operands[0], value};
+		}
+		else if (is_op(unary_ops) && op.operands.size() == 1 && op.operands[0] == load.operands[1])
+			operands = {value};
+		else
+			continue;
+
+		if (!is_scratch_dead_after(k, reg))
+			continue;
+
+		std::string new_op = op.op;
+		erase(k);
+		erase(j);
+		instrs[i].set(new_op, operands);
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool PeepholeOptimiser::remove_dead_scratch_moves()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	for (size_t i = 0; i < instrs.size();)
+	{
+		const MachineInstr &instr = instrs[i];
+
+		if (instr.kind == MachineInstr::Kind::INSTRUCTION && instr.operands.size() == 2 &&
+			(instr.op.rfind("mov", 0) == 0 || instr.op.rfind("lea", 0) == 0))
+		{
+			std::string reg = get_scratch(instr.operands[1]);
+			if (!reg.empty() && is_scratch_dead_after(i, reg))
+			{
+				erase(i);
+				changed = true;
+				continue;
+			}
+		}
+
+		i++;
+	}
+
+	return changed;
+}
+
+bool PeepholeOptimiser::remove_jumps_to_next()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	for (size_t i = 0; i < instrs.size();)
+	{
+		const MachineInstr &jump = instrs[i];
+
+		bool is_redundant = false;
+		if (jump.kind == MachineInstr::Kind::INSTRUCTION && jump.op[0] == 'j' && jump.operands.size() == 1)
+		{
+			// Any of the labels straight after could be the target
+			for (size_t j = next(i); j < instrs.size() && instrs[j].kind == MachineInstr::Kind::LABEL; j = next(j))
+				if (instrs[j].op == jump.operands[0])
+					is_redundant = true;
+		}
+
+		if (is_redundant)
+		{
+			erase(i);
+			changed = true;
+			continue;
+		}
+
+		i++;
+	}
+
+	return changed;
+}
+
+bool PeepholeOptimiser::fuse_compare_branches()
+{
+	auto &instrs = *instructions;
+	bool changed = false;
+
+	for (size_t i = 0; i < instrs.size(); i++)
+	{
+		/*
+			setcc %r10b
+			movzbl %r10b, %r10d
+			(moves which don't touch %r10 or the flags)
+			cmpl $1, %r10d
+			je L
+			Can jump on the flags setcc used instead (so the cmp goes)
+			The cmp can also be of a register the boolean was copied into (where it was allocated)
+		*/
+		const MachineInstr &set = instrs[i];
+		if (set.kind != MachineInstr::Kind::INSTRUCTION || set.op.rfind("set", 0) != 0 || set.operands.size() != 1)
+			continue;
+
+		auto condition = inverse_conditions.find(set.op.substr(3));
+		if (condition == inverse_conditions.end())
+			continue;
+
+		const std::string byte_reg = set.operands[0];
+		std::string reg = get_scratch(byte_reg.substr(0, byte_reg.size() - 1));
+		if (reg.empty() || byte_reg != reg + "b")
+			continue;
+
+		size_t j = next(i);
+		bool is_extended = false;
+		std::vector<std::string> copies;
+
+		for (; j < instrs.size(); j = next(j))
+		{
+			const MachineInstr &instr = instrs[j];
+			if (instr.kind != MachineInstr::Kind::INSTRUCTION)
+				break;
+
+			if (instr.op == "movzbl" && instr.operands.size() == 2 && instr.operands[0] == byte_reg &&
+				instr.operands[1] == reg + "d")
+			{
+				is_extended = true;
+				continue;
+			}
+
+			if (!is_move(instr.op) || instr.operands.size() != 2 || mentions(instr.operands[1], reg))
+				break;
+
+			const std::string &dst = instr.operands[1];
+			if (!is_register(dst))
+				continue;
+
+			// A later move into (any size of) a copy's register overwrites it
+			for (size_t c = 0; c < copies.size();)
+			{
+				if (register_base(copies[c]) == register_base(dst))
+					copies.erase(copies.begin() + c);
+				else
+					c++;
+			}
+
+			// Only once extended does the whole register hold the boolean
+			if (is_extended && (instr.operands[0] == reg + "d" || instr.operands[0] == reg) && !mentions(dst, "%xmm"))
+				copies.push_back(dst);
+		}
+
+		size_t k = next(j);
+		if (k >= instrs.size())
+			break;
+
+		MachineInstr &cmp = instrs[j];
+		MachineInstr &jump = instrs[k];
+
+		std::string compared = is_extended ? reg + "d" : byte_reg;
+		bool is_copy = std::find(copies.begin(), copies.end(), cmp.operands.size() == 2 ? cmp.operands[1] : "") !=
+					   copies.end();
+		if (cmp.kind != MachineInstr::Kind::INSTRUCTION || cmp.op.rfind("cmp", 0) != 0 || cmp.operands.size() != 2 ||
+			(cmp.operands[1] != compared && !is_copy) || (cmp.operands[0] != "$0" && cmp.operands[0] != "$1") ||
+			jump.kind != MachineInstr::Kind::INSTRUCTION || (jump.op != "je" && jump.op != "jne"))
+			continue;
+
+		// Jumping when the boolean is 1 is jumping when the condition held
+		bool when_true = (cmp.operands[0] == "$1") == (jump.op == "je");
+		std::string cc = when_true ? set.op.substr(3) : condition->second;
+
+		jump.set("j" + cc, jump.operands);
+		erase(j);
+		changed = true;
+	}
+
+	return changed;
+}
+
+void PeepholeOptimiser::optimise(std::vector<MachineInstr> &instructions)
+{
+	this->instructions = &instructions;
+
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		changed |= remove_self_moves();
+		changed |= forward_stores();
+		changed |= fold_scratch_ops();
+		changed |= remove_dead_scratch_moves();
+		changed |= remove_jumps_to_next();
+		changed |= fuse_compare_branches();
+	}
+}
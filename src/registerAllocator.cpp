@@ -0,0 +1,556 @@
+#include "../include/registerAllocator.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+RegisterAllocator::RegisterAllocator(std::shared_ptr<GlobalSymbolTable> gst, AllocStrategy strategy)
+	: gst(gst), strategy(strategy) {}
+
+void RegisterAllocator::allocate(const std::vector<TACInstruction> &instructions)
+{
+	for (auto [begin, end] : find_func_ranges(instructions))
+	{
+		gst->enter_func_scope(instructions[begin].arg1);
+		allocate_func(instructions, begin, end);
+		gst->leave_func_scope();
+	}
+}
+
+void RegisterAllocator::allocate_func(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	Liveness liveness(gst);
+	liveness.analyse(instructions, begin, end);
+
+	reserve_arg_registers(instructions, begin, end);
+
+	std::vector<LiveInterval> intervals = build_intervals(instructions, begin, end, liveness);
+
+	if (strategy == AllocStrategy::GRAPH_COLOURING)
+		colour_graph(intervals, instructions, begin, end, liveness);
+	else
+		linear_scan(intervals);
+
+	SymbolTable *st = gst->get_func_st(gst->get_current_func());
+
+	for (auto &interval : intervals)
+	{
+		if (interval.reg.empty())
+			continue;
+
+		gst->get_symbol(interval.name)->reg = interval.reg;
+
+		if (is_callee_saved(interval.reg))
+			st->add_saved_reg(interval.reg);
+	}
+}
+
+void RegisterAllocator::reserve_arg_registers(const std::vector<TACInstruction> &instructions, size_t begin, size_t end)
+{
+	/*
+		The argument registers are only free in between calls
+		- Arguments are loaded into them some time before the CALL
+		- Parameters are read out of them some time after FUNC_BEGIN
+		- PUSH/POP (used to preserve arguments across nested calls) overwrite them
+
+		The instruction which moves a value in/out isn't included
+		So a variable which dies (or is born) there can share the register (and the move disappears)
+	*/
+	reserved_ranges.clear();
+
+	int last_call = 0;
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+		int index = i - begin;
+
+		if (instruction.op == TACOp::MOV_BETWEEN_REG)
+		{
+			if (instruction.result == "load")
+			{
+				size_t call = i;
+				while (call < end && instructions[call].op != TACOp::CALL)
+					call++;
+
+				reserved_ranges[instruction.arg2].emplace_back(index + 1, call - begin);
+			}
+			else
+				reserved_ranges[instruction.arg2].emplace_back(last_call, index - 1);
+		}
+		else if (instruction.op == TACOp::PUSH || instruction.op == TACOp::POP)
+			reserved_ranges[instruction.arg1].emplace_back(index, index);
+		else if (instruction.op == TACOp::CALL)
+			last_call = index;
+	}
+}
+
+bool RegisterAllocator::is_callee_saved(const std::string &reg)
+{
+	return std::find(callee_saved_registers.begin(), callee_saved_registers.end(), reg) !=
+		   callee_saved_registers.end();
+}
+
+bool RegisterAllocator::can_use_reg(const LiveInterval &interval, const std::string &reg)
+{
+	bool is_xmm = reg.rfind("%xmm", 0) == 0;
+
+	if (is_xmm != interval.is_double)
+		return false;
+
+	if (is_callee_saved(reg))
+		return true;
+
+	if (interval.crosses_call)
+		return false;
+
+	for (auto [start, end] : reserved_ranges[reg])
+		for (int point : interval.points)
+			if (start <= point && point <= end)
+				return false;
+
+	return true;
+}
+
+std::string RegisterAllocator::pick_register(const LiveInterval &interval, const std::vector<std::string> &free_regs,
+											 const std::unordered_set<std::string> &used_callee_saved)
+{
+	/*
+		Registers are tried in order of preference
+		- The register the value is moved to/from (which removes the move entirely)
+		- Caller-saved registers are free to use whereas callee-saved ones cost a push/pop
+		- So reuse any callee-saved registers which have already been handed out first
+	*/
+	if (!interval.hint.empty() && can_use_reg(interval, interval.hint) &&
+		std::find(free_regs.begin(), free_regs.end(), interval.hint) != free_regs.end())
+		return interval.hint;
+
+	std::string fallback = "";
+
+	for (auto &reg : free_regs)
+	{
+		if (!can_use_reg(interval, reg))
+			continue;
+
+		if (!is_callee_saved(reg) || used_callee_saved.count(reg))
+			return reg;
+
+		if (fallback.empty())
+			fallback = reg;
+	}
+
+	return fallback;
+}
+
+Type RegisterAllocator::get_access_type(const TACInstruction &instruction, const std::string &name)
+{
+	/*
+		Most operands are accessed with the type of the instruction
+		The exceptions are the source of a conversion (read as the type in arg2) and index/offset operands
+	*/
+	if (instruction.op == TACOp::CONVERT_TYPE && name == instruction.arg1)
+	{
+		Type src_type = get_type_from_str(instruction.arg2);
+		return src_type.is_void() ? instruction.type : src_type;
+	}
+
+	if ((instruction.op == TACOp::ASSIGN || instruction.op == TACOp::ASSIGN_DEREF) && name == instruction.arg2)
+		return Type(BaseType::INT);
+
+	return instruction.type;
+}
+
+std::vector<std::string> RegisterAllocator::find_candidates(const std::vector<TACInstruction> &instructions, size_t begin,
+															size_t end, const Liveness &liveness)
+{
+	/*
+		A variable may only live in a register if:
+		- It is a scalar (arrays, structs and pointers are addressed through the frame)
+		- Its address is never taken
+		- Every instruction accesses it with a type of the same size/class as its own
+		  (otherwise the assembler would need differently sized views of the register)
+	*/
+	std::unordered_set<std::string> rejected;
+
+	auto is_scalar = [](const Type &type)
+	{
+		if (type.is_pointer() || type.is_array() || type.is_struct())
+			return false;
+
+		size_t size = type.get_size();
+		return size == 1 || size == 4 || size == 8;
+	};
+
+	for (size_t i = begin; i <= end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		if (instruction.op == TACOp::ADDR_OF)
+			rejected.insert(instruction.arg1);
+
+		std::vector<std::string> operands = get_tac_uses(instruction, gst.get());
+		std::vector<std::string> defs = get_tac_defs(instruction, gst.get());
+		operands.insert(operands.end(), defs.begin(), defs.end());
+
+		for (auto &name : operands)
+		{
+			Symbol *sym = gst->get_symbol(name);
+			Type access = get_access_type(instruction, name);
+
+			if (access.is_array() || access.is_pointer() || access.get_size() != sym->type.get_size() ||
+				access.has_base_type(BaseType::DOUBLE) != sym->type.has_base_type(BaseType::DOUBLE))
+				rejected.insert(name);
+		}
+	}
+
+	std::vector<std::string> candidates;
+
+	for (auto &name : liveness.get_vars())
+	{
+		Symbol *sym = gst->get_symbol(name);
+
+		if (is_scalar(sym->type) && !rejected.count(name))
+			candidates.push_back(name);
+	}
+
+	return candidates;
+}
+
+std::vector<LiveInterval> RegisterAllocator::build_intervals(const std::vector<TACInstruction> &instructions,
+															 size_t begin, size_t end, const Liveness &liveness)
+{
+	std::vector<LiveInterval> intervals;
+
+	const auto &live_in = liveness.get_live_in();
+	const auto &live_out = liveness.get_live_out();
+	const auto &uses = liveness.get_uses();
+	const auto &defs = liveness.get_defs();
+
+	for (auto &name : find_candidates(instructions, begin, end, liveness))
+	{
+		int id = liveness.get_var_id(name);
+
+		LiveInterval interval;
+		interval.name = name;
+		interval.is_double = gst->get_symbol(name)->type.has_base_type(BaseType::DOUBLE);
+
+		for (size_t i = 0; i <= end - begin; i++)
+		{
+			const TACInstruction &instruction = instructions[begin + i];
+
+			bool is_use = std::find(uses[i].begin(), uses[i].end(), id) != uses[i].end();
+			bool is_def = std::find(defs[i].begin(), defs[i].end(), id) != defs[i].end();
+
+			if (is_use || is_def)
+				interval.weight++;
+
+			if (live_in[i][id] || is_def)
+				interval.points.push_back(i);
+
+			if (!is_use && !is_def && !live_in[i][id] && !live_out[i][id])
+				continue;
+
+			if (interval.start == -1)
+				interval.start = i;
+			interval.end = i;
+
+			if (instruction.op == TACOp::CALL && live_out[i][id])
+				interval.crosses_call = true;
+
+			if (instruction.op == TACOp::MOV_BETWEEN_REG && instruction.arg1 == name &&
+				std::find(caller_saved_registers.begin(), caller_saved_registers.end(), instruction.arg2) !=
+					caller_saved_registers.end())
+				interval.hint = instruction.arg2;
+		}
+
+		if (interval.start != -1)
+			intervals.push_back(interval);
+	}
+
+	return intervals;
+}
+
+void RegisterAllocator::linear_scan(std::vector<LiveInterval> &intervals)
+{
+	std::sort(intervals.begin(), intervals.end(),
+			  [](const LiveInterval &a, const LiveInterval &b)
+			  { return a.start < b.start; });
+
+	std::vector<std::string> free_regs = caller_saved_registers;
+	free_regs.insert(free_regs.end(), callee_saved_registers.begin(), callee_saved_registers.end());
+	free_regs.insert(free_regs.end(), xmm_registers.begin(), xmm_registers.end());
+
+	std::unordered_set<std::string> used_callee_saved;
+
+	// Indices into intervals which currently hold a register
+	std::vector<size_t> active;
+
+	for (size_t i = 0; i < intervals.size(); i++)
+	{
+		LiveInterval &current = intervals[i];
+
+		// Expire intervals which have ended (registers are only shared once the old value is completely dead)
+		for (auto it = active.begin(); it != active.end();)
+		{
+			LiveInterval &old = intervals[*it];
+			if (old.end < current.start)
+			{
+				free_regs.push_back(old.reg);
+				it = active.erase(it);
+			}
+			else
+				++it;
+		}
+
+		std::string reg = pick_register(current, free_regs, used_callee_saved);
+
+		if (!reg.empty())
+		{
+			current.reg = reg;
+			free_regs.erase(std::find(free_regs.begin(), free_regs.end(), reg));
+			active.push_back(i);
+
+			if (is_callee_saved(reg))
+				used_callee_saved.insert(reg);
+			continue;
+		}
+
+		/*
+			Out of registers so spill whichever usable interval ends last
+			This frees a register for the longest amount of time
+		*/
+		auto spill = active.end();
+		for (auto it = active.begin(); it != active.end(); ++it)
+			if (can_use_reg(current, intervals[*it].reg) &&
+				(spill == active.end() || intervals[*it].end > intervals[*spill].end))
+				spill = it;
+
+		if (spill != active.end() && intervals[*spill].end > current.end)
+		{
+			current.reg = intervals[*spill].reg;
+			intervals[*spill].reg = "";
+			active.erase(spill);
+			active.push_back(i);
+		}
+	}
+}
+
+void RegisterAllocator::colour_graph(std::vector<LiveInterval> &intervals, const std::vector<TACInstruction> &instructions,
+									 size_t begin, size_t end, const Liveness &liveness)
+{
+	size_t count = intervals.size();
+
+	std::unordered_map<std::string, size_t> index_of;
+	for (size_t i = 0; i < count; i++)
+		index_of[intervals[i].name] = i;
+
+	auto find_index = [&](const std::string &name) -> int
+	{
+		auto it = index_of.find(name);
+		return it != index_of.end() ? (int)it->second : -1;
+	};
+
+	/*
+		Build the interference graph
+		Anything defined interferes with everything live after it
+		The exception is the source of a copy (as they hold the same value) which allows them to be coalesced
+	*/
+	std::vector<std::unordered_set<size_t>> adj(count);
+	std::vector<std::pair<size_t, size_t>> moves;
+
+	auto add_edge = [&](size_t a, size_t b)
+	{
+		if (a == b || intervals[a].is_double != intervals[b].is_double)
+			return;
+
+		adj[a].insert(b);
+		adj[b].insert(a);
+	};
+
+	const auto &vars = liveness.get_vars();
+	const auto &live_out = liveness.get_live_out();
+	const auto &defs = liveness.get_defs();
+
+	for (size_t i = 0; i <= end - begin; i++)
+	{
+		const TACInstruction &instruction = instructions[begin + i];
+
+		bool is_copy = instruction.op == TACOp::ASSIGN && instruction.arg2.empty();
+		int copy_src = is_copy ? find_index(instruction.result) : -1;
+
+		for (int def : defs[i])
+		{
+			int d = find_index(vars[def]);
+			if (d == -1)
+				continue;
+
+			for (size_t v = 0; v < vars.size(); v++)
+			{
+				int other = find_index(vars[v]);
+				if (live_out[i][v] && other != -1 && other != copy_src)
+					add_edge(d, other);
+			}
+
+			if (copy_src != -1 && intervals[d].is_double == intervals[copy_src].is_double)
+				moves.emplace_back(d, copy_src);
+		}
+	}
+
+	auto colours_for = [&](size_t node) -> size_t
+	{
+		return intervals[node].is_double ? xmm_registers.size()
+										 : caller_saved_registers.size() + callee_saved_registers.size();
+	};
+
+	std::vector<size_t> alias(count);
+	for (size_t i = 0; i < count; i++)
+		alias[i] = i;
+
+	auto find_alias = [&](size_t node)
+	{
+		while (alias[node] != node)
+			node = alias[node];
+		return node;
+	};
+
+	/*
+		Conservative (Briggs) coalescing
+		Two copy related nodes are merged only if the result has fewer than K neighbours of significant degree
+		Which guarantees the merged node is still colourable
+	*/
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (auto [dst, src] : moves)
+		{
+			size_t a = find_alias(dst);
+			size_t b = find_alias(src);
+
+			if (a == b || adj[a].count(b))
+				continue;
+
+			std::unordered_set<size_t> neighbours = adj[a];
+			neighbours.insert(adj[b].begin(), adj[b].end());
+
+			size_t significant = 0;
+			for (size_t neighbour : neighbours)
+				if (adj[neighbour].size() >= colours_for(neighbour))
+					significant++;
+
+			if (significant >= colours_for(a))
+				continue;
+
+			LiveInterval merged = intervals[a];
+			merged.points.insert(merged.points.end(), intervals[b].points.begin(), intervals[b].points.end());
+			merged.crosses_call = merged.crosses_call || intervals[b].crosses_call;
+			merged.start = std::min(merged.start, intervals[b].start);
+			merged.end = std::max(merged.end, intervals[b].end);
+			merged.weight += intervals[b].weight;
+			if (merged.hint.empty())
+				merged.hint = intervals[b].hint;
+
+			// Don't merge into something which can no longer live in any register
+			bool has_register = false;
+			for (auto *pool : {&caller_saved_registers, &callee_saved_registers, &xmm_registers})
+				for (auto &reg : *pool)
+					has_register = has_register || can_use_reg(merged, reg);
+
+			if (!has_register)
+				continue;
+
+			for (size_t neighbour : adj[b])
+			{
+				adj[neighbour].erase(b);
+				adj[neighbour].insert(a);
+				adj[a].insert(neighbour);
+			}
+
+			adj[b].clear();
+			alias[b] = a;
+			intervals[a] = merged;
+			changed = true;
+		}
+	}
+
+	/*
+		Simplify: repeatedly remove nodes with fewer than K neighbours
+		If there are none, optimistically remove the cheapest node to spill (it may still get a colour)
+	*/
+	std::vector<size_t> stack;
+	std::vector<bool> removed(count, false);
+
+	auto degree = [&](size_t node)
+	{
+		size_t d = 0;
+		for (size_t neighbour : adj[node])
+			if (!removed[neighbour])
+				d++;
+		return d;
+	};
+
+	size_t remaining = 0;
+	for (size_t i = 0; i < count; i++)
+		if (find_alias(i) == i)
+			remaining++;
+
+	while (remaining > 0)
+	{
+		int chosen = -1;
+
+		for (size_t i = 0; i < count && chosen == -1; i++)
+			if (find_alias(i) == i && !removed[i] && degree(i) < colours_for(i))
+				chosen = i;
+
+		if (chosen == -1)
+		{
+			double best_cost = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (find_alias(i) != i || removed[i])
+					continue;
+
+				double cost = (double)intervals[i].weight / (degree(i) + 1);
+				if (chosen == -1 || cost < best_cost)
+				{
+					chosen = i;
+					best_cost = cost;
+				}
+			}
+		}
+
+		removed[chosen] = true;
+		stack.push_back(chosen);
+		remaining--;
+	}
+
+	// Select: give each node a register not used by its (already coloured) neighbours
+	std::unordered_set<std::string> used_callee_saved;
+
+	while (!stack.empty())
+	{
+		size_t node = stack.back();
+		stack.pop_back();
+
+		std::unordered_set<std::string> taken;
+		for (size_t neighbour : adj[node])
+			if (!intervals[neighbour].reg.empty())
+				taken.insert(intervals[neighbour].reg);
+
+		std::vector<std::string> free_regs;
+		for (auto *pool : {&caller_saved_registers, &callee_saved_registers, &xmm_registers})
+			for (auto &reg : *pool)
+				if (!taken.count(reg))
+					free_regs.push_back(reg);
+
+		intervals[node].reg = pick_register(intervals[node], free_regs, used_callee_saved);
+
+		if (is_callee_saved(intervals[node].reg))
+			used_callee_saved.insert(intervals[node].reg);
+	}
+
+	// Coalesced nodes share the register of whatever they were merged into
+	for (size_t i = 0; i < count; i++)
+		intervals[i].reg = intervals[find_alias(i)].reg;
+}
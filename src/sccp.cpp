@@ -0,0 +1,499 @@
+#include "../include/sccp.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include "../include/liveness.h"
+
+bool parse_int_literal(const std::string &str, long long &value)
+{
+	size_t start = !str.empty() && str[0] == '-' ? 1 : 0;
+	if (start == str.size())
+		return false;
+
+	for (size_t i = start; i < str.size(); i++)
+		if (!isdigit(static_cast<unsigned char>(str[i])))
+			return false;
+
+	try
+	{
+		// Large unsigned literals keep their bit pattern
+		value = start ? std::stoll(str) : static_cast<long long>(std::stoull(str));
+	}
+	catch (const std::out_of_range &)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+long long normalise_int(long long value, const Type &type)
+{
+	bool is_signed = type.is_signed();
+
+	switch (type.get_size())
+	{
+	case 1:
+		return is_signed ? static_cast<long long>(static_cast<int8_t>(value))
+						 : static_cast<long long>(static_cast<uint8_t>(value));
+	case 2:
+		return is_signed ? static_cast<long long>(static_cast<int16_t>(value))
+						 : static_cast<long long>(static_cast<uint16_t>(value));
+	case 4:
+		return is_signed ? static_cast<long long>(static_cast<int32_t>(value))
+						 : static_cast<long long>(static_cast<uint32_t>(value));
+	default:
+		return value;
+	}
+}
+
+std::string format_int_literal(long long value, const Type &type)
+{
+	if (type.get_size() == 8 && !type.is_signed())
+		return std::to_string(static_cast<unsigned long long>(value));
+
+	return std::to_string(value);
+}
+
+long long min_int_value(const Type &type)
+{
+	if (!type.is_signed())
+		return 0;
+
+	return normalise_int(static_cast<long long>(1ULL << (type.get_size() * 8 - 1)), type);
+}
+
+SCCP::SCCP(std::shared_ptr<GlobalSymbolTable> gst, const std::unordered_map<std::string, long long> &const_globals)
+	: gst(gst), const_globals(const_globals) {}
+
+bool SCCP::is_tracked(const Type &type) const
+{
+	return type.is_integral() && !type.is_pointer() && !type.is_array();
+}
+
+SCCP::LatticeValue SCCP::meet(const LatticeValue &a, const LatticeValue &b)
+{
+	if (a.state == State::TOP)
+		return b;
+	if (b.state == State::TOP)
+		return a;
+	if (a.state == State::CONST && b.state == State::CONST && a.value == b.value)
+		return a;
+
+	return {State::BOTTOM, 0};
+}
+
+SCCP::LatticeValue SCCP::get_value(const std::string &operand)
+{
+	long long literal;
+	if (parse_int_literal(operand, literal))
+		return {State::CONST, literal};
+
+	Symbol *symbol = gst->get_symbol(operand);
+	if (!symbol || !is_tracked(symbol->type))
+		return {State::BOTTOM, 0};
+
+	if (symbol->is_global)
+	{
+		auto it = const_globals.find(operand);
+		if (it != const_globals.end())
+			return {State::CONST, it->second};
+	}
+
+	// Anything which isn't defined within the function (e.g. read before being written) varies
+	auto it = values.find(operand);
+	if (it == values.end() || !ssa->is_ssa_value(operand))
+		return {State::BOTTOM, 0};
+
+	return it->second;
+}
+
+SCCP::LatticeValue SCCP::evaluate_binary(TACOp op, LatticeValue a, LatticeValue b, const Type &type)
+{
+	if (a.state == State::BOTTOM || b.state == State::BOTTOM)
+		return {State::BOTTOM, 0};
+	if (a.state == State::TOP || b.state == State::TOP)
+		return {State::TOP, 0};
+
+	long long x = normalise_int(a.value, type);
+	long long y = normalise_int(b.value, type);
+	unsigned long long ux = x, uy = y;
+	bool is_signed = type.is_signed();
+
+	// Done unsigned so overflow wraps rather than being undefined
+	switch (op)
+	{
+	case TACOp::ADD:
+		return {State::CONST, normalise_int(ux + uy, type)};
+	case TACOp::SUB:
+		return {State::CONST, normalise_int(ux - uy, type)};
+	case TACOp::MUL:
+		return {State::CONST, normalise_int(ux * uy, type)};
+	case TACOp::DIV:
+	case TACOp::MOD:
+	{
+		// Leave anything which would trap to happen at runtime
+		if (y == 0 || (is_signed && y == -1 && x == LLONG_MIN))
+			return {State::BOTTOM, 0};
+
+		long long result;
+		if (is_signed)
+			result = op == TACOp::DIV ? x / y : x % y;
+		else
+			result = op == TACOp::DIV ? ux / uy : ux % uy;
+
+		return {State::CONST, normalise_int(result, type)};
+	}
+	case TACOp::GT:
+		return {State::CONST, is_signed ? x > y : ux > uy};
+	case TACOp::LT:
+		return {State::CONST, is_signed ? x < y : ux < uy};
+	case TACOp::GTE:
+		return {State::CONST, is_signed ? x >= y : ux >= uy};
+	case TACOp::LTE:
+		return {State::CONST, is_signed ? x <= y : ux <= uy};
+	case TACOp::EQUAL:
+		return {State::CONST, x == y};
+	case TACOp::NOT_EQUAL:
+		return {State::CONST, x != y};
+	case TACOp::AND:
+	case TACOp::OR:
+		// These are done bitwise so only fold booleans
+		if ((x != 0 && x != 1) || (y != 0 && y != 1))
+			return {State::BOTTOM, 0};
+
+		return {State::CONST, op == TACOp::AND ? x & y : x | y};
+	default:
+		return {State::BOTTOM, 0};
+	}
+}
+
+SCCP::LatticeValue SCCP::evaluate(const TACInstruction &instruction, const Type &result_type)
+{
+	switch (instruction.op)
+	{
+	case TACOp::ASSIGN:
+	{
+		// Loads from an array/struct
+		if (!instruction.arg2.empty())
+			return {State::BOTTOM, 0};
+
+		LatticeValue value = get_value(instruction.result);
+		if (value.state == State::CONST)
+			value.value = normalise_int(value.value, result_type);
+		return value;
+	}
+	case TACOp::CONVERT_TYPE:
+	{
+		LatticeValue value = get_value(instruction.arg1);
+		if (value.state == State::CONST)
+			value.value = normalise_int(value.value, result_type);
+		return value;
+	}
+	case TACOp::ADD:
+	case TACOp::SUB:
+	case TACOp::MUL:
+	case TACOp::DIV:
+	case TACOp::MOD:
+	case TACOp::GT:
+	case TACOp::LT:
+	case TACOp::GTE:
+	case TACOp::LTE:
+	case TACOp::EQUAL:
+	case TACOp::NOT_EQUAL:
+	case TACOp::AND:
+	case TACOp::OR:
+	{
+		if (!is_tracked(instruction.type))
+			return {State::BOTTOM, 0};
+
+		LatticeValue value = evaluate_binary(instruction.op, get_value(instruction.arg1),
+											 get_value(instruction.arg2), instruction.type);
+		if (value.state == State::CONST)
+			value.value = normalise_int(value.value, result_type);
+		return value;
+	}
+	case TACOp::NEGATE:
+	case TACOp::COMPLEMENT:
+	case TACOp::NOT:
+	{
+		if (!is_tracked(instruction.type))
+			return {State::BOTTOM, 0};
+
+		LatticeValue value = get_value(instruction.arg1);
+		if (value.state != State::CONST)
+			return value;
+
+		unsigned long long x = normalise_int(value.value, instruction.type);
+		if (instruction.op == TACOp::NEGATE)
+			x = -x;
+		else if (instruction.op == TACOp::COMPLEMENT)
+			x = ~x;
+		else
+			x = x == 0;
+
+		return {State::CONST, normalise_int(x, result_type)};
+	}
+	default:
+		return {State::BOTTOM, 0};
+	}
+}
+
+SCCP::LatticeValue SCCP::evaluate_condition(const TACInstruction &instruction)
+{
+	if (!is_tracked(instruction.type))
+		return {State::BOTTOM, 0};
+
+	return evaluate_binary(convert_BinOpType_to_TACOp(instruction.cmp_op), get_value(instruction.arg1),
+						   get_value(instruction.arg2), instruction.type);
+}
+
+bool SCCP::update(const std::string &name, const LatticeValue &value)
+{
+	LatticeValue &current = values[name];
+	LatticeValue lowered = meet(current, value);
+
+	if (lowered.state == current.state && lowered.value == current.value)
+		return false;
+
+	current = lowered;
+	return true;
+}
+
+bool SCCP::mark_edge(int from, int to)
+{
+	auto &edges = executable_edges[to];
+	if (std::find(edges.begin(), edges.end(), from) != edges.end())
+		return false;
+
+	edges.push_back(from);
+	executable_blocks[to] = true;
+	return true;
+}
+
+void SCCP::propagate(ControlFlowGraph &cfg)
+{
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (int block : cfg.get_rpo())
+		{
+			if (!executable_blocks[block])
+				continue;
+
+			for (auto &instruction : cfg.blocks[block].instructions)
+			{
+				if (instruction.op == TACOp::PHI)
+				{
+					if (!ssa->is_ssa_value(instruction.result))
+						continue;
+
+					LatticeValue value;
+					for (auto &[pred, arg] : instruction.phi_args)
+					{
+						auto &edges = executable_edges[block];
+						if (std::find(edges.begin(), edges.end(), pred) != edges.end())
+							value = meet(value, get_value(arg));
+					}
+
+					changed |= update(instruction.result, value);
+					continue;
+				}
+
+				auto defs = get_tac_def_fields(instruction, gst.get());
+				for (TACField field : defs)
+				{
+					const std::string &name = instruction.*field;
+					if (!ssa->is_ssa_value(name))
+						continue;
+
+					Symbol *symbol = gst->get_symbol(name);
+					LatticeValue value = defs.size() == 1 && is_tracked(symbol->type)
+											 ? evaluate(instruction, symbol->type)
+											 : LatticeValue{State::BOTTOM, 0};
+
+					changed |= update(name, value);
+				}
+			}
+
+			const auto &succs = cfg.blocks[block].succs;
+			const auto &instructions = cfg.blocks[block].instructions;
+
+			if (!instructions.empty() && instructions.back().op == TACOp::IF && succs.size() == 2)
+			{
+				LatticeValue condition = evaluate_condition(instructions.back());
+
+				// The jump target is always the first successor
+				if (condition.state == State::BOTTOM)
+				{
+					changed |= mark_edge(block, succs[0]);
+					changed |= mark_edge(block, succs[1]);
+				}
+				else if (condition.state == State::CONST)
+					changed |= mark_edge(block, condition.value ? succs[0] : succs[1]);
+
+				continue;
+			}
+
+			for (int succ : succs)
+				changed |= mark_edge(block, succ);
+		}
+	}
+}
+
+void SCCP::substitute(TACInstruction &instruction, TACField field, bool &changed)
+{
+	std::string &operand = instruction.*field;
+
+	Symbol *symbol = gst->get_symbol(operand);
+	if (!symbol)
+		return;
+
+	LatticeValue value = get_value(operand);
+	if (value.state != State::CONST)
+		return;
+
+	// The assembler can only use 32 bit immediates (with 64 bit operations sign extending them)
+	bool fits = value.value >= INT32_MIN && value.value <= INT32_MAX;
+	if (!fits && instruction.type.get_size() <= 4 && symbol->type.get_size() <= 4)
+		fits = value.value >= 0 && value.value <= UINT32_MAX;
+
+	if (!fits)
+		return;
+
+	operand = format_int_literal(value.value, symbol->type);
+	changed = true;
+}
+
+bool SCCP::rewrite(ControlFlowGraph &cfg)
+{
+	bool changed = false;
+
+	for (auto &block : cfg.blocks)
+	{
+		if (!executable_blocks[block.id])
+			continue;
+
+		auto &instructions = block.instructions;
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			TACInstruction &instruction = instructions[i];
+
+			// Definitions of constants become a plain ASSIGN of the literal
+			auto defs = get_tac_def_fields(instruction, gst.get());
+			if (defs.size() == 1 && ssa->is_ssa_value(instruction.*defs[0]))
+			{
+				std::string name = instruction.*defs[0];
+				LatticeValue value = get_value(name);
+
+				bool is_literal_assign = instruction.op == TACOp::ASSIGN && instruction.arg2.empty() &&
+										 !gst->get_symbol(instruction.result);
+
+				if (value.state == State::CONST && !is_literal_assign)
+				{
+					Type type = gst->get_symbol(name)->type;
+					instruction = TACInstruction(TACOp::ASSIGN, name, "", format_int_literal(value.value, type), type);
+					changed = true;
+					continue;
+				}
+			}
+
+			switch (instruction.op)
+			{
+			case TACOp::ADD:
+			case TACOp::SUB:
+			case TACOp::MUL:
+			case TACOp::DIV:
+			case TACOp::MOD:
+			case TACOp::GT:
+			case TACOp::LT:
+			case TACOp::GTE:
+			case TACOp::LTE:
+			case TACOp::EQUAL:
+			case TACOp::NOT_EQUAL:
+			case TACOp::AND:
+			case TACOp::OR:
+			case TACOp::NEGATE:
+			case TACOp::COMPLEMENT:
+			case TACOp::NOT:
+			case TACOp::RETURN:
+				substitute(instruction, &TACInstruction::arg1, changed);
+				substitute(instruction, &TACInstruction::arg2, changed);
+				break;
+			case TACOp::ASSIGN:
+			case TACOp::ASSIGN_DEREF:
+				// arg2 is an index/offset which the assembler scales itself when it is a literal
+				substitute(instruction, &TACInstruction::result, changed);
+				break;
+			case TACOp::MOV_BETWEEN_REG:
+				if (instruction.result == "load")
+					substitute(instruction, &TACInstruction::arg1, changed);
+				break;
+			case TACOp::PHI:
+				for (auto &arg : instruction.phi_args)
+				{
+					LatticeValue value = gst->get_symbol(arg.second) ? get_value(arg.second) : LatticeValue();
+					if (value.state == State::CONST)
+					{
+						arg.second = format_int_literal(value.value, instruction.type);
+						changed = true;
+					}
+				}
+				break;
+			case TACOp::IF:
+			{
+				LatticeValue condition = evaluate_condition(instruction);
+				if (condition.state != State::CONST)
+				{
+					substitute(instruction, &TACInstruction::arg1, changed);
+					substitute(instruction, &TACInstruction::arg2, changed);
+					break;
+				}
+
+				if (condition.value)
+					instruction = TACInstruction(TACOp::GOTO, "", "", instruction.result);
+				else
+					instructions.erase(instructions.begin() + i);
+
+				changed = true;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+
+	return changed;
+}
+
+bool SCCP::run(ControlFlowGraph &cfg, const SSA &ssa)
+{
+	this->ssa = &ssa;
+
+	values.clear();
+	executable_blocks.assign(cfg.blocks.size(), false);
+	executable_edges.assign(cfg.blocks.size(), {});
+
+	// Anything defined within the function starts off optimistically as TOP
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+			for (auto &name : get_tac_defs(instruction, gst.get()))
+				values.emplace(name, LatticeValue());
+
+	executable_blocks[cfg.get_entry()] = true;
+	propagate(cfg);
+
+	bool changed = rewrite(cfg);
+	if (changed)
+	{
+		cfg.rebuild_edges();
+		cfg.compute_dominators();
+	}
+
+	return changed;
+}
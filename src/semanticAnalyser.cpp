@@ -5,8 +5,8 @@
 
 #define REGISTER_HANDLER(node_type, fn) handlers[node_type] = [this](ASTNode *node) { fn(node); }
 
-SemanticAnalyser::SemanticAnalyser(std::shared_ptr<GlobalSymbolTable> gst, std::string module_name)
-	: gst(gst), module_name(module_name)
+SemanticAnalyser::SemanticAnalyser(std::shared_ptr<GlobalSymbolTable> gst, std::string module_name, ASTArena &arena)
+	: gst(gst), module_name(module_name), arena(arena)
 {
 	// Initialise analysers
 	REGISTER_HANDLER(NodeType::NODE_FUNCTION, analyse_func);
@@ -28,10 +28,10 @@ SemanticAnalyser::SemanticAnalyser(std::shared_ptr<GlobalSymbolTable> gst, std::
 	REGISTER_HANDLER(NodeType::NODE_INCLUDE, analyse_include);
 }
 
-void SemanticAnalyser::analyse(std::shared_ptr<ProgramNode> &program)
+void SemanticAnalyser::analyse(ProgramNode *program)
 {
 	for (auto &decl : program->decls)
-		analyse_node(decl.get());
+		analyse_node(decl);
 }
 
 void SemanticAnalyser::analyse_func(ASTNode *node)
@@ -44,7 +44,7 @@ void SemanticAnalyser::analyse_func(ASTNode *node)
 	std::vector<Type> arg_types;
 	for (auto &param : func_node->params)
 	{
-		VarDeclNode *param_var_decl_node = dynamic_cast<VarDeclNode *>(param.get());
+		VarDeclNode *param_var_decl_node = dynamic_cast<VarDeclNode *>(param);
 		Type param_type = param_var_decl_node->var->type;
 
 		// Don't allow structs to be passed by value
@@ -64,18 +64,18 @@ void SemanticAnalyser::analyse_func(ASTNode *node)
 
 	for (auto &param : func_node->params)
 	{
-		VarDeclNode *param_decl = dynamic_cast<VarDeclNode *>(param.get());
+		VarDeclNode *param_decl = dynamic_cast<VarDeclNode *>(param);
 
 		if (param_decl->var->type.is_array() && param_decl->var->type.get_array_length() == -1)
 		{
 			param_decl->var->type = Type::make_pointer(Type(param_decl->var->type.get_base_type()));
 		}
 
-		gst->declare_var(param_decl->var.get());
+		gst->declare_var(param_decl->var);
 	}
 
 	for (auto &element : func_node->elements)
-		analyse_node(element.get());
+		analyse_node(element);
 
 	// Ensure return is present at end of function
 	if (!func_node->return_type.has_base_type(BaseType::VOID))
@@ -119,10 +119,10 @@ void SemanticAnalyser::analyse_var_decl(ASTNode *node)
 
 	if (var_decl_node->value != nullptr)
 	{
-		analyse_node(var_decl_node->value.get());
+		analyse_node(var_decl_node->value);
 
 		Type var_type = var_decl_node->var->type;
-		Type value_type = infer_type(var_decl_node->value.get());
+		Type value_type = infer_type(var_decl_node->value);
 
 		if (var_type.is_array() && var_type.has_base_type(BaseType::CHAR))
 		{
@@ -130,7 +130,7 @@ void SemanticAnalyser::analyse_var_decl(ASTNode *node)
 				error("String initialisation of " + var_decl_node->var->name + " requires string literal",
 					  var_decl_node->loc);
 
-			StringLiteral *string_literal = dynamic_cast<StringLiteral *>(var_decl_node->value.get());
+			StringLiteral *string_literal = dynamic_cast<StringLiteral *>(var_decl_node->value);
 
 			// +1 due to null terminator
 			if (string_literal->value.size() + 1 > var_type.get_size())
@@ -151,13 +151,13 @@ void SemanticAnalyser::analyse_var_decl(ASTNode *node)
 		{
 			if (var_type.has_base_type(BaseType::CHAR))
 			{
-				StringLiteral *string_literal = dynamic_cast<StringLiteral *>(var_decl_node->value.get());
+				StringLiteral *string_literal = dynamic_cast<StringLiteral *>(var_decl_node->value);
 				var_type.set_array_length(string_literal->value.size() + 1);
 				var_decl_node->var->type.set_array_length(string_literal->value.size() + 1);
 			}
 			else
 			{
-				AggregateLiteral *aggregate_literal = dynamic_cast<AggregateLiteral *>(var_decl_node->value.get());
+				AggregateLiteral *aggregate_literal = dynamic_cast<AggregateLiteral *>(var_decl_node->value);
 
 				/*
 					Set the array length based on the number of elements in the aggregate literal
@@ -175,8 +175,8 @@ void SemanticAnalyser::analyse_var_decl(ASTNode *node)
 		validate_type_assignment(var_decl_node->var->type, var_decl_node->value, var_decl_node->var->name);
 	}
 
-	gst->declare_var(var_decl_node->var.get());
-	analyse_var(var_decl_node->var.get());
+	gst->declare_var(var_decl_node->var);
+	analyse_var(var_decl_node->var);
 }
 
 void SemanticAnalyser::analyse_aggregate_literal(ASTNode *node, const Type &var_type)
@@ -196,9 +196,9 @@ void SemanticAnalyser::analyse_aggregate_literal(ASTNode *node, const Type &var_
 
 		for (auto &element : aggregate_literal->values)
 		{
-			analyse_node(element.get());
+			analyse_node(element);
 
-			if (!infer_type(element.get()).has_base_type(type_to_cmp.get_base_type()))
+			if (!infer_type(element).has_base_type(type_to_cmp.get_base_type()))
 				error("Type in array initialisation of some variable doesn't match", aggregate_literal->loc);
 		}
 	}
@@ -219,7 +219,7 @@ void SemanticAnalyser::analyse_aggregate_literal(ASTNode *node, const Type &var_
 		int i = 0;
 		for (auto &[field_name, field_type] : struct_fields)
 		{
-			analyse_node(aggregate_literal->values[i].get());
+			analyse_node(aggregate_literal->values[i]);
 			Type expected_type = field_type;
 
 			validate_type_assignment(expected_type, aggregate_literal->values[i],
@@ -233,9 +233,9 @@ void SemanticAnalyser::analyse_aggregate_literal(ASTNode *node, const Type &var_
 			This will likely be used when declaring a array within a struct
 		*/
 		for (auto &element : aggregate_literal->values)
-			analyse_node(element.get());
+			analyse_node(element);
 
-		Type arr_type = infer_type(aggregate_literal->values[0].get());
+		Type arr_type = infer_type(aggregate_literal->values[0]);
 		arr_type.add_array_dimension(aggregate_literal->values.size());
 		aggregate_literal->type = arr_type;
 	}
@@ -247,16 +247,16 @@ void SemanticAnalyser::analyse_var_assign(ASTNode *node)
 
 	if (var_assign_node->var->node_type == NodeType::NODE_VAR)
 	{
-		VarNode *var = (VarNode *)var_assign_node->var.get();
+		VarNode *var = (VarNode *)var_assign_node->var;
 		var->name = gst->check_var_defined(var->name);
 
-		analyse_node(var_assign_node->value.get());
+		analyse_node(var_assign_node->value);
 
 		Symbol *var_symbol = gst->get_symbol(var->name);
 
 		Type var_type = var_symbol->type;
 
-		Type value_type = infer_type(var_assign_node->value.get());
+		Type value_type = infer_type(var_assign_node->value);
 
 		var->type = var_type;
 
@@ -264,13 +264,13 @@ void SemanticAnalyser::analyse_var_assign(ASTNode *node)
 			error("Cannot assign to const variable '" + var->name + "'", var_assign_node->loc);
 
 		if (var_type.is_struct())
-			analyse_aggregate_literal(var_assign_node->value.get(), var_type);
+			analyse_aggregate_literal(var_assign_node->value, var_type);
 		else
 			validate_type_assignment(var_type, var_assign_node->value, var->name);
 	}
 	else if (var_assign_node->var->node_type == NodeType::NODE_ARRAY_ACCESS)
 	{
-		ArrayAccessNode *array_access = dynamic_cast<ArrayAccessNode *>(var_assign_node->var.get());
+		ArrayAccessNode *array_access = dynamic_cast<ArrayAccessNode *>(var_assign_node->var);
 
 		Symbol *symbol = gst->get_symbol(array_access->array->name);
 
@@ -284,7 +284,7 @@ void SemanticAnalyser::analyse_var_assign(ASTNode *node)
 			error("Cannot assign to const variable '" + array_access->array->name + "'", var_assign_node->loc);
 
 		infer_type(array_access);
-		Type value_type = infer_type(var_assign_node->value.get());
+		Type value_type = infer_type(var_assign_node->value);
 
 		if (symbol->type.has_base_type(BaseType::CHAR) && !symbol->type.is_pointer())
 			if (var_assign_node->value->node_type == NodeType::NODE_STRING)
@@ -300,11 +300,11 @@ void SemanticAnalyser::analyse_var_assign(ASTNode *node)
 	}
 	else if (var_assign_node->var->node_type == NodeType::NODE_POSTFIX)
 	{
-		PostfixNode *postfix = (PostfixNode *)var_assign_node->var.get();
+		PostfixNode *postfix = (PostfixNode *)var_assign_node->var;
 
 		analyse_node(postfix);
 
-		Type var_type = infer_type(var_assign_node->var.get());
+		Type var_type = infer_type(var_assign_node->var);
 
 		validate_type_assignment(var_type, var_assign_node->value, "in assignment");
 
@@ -317,13 +317,13 @@ void SemanticAnalyser::analyse_var_assign(ASTNode *node)
 	}
 	else if (var_assign_node->var->node_type == NodeType::NODE_UNARY)
 	{
-		UnaryNode *unary = dynamic_cast<UnaryNode *>(var_assign_node->var.get());
+		UnaryNode *unary = dynamic_cast<UnaryNode *>(var_assign_node->var);
 
 		if (unary->op != UnaryOpType::DEREF)
 			error("Cannot assign to this unary expression", unary->loc);
 
-		analyse_node(unary->value.get());
-		Type ptr_type = infer_type(unary->value.get());
+		analyse_node(unary->value);
+		Type ptr_type = infer_type(unary->value);
 
 		if (ptr_type.get_ptr_depth() < 1)
 			error("Cannot dereference non-pointer type", unary->loc);
@@ -358,7 +358,7 @@ void SemanticAnalyser::analyse_rtn(ASTNode *node)
 				  rtn_node->loc);
 		else
 		{
-			analyse_node(rtn_node->value.get());
+			analyse_node(rtn_node->value);
 			validate_type_assignment(expected_rtn_type, rtn_node->value, "return from '" + func->name + "'");
 		}
 	}
@@ -368,19 +368,19 @@ void SemanticAnalyser::analyse_if_stmt(ASTNode *node)
 {
 	IfNode *if_node = (IfNode *)node;
 
-	analyse_node(if_node->condition.get());
-	infer_type(if_node->condition.get());
+	analyse_node(if_node->condition);
+	infer_type(if_node->condition);
 
 	gst->enter_scope();
 	for (auto &stmt : if_node->then_elements)
-		analyse_node(stmt.get());
+		analyse_node(stmt);
 	gst->exit_scope();
 
 	if (!if_node->else_elements.empty())
 	{
 		gst->enter_scope();
 		for (auto &stmt : if_node->else_elements)
-			analyse_node(stmt.get());
+			analyse_node(stmt);
 		gst->exit_scope();
 	}
 }
@@ -388,7 +388,7 @@ void SemanticAnalyser::analyse_if_stmt(ASTNode *node)
 void SemanticAnalyser::analyse_while_stmt(ASTNode *node)
 {
 	WhileNode *while_node = (WhileNode *)node;
-	analyse_node(while_node->condition.get());
+	analyse_node(while_node->condition);
 
 	std::string label = gen_new_loop_label();
 	while_node->label = label;
@@ -397,7 +397,7 @@ void SemanticAnalyser::analyse_while_stmt(ASTNode *node)
 	gst->enter_scope();
 
 	for (auto &stmt : while_node->elements)
-		analyse_node(stmt.get());
+		analyse_node(stmt);
 
 	gst->exit_scope();
 	exit_loop_scope();
@@ -413,12 +413,12 @@ void SemanticAnalyser::analyse_for_stmt(ASTNode *node)
 	enter_loop_scope(label);
 	gst->enter_scope();
 
-	analyse_node(for_node->init.get());
-	analyse_node(for_node->condition.get());
-	analyse_node(for_node->post.get());
+	analyse_node(for_node->init);
+	analyse_node(for_node->condition);
+	analyse_node(for_node->post);
 
 	for (auto &stmt : for_node->elements)
-		analyse_node(stmt.get());
+		analyse_node(stmt);
 
 	gst->exit_scope();
 	exit_loop_scope();
@@ -427,8 +427,8 @@ void SemanticAnalyser::analyse_for_stmt(ASTNode *node)
 void SemanticAnalyser::analyse_binary(ASTNode *node)
 {
 	BinaryNode *bin_node = (BinaryNode *)node;
-	analyse_node(bin_node->left.get());
-	analyse_node(bin_node->right.get());
+	analyse_node(bin_node->left);
+	analyse_node(bin_node->right);
 
 	bin_node->type = infer_type(bin_node);
 }
@@ -437,8 +437,8 @@ void SemanticAnalyser::analyse_unary(ASTNode *node)
 {
 	UnaryNode *unary_node = (UnaryNode *)node;
 
-	analyse_node(unary_node->value.get());
-	Type expr_type = infer_type(unary_node->value.get());
+	analyse_node(unary_node->value);
+	Type expr_type = infer_type(unary_node->value);
 
 	/*
 		Only variables and unary expressions can have their address taken or be dereferenced
@@ -497,8 +497,8 @@ void SemanticAnalyser::analyse_func_call(ASTNode *node)
 	{
 		for (int i = 0; i < fc_node->args.size(); i++)
 		{
-			analyse_node(fc_node->args[i].get());
-			infer_type(fc_node->args[i].get());
+			analyse_node(fc_node->args[i]);
+			infer_type(fc_node->args[i]);
 		}
 
 		return;
@@ -516,7 +516,7 @@ void SemanticAnalyser::analyse_func_call(ASTNode *node)
 	{
 		Type param_type = func->arg_types[i];
 
-		analyse_node(fc_node->args[i].get());
+		analyse_node(fc_node->args[i]);
 		validate_type_assignment(param_type, fc_node->args[i], "in call to '" + fc_node->name + "'");
 	}
 }
@@ -541,7 +541,7 @@ void SemanticAnalyser::exit_loop_scope()
 void SemanticAnalyser::analyse_cast(ASTNode *node)
 {
 	CastNode *cast_node = (CastNode *)node;
-	Type src_type = infer_type((ASTNode *)(cast_node->expr.get()));
+	Type src_type = infer_type((ASTNode *)(cast_node->expr));
 
 	if (!src_type.can_convert_to(cast_node->target_type))
 		error("Cannot cast " + src_type.to_string() + " to " + cast_node->target_type.to_string(), cast_node->loc);
@@ -560,7 +560,7 @@ void SemanticAnalyser::analyse_struct_decl(ASTNode *node)
 
 	for (const auto &member : struct_decl_node->members)
 	{
-		VarDeclNode *member_decl = dynamic_cast<VarDeclNode *>(member.get());
+		VarDeclNode *member_decl = dynamic_cast<VarDeclNode *>(member);
 		Type member_type = member_decl->var->type;
 
 		auto duplicate_it = std::find_if(members.begin(), members.end(),
@@ -598,7 +598,7 @@ void SemanticAnalyser::analyse_postfix(ASTNode *node)
 		*/
 
 		// Infer the type of the struct member
-		Type rtn_type = infer_type(postfix_node->value.get(), postfix_node->struct_name);
+		Type rtn_type = infer_type(postfix_node->value, postfix_node->struct_name);
 
 		// Get the symbol for the struct variable
 		Symbol *symbol = gst->get_symbol(postfix_node->struct_name);
@@ -616,14 +616,14 @@ void SemanticAnalyser::analyse_postfix(ASTNode *node)
 		return;
 	}
 
-	analyse_node(postfix_node->value.get());
-	postfix_node->type = infer_type(postfix_node->value.get());
+	analyse_node(postfix_node->value);
+	postfix_node->type = infer_type(postfix_node->value);
 }
 
-void SemanticAnalyser::validate_type_assignment(Type &target_type, std::unique_ptr<ASTNode> &source_expr,
+void SemanticAnalyser::validate_type_assignment(Type &target_type, ASTNode *&source_expr,
 												const std::string &context)
 {
-	Type source_type = infer_type(source_expr.get());
+	Type source_type = infer_type(source_expr);
 
 	if (target_type == source_type)
 		return;
@@ -776,13 +776,13 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 	case NodeType::NODE_BINARY:
 	{
 		BinaryNode *bin_node = dynamic_cast<BinaryNode *>(node);
-		Type left = infer_type(bin_node->left.get());
-		Type right = infer_type(bin_node->right.get());
+		Type left = infer_type(bin_node->left);
+		Type right = infer_type(bin_node->right);
 
 		/*
 			Handle pointer artithmetic
 			-   This requires scaling the integral value by the size of the base type
-			-   e.g. ptr + 1  -> ptr + (1 * sizeof(base_type))
+			-   e.g. ptr + 1  -> ptr + (1 *sizeof(base_type))
 
 			Note only supports integral + pointer or pointer + integral
 		*/
@@ -790,13 +790,13 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 		{
 			if (left.is_pointer() && right.is_integral())
 			{
-				std::unique_ptr<BinaryNode> scale_node = std::make_unique<BinaryNode>(
-					BinOpType::MUL, std::move(bin_node->right),
-					std::make_unique<IntegerLiteral>(Type(left.get_base_type()).get_size(), bin_node->loc),
+				BinaryNode *scale_node = arena.create<BinaryNode>(
+					BinOpType::MUL, bin_node->right,
+					arena.create<IntegerLiteral>(Type(left.get_base_type()).get_size(), bin_node->loc),
 					bin_node->loc);
 
 				scale_node->type = left;
-				bin_node->right = std::move(scale_node);
+				bin_node->right = scale_node;
 				bin_node->type = left;
 				bin_node->analysed = true;
 
@@ -804,13 +804,13 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 			}
 			else if (right.is_pointer() && left.is_integral())
 			{
-				auto scale_node = std::make_unique<BinaryNode>(
-					BinOpType::MUL, std::move(bin_node->left),
-					std::make_unique<IntegerLiteral>(Type(right.get_base_type()).get_size(), bin_node->loc),
+				auto scale_node = arena.create<BinaryNode>(
+					BinOpType::MUL, bin_node->left,
+					arena.create<IntegerLiteral>(Type(right.get_base_type()).get_size(), bin_node->loc),
 					bin_node->loc);
 
 				scale_node->type = left;
-				bin_node->left = std::move(scale_node);
+				bin_node->left = scale_node;
 				bin_node->type = right;
 				bin_node->analysed = true;
 
@@ -831,15 +831,15 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 
 		if (left.can_convert_to(right))
 		{
-			auto cast_node = std::make_unique<CastNode>(std::move(bin_node->left), right);
-			bin_node->left = std::move(cast_node);
+			auto cast_node = arena.create<CastNode>(bin_node->left, right);
+			bin_node->left = cast_node;
 			bin_node->type = right;
 			return right;
 		}
 		else if (right.can_convert_to(left))
 		{
-			auto cast_node = std::make_unique<CastNode>(std::move(bin_node->right), left);
-			bin_node->right = std::move(cast_node);
+			auto cast_node = arena.create<CastNode>(bin_node->right, left);
+			bin_node->right = cast_node;
 			bin_node->type = left;
 			return left;
 		}
@@ -901,7 +901,7 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 			array_access_node->type = type;
 			array_access_node->array->type = type;
 
-			if (auto index_literal = dynamic_cast<IntegerLiteral *>(array_access_node->index.get()))
+			if (auto index_literal = dynamic_cast<IntegerLiteral *>(array_access_node->index))
 			{
 				int array_length = type.get_array_length();
 
@@ -921,7 +921,7 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 			Symbol *array_symbol = gst->get_symbol(array_access_node->array->name);
 
 			// Check if the index is a constant + in range
-			if (auto index_literal = dynamic_cast<IntegerLiteral *>(array_access_node->index.get()))
+			if (auto index_literal = dynamic_cast<IntegerLiteral *>(array_access_node->index))
 			{
 				int array_length = array_symbol->type.get_array_length();
 
@@ -934,10 +934,10 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 				}
 			}
 			else
-				analyse_node(array_access_node->index.get());
+				analyse_node(array_access_node->index);
 
-			infer_type(array_access_node->array.get());
-			infer_type(array_access_node->index.get());
+			infer_type(array_access_node->array);
+			infer_type(array_access_node->index);
 
 			array_access_node->type = array_symbol->type;
 
@@ -973,7 +973,7 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 
 		if (size_of_node->var)
 		{
-			auto var_node = (VarNode *)size_of_node->var.get();
+			auto var_node = (VarNode *)size_of_node->var;
 
 			analyse_var(var_node);
 
@@ -992,71 +992,71 @@ Type SemanticAnalyser::infer_type(ASTNode *node, std::optional<std::string> fiel
 	}
 }
 
-bool SemanticAnalyser::try_promote_literal(std::unique_ptr<ASTNode> &expr, const Type &target)
+bool SemanticAnalyser::try_promote_literal(ASTNode *&expr, const Type &target)
 {
 	switch (target.get_base_type())
 	{
 	case BaseType::DOUBLE:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
 			if (std::llabs((long long)i->value) <= (1LL << 53))
 			{
-				expr = std::make_unique<DoubleLiteral>(static_cast<double>(i->value), expr->loc);
+				expr = arena.create<DoubleLiteral>(static_cast<double>(i->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (auto *l = dynamic_cast<LongLiteral *>(expr.get()))
+		if (auto *l = dynamic_cast<LongLiteral *>(expr))
 		{
 			if (std::llabs(l->value) <= (1LL << 53))
 			{
-				expr = std::make_unique<DoubleLiteral>(static_cast<double>(l->value), expr->loc);
+				expr = arena.create<DoubleLiteral>(static_cast<double>(l->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (auto *ui = dynamic_cast<UIntegerLiteral *>(expr.get()))
+		if (auto *ui = dynamic_cast<UIntegerLiteral *>(expr))
 		{
 			if ((unsigned long long)ui->value <= (1ULL << 53))
 			{
-				expr = std::make_unique<DoubleLiteral>(static_cast<double>(ui->value), expr->loc);
+				expr = arena.create<DoubleLiteral>(static_cast<double>(ui->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (auto *ul = dynamic_cast<ULongLiteral *>(expr.get()))
+		if (auto *ul = dynamic_cast<ULongLiteral *>(expr))
 		{
 			if ((unsigned long long)ul->value <= (1ULL << 53))
 			{
-				expr = std::make_unique<DoubleLiteral>(static_cast<double>(ul->value), expr->loc);
+				expr = arena.create<DoubleLiteral>(static_cast<double>(ul->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (dynamic_cast<DoubleLiteral *>(expr.get()))
+		if (dynamic_cast<DoubleLiteral *>(expr))
 			return true;
 		break;
 	}
 
 	case BaseType::INT:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 			return true;
-		if (auto *l = dynamic_cast<LongLiteral *>(expr.get()))
+		if (auto *l = dynamic_cast<LongLiteral *>(expr))
 		{
 			if (l->value >= INT_MIN && l->value <= INT_MAX)
 			{
-				expr = std::make_unique<IntegerLiteral>(static_cast<int>(l->value), expr->loc);
+				expr = arena.create<IntegerLiteral>(static_cast<int>(l->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (auto *ui = dynamic_cast<UIntegerLiteral *>(expr.get()))
+		if (auto *ui = dynamic_cast<UIntegerLiteral *>(expr))
 		{
 			if (ui->value <= static_cast<unsigned int>(INT_MAX))
 			{
-				expr = std::make_unique<IntegerLiteral>(static_cast<int>(ui->value), expr->loc);
+				expr = arena.create<IntegerLiteral>(static_cast<int>(ui->value), expr->loc);
 				return true;
 			}
 			return false;
@@ -1066,64 +1066,64 @@ bool SemanticAnalyser::try_promote_literal(std::unique_ptr<ASTNode> &expr, const
 
 	case BaseType::LONG:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
-			expr = std::make_unique<LongLiteral>(static_cast<long>(i->value), expr->loc);
+			expr = arena.create<LongLiteral>(static_cast<long>(i->value), expr->loc);
 			return true;
 		}
-		if (dynamic_cast<LongLiteral *>(expr.get()))
+		if (dynamic_cast<LongLiteral *>(expr))
 			return true;
 		break;
 	}
 
 	case BaseType::UINT:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
 			if (i->value >= 0)
 			{
-				expr = std::make_unique<UIntegerLiteral>(static_cast<unsigned int>(i->value), expr->loc);
+				expr = arena.create<UIntegerLiteral>(static_cast<unsigned int>(i->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (dynamic_cast<UIntegerLiteral *>(expr.get()))
+		if (dynamic_cast<UIntegerLiteral *>(expr))
 			return true;
 		break;
 	}
 
 	case BaseType::ULONG:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
 			if (i->value >= 0)
 			{
-				expr = std::make_unique<ULongLiteral>(static_cast<unsigned long>(i->value), expr->loc);
+				expr = arena.create<ULongLiteral>(static_cast<unsigned long>(i->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (auto *l = dynamic_cast<LongLiteral *>(expr.get()))
+		if (auto *l = dynamic_cast<LongLiteral *>(expr))
 		{
 			if (l->value >= 0)
 			{
-				expr = std::make_unique<ULongLiteral>(static_cast<unsigned long>(l->value), expr->loc);
+				expr = arena.create<ULongLiteral>(static_cast<unsigned long>(l->value), expr->loc);
 				return true;
 			}
 			return false;
 		}
-		if (dynamic_cast<ULongLiteral *>(expr.get()))
+		if (dynamic_cast<ULongLiteral *>(expr))
 			return true;
 		break;
 	}
 
 	case BaseType::CHAR:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
 			if (i->value >= std::numeric_limits<char>::min() && i->value <= std::numeric_limits<char>::max())
 			{
-				expr = std::make_unique<CharLiteral>(static_cast<char>(i->value), Type(BaseType::CHAR), expr->loc);
+				expr = arena.create<CharLiteral>(static_cast<char>(i->value), Type(BaseType::CHAR), expr->loc);
 				return true;
 			}
 			return false;
@@ -1133,11 +1133,11 @@ bool SemanticAnalyser::try_promote_literal(std::unique_ptr<ASTNode> &expr, const
 
 	case BaseType::BOOL:
 	{
-		if (auto *i = dynamic_cast<IntegerLiteral *>(expr.get()))
+		if (auto *i = dynamic_cast<IntegerLiteral *>(expr))
 		{
 			if (i->value == 0 || i->value == 1)
 			{
-				expr = std::make_unique<BoolLiteral>(i->value != 0, expr->loc);
+				expr = arena.create<BoolLiteral>(i->value != 0, expr->loc);
 				return true;
 			}
 			return false;
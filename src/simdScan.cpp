@@ -0,0 +1,235 @@
+#include "../include/simdScan.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_SCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+struct CharRange
+{
+	unsigned char lo;
+	unsigned char hi;
+};
+
+// Classes with fewer ranges repeat one of them so every range can always be checked
+struct CharClass
+{
+	CharRange ranges[3];
+};
+
+constexpr CharClass WHITESPACE = {{{'\t', '\r'}, {' ', ' '}, {' ', ' '}}};
+constexpr CharClass ALNUM = {{{'0', '9'}, {'a', 'z'}, {'A', 'Z'}}};
+constexpr CharClass DIGITS = {{{'0', '9'}, {'0', '9'}, {'0', '9'}}};
+
+/*
+	A scan stops at the first character in the class
+	or when skipping, the first character which isn't
+*/
+using ScanKernel = size_t (*)(const char *data, size_t from, size_t length, const CharClass &char_class, bool skip);
+using CountKernel = size_t (*)(const char *data, size_t from, size_t to);
+
+bool is_in_class(unsigned char c, const CharClass &char_class)
+{
+	for (const CharRange &range : char_class.ranges)
+		if ((unsigned char)(c - range.lo) <= range.hi - range.lo)
+			return true;
+
+	return false;
+}
+
+size_t scalar_scan(const char *data, size_t from, size_t length, const CharClass &char_class, bool skip)
+{
+	while (from < length && is_in_class(data[from], char_class) == skip)
+		from++;
+	return from;
+}
+
+size_t scalar_count_newlines(const char *data, size_t from, size_t to)
+{
+	size_t count = 0;
+	for (; from < to; from++)
+		count += data[from] == '\n';
+	return count;
+}
+
+#ifdef SIMD_SCAN_X86
+
+/*
+	A character c is within [lo, hi] when c - lo (wrapping round) is at most hi - lo
+	which is checked all at once by comparing it with the unsigned minimum of the two
+*/
+size_t sse2_scan(const char *data, size_t from, size_t length, const CharClass &char_class, bool skip)
+{
+	__m128i lo[3], span[3];
+	for (int i = 0; i < 3; i++)
+	{
+		lo[i] = _mm_set1_epi8((char)char_class.ranges[i].lo);
+		span[i] = _mm_set1_epi8((char)(char_class.ranges[i].hi - char_class.ranges[i].lo));
+	}
+
+	unsigned flip = skip ? 0xFFFF : 0;
+
+	for (; from + 16 <= length; from += 16)
+	{
+		__m128i chars = _mm_loadu_si128((const __m128i *)(data + from));
+		__m128i in_class = _mm_setzero_si128();
+
+		for (int i = 0; i < 3; i++)
+		{
+			__m128i offset = _mm_sub_epi8(chars, lo[i]);
+			in_class = _mm_or_si128(in_class, _mm_cmpeq_epi8(_mm_min_epu8(offset, span[i]), offset));
+		}
+
+		unsigned mask = (unsigned)_mm_movemask_epi8(in_class) ^ flip;
+		if (mask)
+			return from + __builtin_ctz(mask);
+	}
+
+	return scalar_scan(data, from, length, char_class, skip);
+}
+
+size_t sse2_count_newlines(const char *data, size_t from, size_t to)
+{
+	const __m128i newline = _mm_set1_epi8('\n');
+	size_t count = 0;
+
+	while (from + 16 <= to)
+	{
+		// Each byte counts the newlines in its lane (so can only do 255 blocks before it has to be added up)
+		__m128i counts = _mm_setzero_si128();
+		for (int i = 0; i < 255 && from + 16 <= to; i++, from += 16)
+			counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + from)), newline));
+
+		__m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+		count += _mm_cvtsi128_si64(sums) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+	}
+
+	return count + scalar_count_newlines(data, from, to);
+}
+
+/*
+	The same as the SSE2 kernels but 32 characters at a time
+	Most runs (whitespace between tokens, identifiers) are too short for even one block so go straight to SSE2
+	The upper halves of the registers are cleared before going on to SSE2
+	(otherwise every SSE2 instruction after pays for mixing the two)
+*/
+__attribute__((target("avx2"))) size_t avx2_scan(const char *data, size_t from, size_t length,
+												 const CharClass &char_class, bool skip)
+{
+	if (from + 32 > length)
+		return sse2_scan(data, from, length, char_class, skip);
+
+	__m256i lo[3], span[3];
+	for (int i = 0; i < 3; i++)
+	{
+		lo[i] = _mm256_set1_epi8((char)char_class.ranges[i].lo);
+		span[i] = _mm256_set1_epi8((char)(char_class.ranges[i].hi - char_class.ranges[i].lo));
+	}
+
+	unsigned flip = skip ? 0xFFFFFFFF : 0;
+
+	for (; from + 32 <= length; from += 32)
+	{
+		__m256i chars = _mm256_loadu_si256((const __m256i *)(data + from));
+		__m256i in_class = _mm256_setzero_si256();
+
+		for (int i = 0; i < 3; i++)
+		{
+			__m256i offset = _mm256_sub_epi8(chars, lo[i]);
+			in_class = _mm256_or_si256(in_class, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span[i]), offset));
+		}
+
+		unsigned mask = (unsigned)_mm256_movemask_epi8(in_class) ^ flip;
+		if (mask)
+			return from + __builtin_ctz(mask);
+	}
+
+	_mm256_zeroupper();
+	return sse2_scan(data, from, length, char_class, skip);
+}
+
+__attribute__((target("avx2"))) size_t avx2_count_newlines(const char *data, size_t from, size_t to)
+{
+	if (from + 32 > to)
+		return sse2_count_newlines(data, from, to);
+
+	const __m256i newline = _mm256_set1_epi8('\n');
+	size_t count = 0;
+
+	while (from + 32 <= to)
+	{
+		__m256i counts = _mm256_setzero_si256();
+		for (int i = 0; i < 255 && from + 32 <= to; i++, from += 32)
+			counts = _mm256_sub_epi8(counts,
+									 _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + from)), newline));
+
+		__m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+		__m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+		count += _mm_cvtsi128_si64(halves) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(halves, halves));
+	}
+
+	_mm256_zeroupper();
+	return count + sse2_count_newlines(data, from, to);
+}
+
+#endif
+
+struct Kernels
+{
+	ScanKernel scan;
+	CountKernel count_newlines;
+};
+
+const Kernels &get_kernels()
+{
+	static const Kernels kernels = []
+	{
+#ifdef SIMD_SCAN_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return Kernels{avx2_scan, avx2_count_newlines};
+		return Kernels{sse2_scan, sse2_count_newlines};
+#else
+		return Kernels{scalar_scan, scalar_count_newlines};
+#endif
+	}();
+
+	return kernels;
+}
+
+} // namespace
+
+size_t skip_whitespace(std::string_view text, size_t from)
+{
+	return get_kernels().scan(text.data(), from, text.length(), WHITESPACE, true);
+}
+
+size_t skip_alnum(std::string_view text, size_t from)
+{
+	return get_kernels().scan(text.data(), from, text.length(), ALNUM, true);
+}
+
+size_t skip_digits(std::string_view text, size_t from)
+{
+	return get_kernels().scan(text.data(), from, text.length(), DIGITS, true);
+}
+
+size_t find_char(std::string_view text, size_t from, char c)
+{
+	unsigned char u = c;
+	return get_kernels().scan(text.data(), from, text.length(), CharClass{{{u, u}, {u, u}, {u, u}}}, false);
+}
+
+size_t find_either_char(std::string_view text, size_t from, char a, char b)
+{
+	unsigned char u = a, v = b;
+	return get_kernels().scan(text.data(), from, text.length(), CharClass{{{u, u}, {v, v}, {v, v}}}, false);
+}
+
+size_t count_newlines(std::string_view text, size_t from, size_t to)
+{
+	return get_kernels().count_newlines(text.data(), from, to);
+}
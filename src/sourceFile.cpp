@@ -0,0 +1,53 @@
+#include "../include/sourceFile.h"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::~SourceFile()
+{
+	close();
+}
+
+void SourceFile::open(const std::string &path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	struct stat info;
+
+	if (fd < 0 || fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+	{
+		if (fd >= 0)
+			::close(fd);
+		throw std::runtime_error("File Error: Error opening file: " + path);
+	}
+
+	// Nothing can be mapped for an empty file (which is left empty for the caller to report)
+	if (info.st_size > 0)
+	{
+		void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			::close(fd);
+			throw std::runtime_error("File Error: Error mapping file: " + path);
+		}
+
+		data = static_cast<const char *>(mapping);
+		size = info.st_size;
+	}
+
+	// The mapping stays valid once the file is closed
+	::close(fd);
+}
+
+void SourceFile::close()
+{
+	if (data)
+		munmap(const_cast<char *>(data), size);
+
+	data = nullptr;
+	size = 0;
+}
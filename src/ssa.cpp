@@ -0,0 +1,269 @@
+#include "../include/ssa.h"
+
+#include <algorithm>
+
+#include "../include/liveness.h"
+
+SSA::SSA(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+bool SSA::is_ssa_value(const std::string &name) const
+{
+	return ssa_values.count(name) > 0;
+}
+
+void SSA::construct(ControlFlowGraph &cfg)
+{
+	promoted.clear();
+	ssa_values.clear();
+	versions.clear();
+	stacks.clear();
+
+	cfg.compute_dominators();
+
+	find_promotable(cfg);
+	insert_phis(cfg);
+	rename(cfg, cfg.get_entry());
+}
+
+void SSA::find_promotable(const ControlFlowGraph &cfg)
+{
+	std::unordered_set<std::string> address_taken;
+	std::unordered_map<std::string, int> def_counts;
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			if (instruction.op == TACOp::ADDR_OF)
+				address_taken.insert(instruction.arg1);
+
+			for (auto &name : get_tac_uses(instruction, gst.get()))
+				def_counts.emplace(name, 0);
+			for (auto &name : get_tac_defs(instruction, gst.get()))
+				def_counts[name]++;
+		}
+
+	for (auto &[name, count] : def_counts)
+	{
+		Symbol *symbol = gst->get_symbol(name);
+
+		if (address_taken.count(name) || is_aggregate(symbol->type))
+			continue;
+
+		// Char pointers are loaded by address (see Assembler::emit_load) so copying them isn't safe
+		if (symbol->type.has_base_type(BaseType::CHAR) && symbol->type.is_pointer())
+			continue;
+
+		ssa_values.insert(name);
+		if (count > 1)
+			promoted.insert(name);
+	}
+}
+
+std::vector<std::unordered_set<std::string>> SSA::compute_live_in(const ControlFlowGraph &cfg)
+{
+	size_t count = cfg.blocks.size();
+	std::vector<std::unordered_set<std::string>> uses(count), defs(count), live_in(count);
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			for (auto &name : get_tac_uses(instruction, gst.get()))
+				if (promoted.count(name) && !defs[block.id].count(name))
+					uses[block.id].insert(name);
+
+			for (auto &name : get_tac_defs(instruction, gst.get()))
+				if (promoted.count(name))
+					defs[block.id].insert(name);
+		}
+
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		for (size_t n = count; n-- > 0;)
+		{
+			std::unordered_set<std::string> in = uses[n];
+			for (int succ : cfg.blocks[n].succs)
+				for (auto &name : live_in[succ])
+					if (!defs[n].count(name))
+						in.insert(name);
+
+			if (in.size() != live_in[n].size())
+			{
+				live_in[n] = std::move(in);
+				changed = true;
+			}
+		}
+	}
+
+	return live_in;
+}
+
+void SSA::insert_phis(ControlFlowGraph &cfg)
+{
+	auto live_in = compute_live_in(cfg);
+
+	std::unordered_map<std::string, std::vector<int>> def_blocks;
+	for (auto &block : cfg.blocks)
+	{
+		if (!cfg.is_reachable(block.id))
+			continue;
+
+		for (auto &instruction : block.instructions)
+			for (auto &name : get_tac_defs(instruction, gst.get()))
+				if (promoted.count(name))
+					def_blocks[name].push_back(block.id);
+	}
+
+	for (auto &[name, blocks] : def_blocks)
+	{
+		std::vector<bool> has_phi(cfg.blocks.size(), false);
+		std::vector<bool> queued(cfg.blocks.size(), false);
+		std::vector<int> worklist = blocks;
+
+		for (int block : blocks)
+			queued[block] = true;
+
+		while (!worklist.empty())
+		{
+			int block = worklist.back();
+			worklist.pop_back();
+
+			for (int frontier : cfg.get_dominance_frontier(block))
+			{
+				if (has_phi[frontier] || !live_in[frontier].count(name))
+					continue;
+
+				has_phi[frontier] = true;
+
+				// The PHI remembers which variable it merges in arg1
+				TACInstruction phi(TACOp::PHI, name, "", name, gst->get_symbol(name)->type);
+				for (int pred : cfg.blocks[frontier].preds)
+					if (cfg.is_reachable(pred))
+						phi.phi_args.emplace_back(pred, name);
+
+				auto &instructions = cfg.blocks[frontier].instructions;
+				auto pos = instructions.begin();
+				if (pos != instructions.end() && pos->op == TACOp::LABEL)
+					pos++;
+				instructions.insert(pos, phi);
+
+				if (!queued[frontier])
+				{
+					queued[frontier] = true;
+					worklist.push_back(frontier);
+				}
+			}
+		}
+	}
+}
+
+std::string SSA::new_version(const std::string &name)
+{
+	std::string version = name + "." + std::to_string(++versions[name]);
+	gst->declare_temp_var(version, gst->get_symbol(name)->type);
+
+	stacks[name].push_back(version);
+	ssa_values.insert(version);
+
+	return version;
+}
+
+std::string SSA::new_value(const std::string &name, const Type &type)
+{
+	std::string value = name + "." + std::to_string(++versions[name]);
+	gst->declare_temp_var(value, type);
+
+	ssa_values.insert(value);
+
+	return value;
+}
+
+const std::string &SSA::current_version(const std::string &name)
+{
+	auto &stack = stacks[name];
+
+	// Read before any definition (the original variable is never written so is left undefined)
+	return stack.empty() ? name : stack.back();
+}
+
+void SSA::rename(ControlFlowGraph &cfg, int block)
+{
+	std::vector<std::string> pushed;
+
+	for (auto &instruction : cfg.blocks[block].instructions)
+	{
+		if (instruction.op == TACOp::PHI)
+		{
+			instruction.result = new_version(instruction.arg1);
+			pushed.push_back(instruction.arg1);
+			continue;
+		}
+
+		auto use_fields = get_tac_use_fields(instruction, gst.get());
+		auto def_fields = get_tac_def_fields(instruction, gst.get());
+
+		for (TACField field : use_fields)
+			if (promoted.count(instruction.*field))
+				instruction.*field = current_version(instruction.*field);
+
+		for (TACField field : def_fields)
+		{
+			std::string name = instruction.*field;
+			if (!promoted.count(name))
+				continue;
+
+			instruction.*field = new_version(name);
+			pushed.push_back(name);
+		}
+	}
+
+	for (int succ : cfg.blocks[block].succs)
+		for (auto &instruction : cfg.blocks[succ].instructions)
+		{
+			if (instruction.op != TACOp::PHI)
+				continue;
+
+			for (auto &[pred, value] : instruction.phi_args)
+				if (pred == block)
+					value = current_version(instruction.arg1);
+		}
+
+	for (int child : cfg.get_dom_children(block))
+		rename(cfg, child);
+
+	for (auto &name : pushed)
+		stacks[name].pop_back();
+}
+
+void SSA::destruct(ControlFlowGraph &cfg)
+{
+	// Copies are inserted afterwards as a block may be its own predecessor
+	std::vector<std::pair<int, TACInstruction>> copies;
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			if (instruction.op != TACOp::PHI)
+				continue;
+
+			std::string copy = "phi." + std::to_string(copy_count++);
+			gst->declare_temp_var(copy, instruction.type);
+
+			for (auto &[pred, value] : instruction.phi_args)
+				copies.emplace_back(pred, TACInstruction(TACOp::ASSIGN, copy, "", value, instruction.type));
+
+			instruction = TACInstruction(TACOp::ASSIGN, instruction.result, "", copy, instruction.type);
+		}
+
+	for (auto &[pred, copy] : copies)
+	{
+		auto &instructions = cfg.blocks[pred].instructions;
+		auto pos = instructions.end();
+		if (!instructions.empty() && ControlFlowGraph::is_terminator(instructions.back()))
+			pos--;
+
+		instructions.insert(pos, copy);
+	}
+}
@@ -0,0 +1,287 @@
+#include "../include/strengthReduction.h"
+
+#include <climits>
+#include <map>
+
+#include "../include/sccp.h"
+
+StrengthReduction::StrengthReduction(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+static bool get_literal(GlobalSymbolTable *gst, const std::string &operand, const Type &type, long long &value)
+{
+	if (gst->get_symbol(operand) || !parse_int_literal(operand, value))
+		return false;
+
+	value = normalise_int(value, type);
+	return true;
+}
+
+static bool fits_imm32(long long value)
+{
+	return value >= INT_MIN && value <= INT_MAX;
+}
+
+std::vector<StrengthReduction::InductionVariable> StrengthReduction::find_induction_variables(
+	const ControlFlowGraph &cfg, const Loop &loop, int preheader)
+{
+	std::vector<InductionVariable> ivs;
+
+	if (loop.latches.size() != 1)
+		return ivs;
+
+	int latch = loop.latches[0];
+
+	for (auto &phi : cfg.blocks[loop.header].instructions)
+	{
+		if (phi.op != TACOp::PHI || phi.phi_args.size() != 2)
+			continue;
+
+		const Type &type = phi.type;
+		if (!type.is_integral() || type.is_pointer() || type.is_array() ||
+			(type.get_size() != 4 && type.get_size() != 8))
+			continue;
+
+		InductionVariable iv = {phi.result, "", "", 0, type};
+		for (auto &[pred, value] : phi.phi_args)
+		{
+			if (pred == latch)
+				iv.next = value;
+			else if (pred == preheader)
+				iv.init = value;
+		}
+
+		if (iv.init.empty() || iv.next.empty())
+			continue;
+
+		// The value going round the back edge must be i + c (or i - c)
+		bool is_stepped = false;
+		for (int block : loop.blocks)
+			for (auto &instruction : cfg.blocks[block].instructions)
+			{
+				if (instruction.result != iv.next || (instruction.op != TACOp::ADD && instruction.op != TACOp::SUB) ||
+					!(instruction.type == type))
+					continue;
+
+				long long step;
+				if (instruction.arg1 == iv.phi && get_literal(gst.get(), instruction.arg2, type, step))
+					iv.step = instruction.op == TACOp::ADD ? step : -step;
+				else if (instruction.op == TACOp::ADD && instruction.arg2 == iv.phi &&
+						 get_literal(gst.get(), instruction.arg1, type, step))
+					iv.step = step;
+				else
+					continue;
+
+				is_stepped = true;
+			}
+
+		if (is_stepped)
+			ivs.push_back(iv);
+	}
+
+	return ivs;
+}
+
+bool StrengthReduction::find_multiply(const ControlFlowGraph &cfg, const Loop &loop, const InductionVariable &iv,
+									  int &block, size_t &index, long long &factor)
+{
+	for (int b : loop.blocks)
+	{
+		auto &instructions = cfg.blocks[b].instructions;
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			const TACInstruction &instruction = instructions[i];
+			if (instruction.op != TACOp::MUL || !(instruction.type == iv.type) ||
+				!ssa->is_ssa_value(instruction.result))
+				continue;
+
+			if ((instruction.arg1 == iv.phi && get_literal(gst.get(), instruction.arg2, iv.type, factor)) ||
+				(instruction.arg2 == iv.phi && get_literal(gst.get(), instruction.arg1, iv.type, factor)))
+			{
+				// Scaling an index by 1, 2, 4 or 8 is free once folded into the address (see AddressFolding)
+				if ((factor == 1 || factor == 2 || factor == 4 || factor == 8) &&
+					is_only_index(cfg, instruction.result))
+					continue;
+
+				block = b;
+				index = i;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool StrengthReduction::is_only_index(const ControlFlowGraph &cfg, const std::string &name) const
+{
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			for (auto &[pred, value] : instruction.phi_args)
+				if (value == name)
+					return false;
+
+			for (TACField field : get_tac_use_fields(instruction, gst.get()))
+				if (instruction.*field == name && !(instruction.op == TACOp::ASSIGN && field == &TACInstruction::arg2))
+					return false;
+		}
+
+	return true;
+}
+
+void StrengthReduction::replace_uses(ControlFlowGraph &cfg, const std::string &from, const std::string &to)
+{
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+		{
+			for (TACField field : get_tac_use_fields(instruction, gst.get()))
+				if (instruction.*field == from)
+					instruction.*field = to;
+
+			for (auto &[pred, value] : instruction.phi_args)
+				if (value == from)
+					value = to;
+		}
+}
+
+bool StrengthReduction::reduce(ControlFlowGraph &cfg, const std::string &header_label)
+{
+	auto find_loop = [&](Loop &loop)
+	{
+		for (auto &candidate : cfg.find_loops())
+			if (cfg.blocks[candidate.header].label == header_label)
+			{
+				loop = candidate;
+				return true;
+			}
+
+		return false;
+	};
+
+	auto find_outside_pred = [&](const Loop &loop)
+	{
+		for (int pred : cfg.blocks[loop.header].preds)
+			if (!loop.contains(pred))
+				return pred;
+
+		return -1;
+	};
+
+	Loop loop;
+	if (!find_loop(loop))
+		return false;
+
+	// Only bother with a preheader if there is something to reduce
+	bool has_multiply = false;
+	for (auto &iv : find_induction_variables(cfg, loop, find_outside_pred(loop)))
+	{
+		int block;
+		size_t index;
+		long long factor;
+		has_multiply |= find_multiply(cfg, loop, iv, block, index, factor);
+	}
+
+	if (!has_multiply)
+		return false;
+
+	int preheader = cfg.get_preheader(loop);
+	if (preheader < 0 || !find_loop(loop))
+		return false;
+
+	int latch = loop.latches[0];
+	bool changed = false;
+
+	for (auto &iv : find_induction_variables(cfg, loop, preheader))
+	{
+		// Multiplies by the same factor share one new induction variable
+		std::map<long long, std::string> reduced;
+
+		int block;
+		size_t index;
+		long long factor;
+
+		while (find_multiply(cfg, loop, iv, block, index, factor))
+		{
+			std::string product = cfg.blocks[block].instructions[index].result;
+			long long step = normalise_int(iv.step * factor, iv.type);
+
+			auto it = reduced.find(factor);
+			if (it == reduced.end())
+			{
+				if (!fits_imm32(step))
+					break;
+
+				std::string start;
+				long long init;
+				if (get_literal(gst.get(), iv.init, iv.type, init) &&
+					fits_imm32(normalise_int(init * factor, iv.type)))
+					start = format_int_literal(normalise_int(init * factor, iv.type), iv.type);
+				else
+				{
+					start = ssa->new_value("iv", iv.type);
+
+					auto &instructions = cfg.blocks[preheader].instructions;
+					auto pos = instructions.end();
+					if (!instructions.empty() && ControlFlowGraph::is_terminator(instructions.back()))
+						pos--;
+
+					instructions.insert(pos, TACInstruction(TACOp::MUL, iv.init, std::to_string(factor), start,
+															iv.type));
+				}
+
+				std::string value = ssa->new_value("iv", iv.type);
+				std::string next = ssa->new_value("iv", iv.type);
+
+				TACInstruction phi(TACOp::PHI, value, "", value, iv.type);
+				phi.phi_args = {{preheader, start}, {latch, next}};
+
+				auto &header = cfg.blocks[loop.header].instructions;
+				header.insert(header.begin() + (header.front().op == TACOp::LABEL ? 1 : 0), phi);
+
+				// Stepped alongside the original
+				for (int b : loop.blocks)
+				{
+					auto &instructions = cfg.blocks[b].instructions;
+					for (auto pos = instructions.begin(); pos != instructions.end(); pos++)
+						if (pos->op != TACOp::PHI && pos->result == iv.next)
+						{
+							instructions.insert(pos + 1, TACInstruction(TACOp::ADD, value, std::to_string(step),
+																		next, iv.type));
+							break;
+						}
+				}
+
+				it = reduced.emplace(factor, value).first;
+
+				// The header may have just moved the multiply
+				if (!find_multiply(cfg, loop, iv, block, index, factor))
+					break;
+			}
+
+			cfg.blocks[block].instructions.erase(cfg.blocks[block].instructions.begin() + index);
+			replace_uses(cfg, product, it->second);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+bool StrengthReduction::run(ControlFlowGraph &cfg, SSA &ssa)
+{
+	this->ssa = &ssa;
+
+	bool changed = false;
+
+	cfg.compute_dominators();
+
+	std::vector<std::string> header_labels;
+	for (auto &loop : cfg.find_loops())
+		if (!cfg.blocks[loop.header].label.empty())
+			header_labels.push_back(cfg.blocks[loop.header].label);
+
+	for (auto &label : header_labels)
+		changed |= reduce(cfg, label);
+
+	return changed;
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ios>
+#include <algorithm>
 
 Symbol::Symbol(std::string n, int o, Type t, std::vector<Specifier> s) : name(n), stack_offset(o), type(t), specifiers(s) {}
 
@@ -92,6 +93,17 @@ Symbol *SymbolTable::get_symbol(const std::string &name)
     return it != var_symbols.end() ? it->second.get() : nullptr;
 }
 
+void SymbolTable::add_saved_reg(const std::string &reg)
+{
+    if (std::find(saved_regs.begin(), saved_regs.end(), reg) == saved_regs.end())
+        saved_regs.push_back(reg);
+}
+
+const std::vector<std::string> &SymbolTable::get_saved_regs() const
+{
+    return saved_regs;
+}
+
 void SymbolTable::declare_temp_var(const std::string &name, const Type &type)
 {
     adjust_stack(type);
@@ -134,7 +146,8 @@ void SymbolTable::print()
                       << " | offset: " << std::setw(5) << symbol->stack_offset
                       << " | temp: " << std::setw(5) << (symbol->is_temporary ? "yes" : "no")
                       << " | type: " << std::setw(5) << symbol->type.to_string()
-                      << " | size: " << symbol->type.get_size() << '\n';
+                      << " | size: " << symbol->type.get_size()
+                      << (symbol->reg.empty() ? "" : " | reg: " + symbol->reg) << '\n';
         }
     }
     catch (const std::exception &e)
@@ -149,6 +162,11 @@ int SymbolTable::get_stack_size()
     return align_to(stack_size, DEFAULT_ALIGNMENT);
 }
 
+void SymbolTable::set_stack_size(int size)
+{
+    stack_size = size;
+}
+
 void SymbolTable::adjust_stack(const Type &type)
 {
     stack_size = align_to(stack_size, type.get_size());
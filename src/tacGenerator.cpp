@@ -106,10 +106,10 @@ std::string TacGenerator::gen_new_const_label()
 	return ".L" + std::string("const_") + std::to_string(constCounter++);
 }
 
-void TacGenerator::generate_all_tac(std::shared_ptr<ProgramNode> &program)
+void TacGenerator::generate_all_tac(ProgramNode *program)
 {
 	for (auto &decl : program->decls)
-		generate_tac(decl.get());
+		generate_tac(decl);
 
 	instructions.insert(instructions.begin(), TACInstruction(TACOp::ENTER_TEXT));
 
@@ -190,7 +190,7 @@ void TacGenerator::generate_tac_func(ASTNode *element)
 	}
 
 	for (auto &element : func->elements)
-		generate_tac(element.get());
+		generate_tac(element);
 
 	instructions.emplace_back(TACOp::FUNC_END);
 
@@ -204,7 +204,7 @@ void TacGenerator::generate_tac_rtn(ASTNode *element)
 	std::string result = "";
 
 	if (rtn->value != nullptr)
-		result = generate_tac_expr(rtn->value.get());
+		result = generate_tac_expr(rtn->value);
 
 	instructions.emplace_back(TACOp::RETURN, result, "", "", func->return_type);
 }
@@ -224,9 +224,9 @@ void TacGenerator::generate_tac_var_decl(ASTNode *element)
 		Note: char arrays (i.e. strings) are handled differently
 	*/
 	if (var_decl->var->type.is_array() && var_decl->value != nullptr)
-		return generate_tac_var_array_assign(var_decl->var.get(), var_symbol, var_decl->value.get());
+		return generate_tac_var_array_assign(var_decl->var, var_symbol, var_decl->value);
 
-	std::string result = generate_tac_expr(var_decl->value.get());
+	std::string result = generate_tac_expr(var_decl->value);
 
 	TACInstruction instruction(TACOp::ASSIGN, var_decl->var->name, "", result, var_symbol->type);
 
@@ -240,7 +240,7 @@ void TacGenerator::generate_tac_var_decl(ASTNode *element)
 		if (var_decl->value)
 		{
 			if (var_decl->var->type.is_struct())
-				return generate_tac_struct_assign(var_decl->var.get(), var_decl->value.get(), "data");
+				return generate_tac_struct_assign(var_decl->var, var_decl->value, "data");
 
 			data_vars.emplace_back(instruction);
 		}
@@ -259,7 +259,7 @@ void TacGenerator::generate_tac_var_decl(ASTNode *element)
 		return;
 
 	if (var_decl->var->type.is_struct() && !var_decl->var->type.is_pointer())
-		return generate_tac_struct_assign(var_decl->var.get(), var_decl->value.get());
+		return generate_tac_struct_assign(var_decl->var, var_decl->value);
 
 	instructions.emplace_back(instruction);
 }
@@ -278,24 +278,24 @@ void TacGenerator::generate_tac_var_assign(ASTNode *element)
 	VarAssignNode *var_assign = (VarAssignNode *)element;
 	if (var_assign->var->node_type == NodeType::NODE_VAR)
 	{
-		VarNode *var = (VarNode *)var_assign->var.get();
+		VarNode *var = (VarNode *)var_assign->var;
 		Symbol *var_symbol = gst->get_symbol(var->name);
 
 		if (var->type.is_array())
-			return generate_tac_var_array_assign(var, var_symbol, var_assign->value.get());
+			return generate_tac_var_array_assign(var, var_symbol, var_assign->value);
 
 		if (var->type.is_struct())
-			return generate_tac_struct_assign(var, var_assign->value.get());
+			return generate_tac_struct_assign(var, var_assign->value);
 
-		std::string result = generate_tac_expr(var_assign->value.get());
+		std::string result = generate_tac_expr(var_assign->value);
 		instructions.emplace_back(TACOp::ASSIGN, var->name, "", result, var_symbol->type);
 	}
 	else if (var_assign->var->node_type == NodeType::NODE_ARRAY_ACCESS)
 	{
-		ArrayAccessNode *array_access = (ArrayAccessNode *)var_assign->var.get();
+		ArrayAccessNode *array_access = (ArrayAccessNode *)var_assign->var;
 
-		std::string result = generate_tac_expr(var_assign->value.get());
-		std::string index = generate_tac_expr(array_access->index.get());
+		std::string result = generate_tac_expr(var_assign->value);
+		std::string index = generate_tac_expr(array_access->index);
 
 		std::string scaled_index = index;
 
@@ -312,7 +312,7 @@ void TacGenerator::generate_tac_var_assign(ASTNode *element)
 				std::to_string(element_type.get_size()),
 				index,
 				scale_temp,
-				element_type);
+				Type(BaseType::INT));
 
 			scaled_index = scale_temp;
 		}
@@ -321,30 +321,30 @@ void TacGenerator::generate_tac_var_assign(ASTNode *element)
 	}
 	else if (var_assign->var->node_type == NodeType::NODE_POSTFIX)
 	{
-		PostfixNode *postfix = dynamic_cast<PostfixNode *>(var_assign->var.get());
+		PostfixNode *postfix = dynamic_cast<PostfixNode *>(var_assign->var);
 
 		if (!(postfix->op == TokenType::TOKEN_DOT || postfix->op == TokenType::TOKEN_ARROW))
 			error("Cannot assign to this postfix expression", postfix->loc);
 
-		std::string result = generate_tac_expr(var_assign->value.get());
+		std::string result = generate_tac_expr(var_assign->value);
 
 		auto [struct_base, final_offset] = compute_struct_access_offset(postfix);
 
 		if (postfix->op == TokenType::TOKEN_DOT)
 			instructions.emplace_back(TACOp::ASSIGN, struct_base, final_offset, result,
-									  sem_analyser->infer_type(var_assign->value.get()));
+									  sem_analyser->infer_type(var_assign->value));
 		else if (postfix->op == TokenType::TOKEN_ARROW)
 			instructions.emplace_back(TACOp::ASSIGN_DEREF, struct_base, final_offset, result, postfix->type);
 	}
 	else if (var_assign->var->node_type == NodeType::NODE_UNARY)
 	{
-		UnaryNode *unary = dynamic_cast<UnaryNode *>(var_assign->var.get());
+		UnaryNode *unary = dynamic_cast<UnaryNode *>(var_assign->var);
 
 		if (unary->op != UnaryOpType::DEREF)
 			error("Cannot assign to this unary expression", unary->loc);
 
-		std::string var = generate_tac_expr(unary->value.get());
-		std::string result = generate_tac_expr(var_assign->value.get());
+		std::string var = generate_tac_expr(unary->value);
+		std::string result = generate_tac_expr(var_assign->value);
 
 		instructions.emplace_back(TACOp::ASSIGN_DEREF, var, "", result, unary->type);
 	}
@@ -356,23 +356,14 @@ void TacGenerator::generate_tac_if(ASTNode *element)
 {
 	IfNode *if_stmt = (IfNode *)element;
 
-	std::string label_success = gen_new_label();
 	std::string label_failure = gen_new_label();
 
-	// Generate TAC comparison code
-	generate_tac_cmp(if_stmt->condition.get(), label_success, label_failure);
-
-	/*
-		Previous TAC will jump to "then block" if condition is true
-		If condition is false, jump to "else block"/next bit of code if not
-	   present
-	*/
-	instructions.emplace_back(TACOp::GOTO, "", "", label_failure);
+	// Jump to the "else block"/next bit of code if the condition is false, otherwise fall into the "then block"
+	generate_tac_cmp(if_stmt->condition, label_failure, false);
 
 	// Then block
-	instructions.emplace_back(TACOp::LABEL, label_success);
 	for (auto &element : if_stmt->then_elements)
-		generate_tac(element.get());
+		generate_tac(element);
 
 	if (if_stmt->else_elements.empty())
 	{
@@ -391,7 +382,7 @@ void TacGenerator::generate_tac_if(ASTNode *element)
 		// Else block
 		instructions.emplace_back(TACOp::LABEL, label_failure);
 		for (auto &element : if_stmt->else_elements)
-			generate_tac(element.get());
+			generate_tac(element);
 
 		// End of entire "if block"
 		instructions.emplace_back(TACOp::LABEL, label_else_end);
@@ -408,19 +399,13 @@ void TacGenerator::generate_tac_while(ASTNode *element)
 
 	instructions.emplace_back(TACOp::LABEL, label_start);
 
-	// Generate CMP
-	generate_tac_cmp(while_stmt->condition.get(), label_body, label_end);
-
-	/*
-		Previous TAC will jump to "while block" if condition is true
-		If condition is false, jump to end of while
-	*/
-	instructions.emplace_back(TACOp::GOTO, "", "", label_end);
+	// Jump to the end of the while if the condition is false, otherwise fall into the "while block"
+	generate_tac_cmp(while_stmt->condition, label_end, false);
 
 	// While block
 	instructions.emplace_back(TACOp::LABEL, label_body);
 	for (auto &element : while_stmt->elements)
-		generate_tac(element.get());
+		generate_tac(element);
 
 	// Go back to start of while loop (to check condition)
 	instructions.emplace_back(TACOp::GOTO, "", "", label_start);
@@ -433,7 +418,7 @@ void TacGenerator::generate_tac_for(ASTNode *element)
 {
 	ForNode *for_stmt = (ForNode *)element;
 
-	generate_tac(for_stmt->init.get());
+	generate_tac(for_stmt->init);
 
 	std::string label_start = for_stmt->label + "_start";
 	std::string label_body = for_stmt->label + "_body";
@@ -442,23 +427,18 @@ void TacGenerator::generate_tac_for(ASTNode *element)
 
 	instructions.emplace_back(TACOp::LABEL, label_start);
 
-	generate_tac_cmp(for_stmt->condition.get(), label_body, label_end);
-
-	/*
-		Previous TAC will jump to "while block" if condition is true
-		If condition is false, jump to end of while
-	*/
-	instructions.emplace_back(TACOp::GOTO, "", "", label_end);
+	// Jump to the end of the for if the condition is false, otherwise fall into the "for block"
+	generate_tac_cmp(for_stmt->condition, label_end, false);
 
 	// For block
 	instructions.emplace_back(TACOp::LABEL, label_body);
 
 	for (auto &element : for_stmt->elements)
-		generate_tac(element.get());
+		generate_tac(element);
 
 	// Generate post-expression (i.e. increment/decrement)
 	instructions.emplace_back(TACOp::LABEL, label_post);
-	generate_tac(for_stmt->post.get());
+	generate_tac(for_stmt->post);
 
 	// Go back to start of for loop (to check condition)
 	instructions.emplace_back(TACOp::GOTO, "", "", label_start);
@@ -480,7 +460,7 @@ void TacGenerator::generate_tac_postfix(ASTNode *element)
 {
 	PostfixNode *postfix = (PostfixNode *)element;
 
-	std::string result = generate_tac_expr(postfix->value.get());
+	std::string result = generate_tac_expr(postfix->value);
 
 	if (postfix->op == TokenType::TOKEN_INCREMENT)
 		instructions.emplace_back(TACOp::ADD, result, "1", result, postfix->type);
@@ -521,7 +501,7 @@ void TacGenerator::generate_tac_var_array_assign(VarNode *var_node, Symbol *var_
 	{
 		AggregateLiteral *array_init = dynamic_cast<AggregateLiteral *>(value);
 		for (size_t i = 0; i < array_size; i++)
-			elements.emplace_back(generate_tac_expr(array_init->values[i].get()));
+			elements.emplace_back(generate_tac_expr(array_init->values[i]));
 	}
 
 	// Assign provided values
@@ -539,21 +519,43 @@ void TacGenerator::generate_tac_var_array_assign(VarNode *var_node, Symbol *var_
 		instructions.emplace_back(TACOp::ASSIGN, var_node->name, std::to_string(j), "0", Type(base_type));
 }
 
-void TacGenerator::generate_tac_cmp(ASTNode *condition, const std::string &label_success,
-									const std::string &label_failure)
+static BinOpType invert_comparison(BinOpType op)
+{
+	switch (op)
+	{
+	case BinOpType::EQUAL:
+		return BinOpType::NOT_EQUAL;
+	case BinOpType::NOT_EQUAL:
+		return BinOpType::EQUAL;
+	case BinOpType::LESS_THAN:
+		return BinOpType::GREATER_OR_EQUAL;
+	case BinOpType::GREATER_THAN:
+		return BinOpType::LESS_OR_EQUAL;
+	case BinOpType::LESS_OR_EQUAL:
+		return BinOpType::GREATER_THAN;
+	case BinOpType::GREATER_OR_EQUAL:
+		return BinOpType::LESS_THAN;
+	default:
+		throw std::runtime_error("TAC Error: Cannot invert a non comparison operator");
+	}
+}
+
+static bool is_comparison(BinOpType op)
+{
+	return op == BinOpType::EQUAL || op == BinOpType::NOT_EQUAL || op == BinOpType::LESS_THAN ||
+		   op == BinOpType::GREATER_THAN || op == BinOpType::LESS_OR_EQUAL || op == BinOpType::GREATER_OR_EQUAL;
+}
+
+void TacGenerator::generate_tac_cmp(ASTNode *condition, const std::string &label, bool jump_if)
 {
 	/*
-		The cases which should be supported include:
-		- Binary comparisons ie
-			- a < b / a <= b
-			- a < b && a < c / a < b || a < c (short circuiting/recursion is
-	   needed)
-		- Unary comparisons ie
-			- !a
-		- Boolean comparisons ie
-			- true, false
-		- Variable comparions ie
-			- a
+		Jumps to label when the condition evaluates to jump_if, otherwise falls through
+		Comparisons become a single IF (so cmp + jcc) rather than materialising a boolean first
+		- a < b                 -> IF a < b (or a >= b when jumping on false)
+		- a && b / a || b       -> short circuits, only jumping past the right side when needed
+		- !a                    -> the same as a with the jump inverted
+		- true / false          -> GOTO (or nothing)
+		- Anything else (a, f(), a + b) is compared against zero
 	*/
 
 	switch (condition->node_type)
@@ -562,65 +564,90 @@ void TacGenerator::generate_tac_cmp(ASTNode *condition, const std::string &label
 	{
 		BinaryNode *bin = dynamic_cast<BinaryNode *>(condition);
 
-		if (bin->op == BinOpType::AND)
+		if (bin->op == BinOpType::AND || bin->op == BinOpType::OR)
 		{
-			std::string go_next_cond = gen_new_label();
-
-			generate_tac_cmp(bin->left.get(), go_next_cond, label_failure);
-			instructions.emplace_back(TACOp::LABEL, go_next_cond);
-			generate_tac_cmp(bin->right.get(), label_success, label_failure);
+			/*
+				a && b jumping on false (and a || b jumping on true) just needs either side to jump
+				Otherwise the left side decides whether the right side needs evaluating at all
+			*/
+			bool is_and = bin->op == BinOpType::AND;
+			if (jump_if != is_and)
+			{
+				generate_tac_cmp(bin->left, label, jump_if);
+				generate_tac_cmp(bin->right, label, jump_if);
+				return;
+			}
 
-			break;
+			std::string label_skip = gen_new_label();
+			generate_tac_cmp(bin->left, label_skip, !jump_if);
+			generate_tac_cmp(bin->right, label, jump_if);
+			instructions.emplace_back(TACOp::LABEL, label_skip);
+			return;
 		}
 
-		if (bin->op == BinOpType::OR)
-		{
-			std::string go_next_cond = gen_new_label();
+		if (!is_comparison(bin->op))
+			break;
 
-			generate_tac_cmp(bin->left.get(), label_success, go_next_cond);
-			instructions.emplace_back(TACOp::LABEL, go_next_cond);
-			generate_tac_cmp(bin->right.get(), label_success, label_failure);
+		TACInstruction if_instruction(TACOp::IF, generate_tac_expr(bin->left),
+									  generate_tac_expr(bin->right), label, bin->type);
 
-			break;
+		// !(a < b) isn't a >= b for doubles (neither holds when one is NaN) so they jump over the GOTO instead
+		if (!jump_if && bin->type.has_base_type(BaseType::DOUBLE) && !bin->type.is_pointer())
+		{
+			std::string label_true = gen_new_label();
+			if_instruction.result = label_true;
+			if_instruction.cmp_op = bin->op;
+			instructions.emplace_back(if_instruction);
+			instructions.emplace_back(TACOp::GOTO, "", "", label);
+			instructions.emplace_back(TACOp::LABEL, label_true);
+			return;
 		}
 
-		TACInstruction if_instruction(TACOp::IF, generate_tac_expr(bin->left.get()),
-									  generate_tac_expr(bin->right.get()), label_success, bin->type);
-		if_instruction.cmp_op = bin->op;
+		if_instruction.cmp_op = jump_if ? bin->op : invert_comparison(bin->op);
 		instructions.emplace_back(if_instruction);
-		break;
+		return;
 	}
 	case NodeType::NODE_BOOL:
 	{
 		BoolLiteral *bool_node = (BoolLiteral *)condition;
-		if (bool_node->value)
-			instructions.emplace_back(TACOp::GOTO, label_success);
-		else
-			instructions.emplace_back(TACOp::GOTO, label_failure);
-		break;
-	}
-	case NodeType::NODE_VAR:
-	{
-		VarNode *var_node = (VarNode *)condition;
-		TACInstruction if_instruction(TACOp::IF, var_node->name, "1", label_success, var_node->type);
-		if_instruction.cmp_op = BinOpType::EQUAL;
-		instructions.emplace_back(if_instruction);
-		break;
+		if (bool_node->value == jump_if)
+			instructions.emplace_back(TACOp::GOTO, "", "", label);
+		return;
 	}
 	case NodeType::NODE_UNARY:
 	{
 		UnaryNode *unary_node = (UnaryNode *)condition;
-		TACInstruction if_instruction(TACOp::IF, generate_tac_expr(unary_node->value.get()), "1", label_success,
-									  unary_node->type);
-		if_instruction.cmp_op = BinOpType::NOT_EQUAL;
-		instructions.emplace_back(if_instruction);
+		if (unary_node->op == UnaryOpType::NOT)
+		{
+			generate_tac_cmp(unary_node->value, label, !jump_if);
+			return;
+		}
 		break;
 	}
-	default:
+	case NodeType::NODE_CAST:
 	{
-		error("Invalid condition type", condition->loc);
+		// Casting a comparison (i.e. to mix it with another type) doesn't change whether it holds
+		CastNode *cast_node = (CastNode *)condition;
+		BinaryNode *bin = dynamic_cast<BinaryNode *>(cast_node->expr);
+		if (bin && (is_comparison(bin->op) || bin->op == BinOpType::AND || bin->op == BinOpType::OR))
+		{
+			generate_tac_cmp(bin, label, jump_if);
+			return;
+		}
+		break;
 	}
+	default:
+		break;
 	}
+
+	// Any other value is true when non zero
+	Type type = sem_analyser->infer_type(condition);
+	std::string value = generate_tac_expr(condition);
+	std::string zero = type.has_base_type(BaseType::DOUBLE) && !type.is_pointer() ? get_const_label(0.0) : "0";
+
+	TACInstruction if_instruction(TACOp::IF, value, zero, label, type);
+	if_instruction.cmp_op = jump_if ? BinOpType::NOT_EQUAL : BinOpType::EQUAL;
+	instructions.emplace_back(if_instruction);
 }
 
 void TacGenerator::generate_tac_struct_assign(VarNode *var, ASTNode *value, std::string memory_region)
@@ -637,19 +664,19 @@ void TacGenerator::generate_tac_struct_assign(VarNode *var, ASTNode *value, std:
 	size_t field_index = 0;
 	for (const auto &value : compound_init->values)
 	{
-		std::string result = generate_tac_expr(value.get());
+		std::string result = generate_tac_expr(value);
 		std::string field_name = var->type.get_field_name(field_index);
 		int offset = var->type.get_field_offset(field_name);
-		Type result_type = sem_analyser->infer_type(value.get());
+		Type result_type = sem_analyser->infer_type(value);
 
 		if (result_type.is_array())
 		{
-			if (value.get()->node_type == NodeType::NODE_AGGREGATE_INIT)
+			if (value->node_type == NodeType::NODE_AGGREGATE_INIT)
 			{
-				AggregateLiteral *aggregate_init = dynamic_cast<AggregateLiteral *>(value.get());
+				AggregateLiteral *aggregate_init = dynamic_cast<AggregateLiteral *>(value);
 				for (size_t i = 0; i < aggregate_init->values.size(); i++)
 				{
-					result = generate_tac_expr(aggregate_init->values[i].get());
+					result = generate_tac_expr(aggregate_init->values[i]);
 					int arr_offset = offset + (i * result_type.get_base_size());
 					int final_offset = struct_sym->stack_offset + arr_offset;
 
@@ -690,9 +717,9 @@ std::string TacGenerator::generate_tac_expr_cast(ASTNode *expr)
 {
 	CastNode *cast = (CastNode *)expr;
 
-	std::string result = generate_tac_expr(cast->expr.get());
+	std::string result = generate_tac_expr(cast->expr);
 
-	if (cast->target_type.has_base_type(BaseType::DOUBLE) && cast->expr.get()->node_type == NodeType::NODE_NUMBER)
+	if (cast->target_type.has_base_type(BaseType::DOUBLE) && cast->expr->node_type == NodeType::NODE_NUMBER)
 		return get_const_label(std::stod(result));
 
 	std::string temp_var = gen_new_temp_var();
@@ -723,7 +750,7 @@ std::string TacGenerator::generate_tac_expr_unary(ASTNode *expr)
 {
 	UnaryNode *unary = (UnaryNode *)expr;
 
-	std::string result = generate_tac_expr(unary->value.get());
+	std::string result = generate_tac_expr(unary->value);
 
 	std::string temp_var = gen_new_temp_var();
 	gst->declare_temp_var(temp_var, unary->type);
@@ -747,8 +774,11 @@ std::string TacGenerator::generate_tac_expr_binary(ASTNode *expr)
 {
 	BinaryNode *bin_node = dynamic_cast<BinaryNode *>(expr);
 
-	std::string arg1 = generate_tac_expr(bin_node->left.get());
-	std::string arg2 = generate_tac_expr(bin_node->right.get());
+	if (bin_node->op == BinOpType::AND || bin_node->op == BinOpType::OR)
+		return generate_tac_expr_logical(bin_node);
+
+	std::string arg1 = generate_tac_expr(bin_node->left);
+	std::string arg2 = generate_tac_expr(bin_node->right);
 
 	std::string temp_var = gen_new_temp_var();
 	gst->declare_temp_var(temp_var, bin_node->type);
@@ -758,6 +788,42 @@ std::string TacGenerator::generate_tac_expr_binary(ASTNode *expr)
 	return temp_var;
 }
 
+std::string TacGenerator::generate_tac_expr_logical(BinaryNode *bin_node)
+{
+	/*
+		Short circuits rather than evaluating both sides
+		i.e. a && b
+			IF a == 0 -> false
+			IF b == 0 -> false
+			t = 1
+			GOTO end
+		false:
+			t = 0
+		end:
+	*/
+	Type type = bin_node->type;
+	if (type.has_base_type(BaseType::DOUBLE) || type.is_pointer())
+		type = Type(BaseType::INT);
+
+	std::string temp_var = gen_new_temp_var();
+	gst->declare_temp_var(temp_var, type);
+
+	std::string label_false = gen_new_label();
+	std::string label_end = gen_new_label();
+
+	generate_tac_cmp(bin_node, label_false, false);
+
+	instructions.emplace_back(TACOp::ASSIGN, temp_var, "", "1", type);
+	instructions.emplace_back(TACOp::GOTO, "", "", label_end);
+
+	instructions.emplace_back(TACOp::LABEL, label_false);
+	instructions.emplace_back(TACOp::ASSIGN, temp_var, "", "0", type);
+
+	instructions.emplace_back(TACOp::LABEL, label_end);
+
+	return temp_var;
+}
+
 std::string TacGenerator::generate_tac_expr_postfix(ASTNode *expr)
 {
 	PostfixNode *postfix = (PostfixNode *)expr;
@@ -773,7 +839,7 @@ std::string TacGenerator::generate_tac_expr_postfix(ASTNode *expr)
 		return temp;
 	}
 
-	std::string result = generate_tac_expr(postfix->value.get());
+	std::string result = generate_tac_expr(postfix->value);
 
 	if (postfix->op == TokenType::TOKEN_INCREMENT)
 		instructions.emplace_back(TACOp::ADD, result, "1", result, postfix->type);
@@ -786,8 +852,8 @@ std::string TacGenerator::generate_tac_expr_postfix(ASTNode *expr)
 std::string TacGenerator::generate_tac_expr_array_access(ASTNode *expr)
 {
 	ArrayAccessNode *array_access = (ArrayAccessNode *)expr;
-	std::string base = generate_tac_expr(array_access->array.get());
-	std::string index = generate_tac_expr(array_access->index.get());
+	std::string base = generate_tac_expr(array_access->array);
+	std::string index = generate_tac_expr(array_access->index);
 	std::string temp = gen_new_temp_var();
 
 	std::string scaled_index = index;
@@ -805,7 +871,7 @@ std::string TacGenerator::generate_tac_expr_array_access(ASTNode *expr)
 			std::to_string(element_type.get_size()),
 			index,
 			scale_temp,
-			element_type);
+			Type(BaseType::INT));
 
 		scaled_index = scale_temp;
 	}
@@ -824,40 +890,28 @@ std::string TacGenerator::generate_tac_expr_func_call(ASTNode *expr)
 	size_t double_arg_count = 0;
 	size_t other_arg_count = 0;
 
-	// Handle regular function calls
-	for (size_t i = 0; i < func->args.size(); i++)
+	/*
+		Every argument is evaluated into a value first and only then moved into its register
+		So a call (or anything else which clobbers registers e.g. division) within a later argument
+		can't overwrite an argument which has already been loaded
+	*/
+	std::vector<std::pair<std::string, Type>> arg_values;
+	for (auto &arg : func->args)
 	{
-		Type arg_type = sem_analyser->infer_type(func->args[i].get());
-
-		/*
-			If the argument is a function call:
-			- It will probably modify registers i.e. rdi, rsi, etc.
-			- We need to save the state of these registers before the function call
-			- We then restore the state of these registers after the function call
-		*/
-		if (func->args[i].get()->node_type == NodeType::NODE_FUNC_CALL)
-		{
-			for (size_t j = 0; j < i; j++)
-				instructions.emplace_back(TACOp::PUSH, x64_registers[j], "", "", arg_type);
-		}
-
-		std::string arg_result = generate_tac_expr(func->args[i].get());
-
-		if (func->args[i].get()->node_type == NodeType::NODE_FUNC_CALL)
-		{
-			for (size_t j = 0; j < i; j++)
-				instructions.emplace_back(TACOp::POP, x64_registers[j], "", "", arg_type);
-		}
-
-		/*
-			The first 6 arguments go in registers
-			Note that doubles go in the xmm registers
-			Remaining arguments get pushed onto the stack
-		*/
+		Type arg_type = sem_analyser->infer_type(arg);
+		arg_values.emplace_back(generate_tac_expr(arg), arg_type);
+	}
 
+	/*
+		The first 6 arguments go in registers
+		Note that doubles go in the xmm registers
+		Remaining arguments get pushed onto the stack
+	*/
+	for (auto &[arg_result, arg_type] : arg_values)
+	{
 		if (arg_type.has_base_type(BaseType::DOUBLE))
 		{
-			if (double_arg_count < 8)
+			if (double_arg_count < xmm_registers.size())
 				instructions.emplace_back(TACOp::MOV_BETWEEN_REG, arg_result, xmm_registers[double_arg_count++],
 										  "load", arg_type);
 			else
@@ -865,7 +919,7 @@ std::string TacGenerator::generate_tac_expr_func_call(ASTNode *expr)
 		}
 		else
 		{
-			if (other_arg_count < 6)
+			if (other_arg_count < x64_registers.size())
 				instructions.emplace_back(TACOp::MOV_BETWEEN_REG, arg_result, x64_registers[other_arg_count++],
 										  "load", arg_type);
 			else
@@ -986,11 +1040,11 @@ std::tuple<std::string, std::string> TacGenerator::compute_struct_access_offset(
 		This is done by first getting the index  value and scaling it by the size
 	   of the base type Then we add this to the field offset
 	*/
-	if (postfix->value.get()->node_type == NodeType::NODE_ARRAY_ACCESS)
+	if (postfix->value->node_type == NodeType::NODE_ARRAY_ACCESS)
 	{
-		ArrayAccessNode *array_access = (ArrayAccessNode *)postfix->value.get();
+		ArrayAccessNode *array_access = (ArrayAccessNode *)postfix->value;
 
-		std::string index = generate_tac_expr(array_access->index.get());
+		std::string index = generate_tac_expr(array_access->index);
 
 		bool is_number = !index.empty() && std::all_of(index.begin(), index.end(), ::isdigit);
 
@@ -1150,6 +1204,24 @@ std::string TacGenerator::gen_tac_str(const TACInstruction &instr)
 			return "STRUCT_INIT";
 		case TACOp::ASSIGN_DEREF:
 			return "ASSIGN_DEREF";
+		case TACOp::PHI:
+			return "PHI";
+		case TACOp::VEC_LOAD:
+			return "VEC_LOAD";
+		case TACOp::VEC_STORE:
+			return "VEC_STORE";
+		case TACOp::VEC_SPLAT:
+			return "VEC_SPLAT";
+		case TACOp::VEC_ADD:
+			return "VEC_ADD";
+		case TACOp::VEC_SUB:
+			return "VEC_SUB";
+		case TACOp::VEC_MUL:
+			return "VEC_MUL";
+		case TACOp::VEC_DIV:
+			return "VEC_DIV";
+		case TACOp::VEC_END:
+			return "VEC_END";
 		default:
 			return "UNKNOWN";
 		}
@@ -1161,6 +1233,12 @@ std::string TacGenerator::gen_tac_str(const TACInstruction &instr)
 		str += " " + instr.arg1;
 	if (!instr.arg2.empty())
 		str += ", " + instr.arg2;
+	if (instr.scale != 1)
+		str += "*" + std::to_string(instr.scale);
+	if (instr.displacement != 0)
+		str += (instr.displacement > 0 ? "+" : "") + std::to_string(instr.displacement);
+	for (auto &[pred, value] : instr.phi_args)
+		str += " [B" + std::to_string(pred) + ": " + value + "]";
 	if (!instr.result.empty())
 		str += " -> " + instr.result;
 
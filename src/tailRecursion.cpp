@@ -0,0 +1,313 @@
+#include "../include/tailRecursion.h"
+
+#include <algorithm>
+
+#include "../include/sccp.h"
+
+TailRecursionElimination::TailRecursionElimination(std::shared_ptr<GlobalSymbolTable> gst) : gst(gst) {}
+
+std::string TailRecursionElimination::new_var(const std::string &name, const Type &type)
+{
+	std::string var = name + "." + std::to_string(++new_var_count);
+	gst->declare_temp_var(var, type);
+
+	return var;
+}
+
+bool TailRecursionElimination::find_params(const ControlFlowGraph &cfg)
+{
+	params.clear();
+
+	FuncSymbol *func = gst->get_func_symbol(func_name);
+	if (!func)
+		return false;
+
+	return_type = func->return_type;
+
+	// FUNC_BEGIN is followed by each parameter being stored from the register it was passed in
+	auto &instructions = cfg.blocks[cfg.get_entry()].instructions;
+	for (size_t i = 1; i < instructions.size(); i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+		if (instruction.op != TACOp::MOV_BETWEEN_REG || instruction.result != "store")
+			break;
+
+		// Copying these into the parameters isn't a plain value copy
+		Symbol *symbol = gst->get_symbol(instruction.arg1);
+		if (!symbol || is_aggregate(symbol->type) ||
+			(symbol->type.has_base_type(BaseType::CHAR) && symbol->type.is_pointer()))
+			return false;
+
+		params[instruction.arg2] = {instruction.arg1, instruction.type};
+	}
+
+	return (int)params.size() == func->arg_count;
+}
+
+bool TailRecursionElimination::reaches_exit(const ControlFlowGraph &cfg, int block) const
+{
+	// Falls through (past any empty blocks) to the end of the function
+	while (cfg.blocks[block].succs.size() == 1)
+	{
+		block = cfg.blocks[block].succs[0];
+		if (block == cfg.get_exit())
+			return true;
+
+		for (auto &instruction : cfg.blocks[block].instructions)
+			if (instruction.op != TACOp::LABEL && instruction.op != TACOp::NOP)
+				return false;
+	}
+
+	return false;
+}
+
+bool TailRecursionElimination::is_accumulable(const std::string &operand) const
+{
+	long long value;
+	if (parse_int_literal(operand, value))
+		return true;
+
+	// The recursive call could change a global before it is read
+	Symbol *symbol = gst->get_symbol(operand);
+	return symbol && !symbol->is_global && !symbol->has_static_sd() && !symbol->is_literal8;
+}
+
+bool TailRecursionElimination::find_arg_loads(const std::vector<TACInstruction> &instructions,
+											  TailCall &tail_call) const
+{
+	std::unordered_map<std::string, size_t> loads;
+
+	for (size_t i = tail_call.call; i-- > 0 && loads.size() < params.size();)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		switch (instruction.op)
+		{
+		case TACOp::MOV_BETWEEN_REG:
+		{
+			if (instruction.result != "load" || !params.count(instruction.arg2) || loads.count(instruction.arg2))
+				return false;
+
+			Symbol *symbol = gst->get_symbol(instruction.arg1);
+			if (symbol && is_aggregate(symbol->type))
+				return false;
+
+			loads[instruction.arg2] = i;
+			break;
+		}
+		// Arguments which don't all go in registers (or are split up by another call)
+		case TACOp::CALL:
+		case TACOp::PRINTF:
+		case TACOp::PUSH:
+		case TACOp::POP:
+		case TACOp::ALLOC_STACK:
+		case TACOp::DEALLOC_STACK:
+		case TACOp::LABEL:
+			return false;
+		default:
+			break;
+		}
+	}
+
+	if (loads.size() != params.size())
+		return false;
+
+	for (auto &[reg, index] : loads)
+		tail_call.arg_loads.push_back(index);
+	std::sort(tail_call.arg_loads.begin(), tail_call.arg_loads.end());
+
+	return true;
+}
+
+bool TailRecursionElimination::match_tail_call(const ControlFlowGraph &cfg, int block, TailCall &tail_call) const
+{
+	/*
+		The shapes recognised (anything in between isn't allowed)
+		- CALL f; [MOV_BETWEEN_REG t, %rax -> store]; RETURN [t]
+		- CALL f; MOV_BETWEEN_REG t, %rax -> store; ADD/MUL x, t -> r; RETURN r
+		- CALL f [GOTO] at the end of a void function (the jump being out of the then branch of an if)
+	*/
+	auto &instructions = cfg.blocks[block].instructions;
+	if (instructions.empty())
+		return false;
+
+	tail_call = {block, 0, {}, TACOp::NOP, ""};
+
+	auto is_self_call = [&](size_t i)
+	{ return instructions[i].op == TACOp::CALL && instructions[i].arg1 == func_name; };
+
+	auto is_result_store = [&](size_t i, const std::string &value)
+	{
+		return instructions[i].op == TACOp::MOV_BETWEEN_REG && instructions[i].result == "store" &&
+			   (instructions[i].arg2 == "%rax" || instructions[i].arg2 == "%xmm0") && instructions[i].arg1 == value;
+	};
+
+	size_t n = instructions.size();
+	const TACInstruction &last = instructions.back();
+
+	if (last.op == TACOp::RETURN && last.arg1.empty())
+	{
+		if (n < 2 || !is_self_call(n - 2))
+			return false;
+
+		tail_call.call = n - 2;
+	}
+	else if (last.op == TACOp::RETURN)
+	{
+		if (n >= 3 && is_result_store(n - 2, last.arg1) && is_self_call(n - 3))
+			tail_call.call = n - 3;
+		else if (n >= 4 && (instructions[n - 2].op == TACOp::ADD || instructions[n - 2].op == TACOp::MUL) &&
+				 instructions[n - 2].result == last.arg1 && instructions[n - 2].type == return_type &&
+				 return_type.is_integral() && !return_type.is_pointer() && !return_type.is_array() &&
+				 is_self_call(n - 4))
+		{
+			// Either operand may be the result of the call
+			const TACInstruction &combine = instructions[n - 2];
+			std::string other;
+			if (is_result_store(n - 3, combine.arg2))
+				other = combine.arg1;
+			else if (is_result_store(n - 3, combine.arg1))
+				other = combine.arg2;
+
+			if (other.empty() || other == instructions[n - 3].arg1 || !is_accumulable(other))
+				return false;
+
+			tail_call.call = n - 4;
+			tail_call.accumulate = combine.op;
+			tail_call.accumulated = other;
+		}
+		else
+			return false;
+	}
+	else if (return_type.is_void() && reaches_exit(cfg, block))
+	{
+		size_t call = last.op == TACOp::GOTO ? n - 2 : n - 1;
+		if (call >= n || !is_self_call(call))
+			return false;
+
+		tail_call.call = call;
+	}
+	else
+		return false;
+
+	return find_arg_loads(instructions, tail_call);
+}
+
+bool TailRecursionElimination::run(ControlFlowGraph &cfg)
+{
+	const TACInstruction &begin = cfg.blocks[cfg.get_entry()].instructions.front();
+	if (begin.op != TACOp::FUNC_BEGIN)
+		return false;
+
+	func_name = begin.arg1;
+	if (!find_params(cfg))
+		return false;
+
+	for (auto &block : cfg.blocks)
+		for (auto &instruction : block.instructions)
+			if (instruction.op == TACOp::ADDR_OF)
+				return false;
+
+	std::vector<TailCall> tail_calls;
+	TACOp accumulate = TACOp::NOP;
+
+	for (size_t b = 0; b < cfg.blocks.size(); b++)
+	{
+		TailCall tail_call;
+		if (!match_tail_call(cfg, b, tail_call))
+			continue;
+
+		// Only one kind of accumulator is kept
+		if (tail_call.accumulate != TACOp::NOP)
+		{
+			if (accumulate != TACOp::NOP && accumulate != tail_call.accumulate)
+				continue;
+			accumulate = tail_call.accumulate;
+		}
+
+		tail_calls.push_back(tail_call);
+	}
+
+	if (tail_calls.empty())
+		return false;
+
+	/*
+		Split the parameter stores off from the rest of the entry block
+		The rest starts the new loop which each tail call jumps back to
+	*/
+	size_t split = 1 + params.size();
+	int header = cfg.insert_block(1);
+	std::string header_label = cfg.blocks[header].label;
+
+	auto &entry = cfg.blocks[cfg.get_entry()].instructions;
+	auto &body = cfg.blocks[header].instructions;
+	body.insert(body.end(), entry.begin() + split, entry.end());
+	entry.erase(entry.begin() + split, entry.end());
+
+	// The new block comes after its label
+	for (auto &tail_call : tail_calls)
+	{
+		if (tail_call.block != cfg.get_entry())
+		{
+			tail_call.block++;
+			continue;
+		}
+
+		tail_call.block = header;
+		tail_call.call -= split - 1;
+		for (size_t &i : tail_call.arg_loads)
+			i -= split - 1;
+	}
+
+	std::string accumulator;
+	if (accumulate != TACOp::NOP)
+	{
+		accumulator = new_var("acc", return_type);
+		entry.emplace_back(TACOp::ASSIGN, accumulator, "", accumulate == TACOp::MUL ? "1" : "0", return_type);
+	}
+
+	for (auto &tail_call : tail_calls)
+	{
+		auto &instructions = cfg.blocks[tail_call.block].instructions;
+
+		// Each argument is copied aside where it was loaded so the parameters can all be updated at once
+		std::vector<TACInstruction> updates;
+		for (size_t i : tail_call.arg_loads)
+		{
+			TACInstruction &load = instructions[i];
+			const Param &param = params[load.arg2];
+
+			std::string copy = new_var("tail", param.type);
+			updates.emplace_back(TACOp::ASSIGN, param.name, "", copy, param.type);
+			load = TACInstruction(TACOp::ASSIGN, copy, "", load.arg1, param.type);
+		}
+
+		instructions.erase(instructions.begin() + tail_call.call, instructions.end());
+
+		if (tail_call.accumulate != TACOp::NOP)
+			instructions.emplace_back(tail_call.accumulate, accumulator, tail_call.accumulated, accumulator,
+									  return_type);
+
+		instructions.insert(instructions.end(), updates.begin(), updates.end());
+		instructions.emplace_back(TACOp::GOTO, "", "", header_label);
+	}
+
+	// Every other return hands back what has been accumulated so far combined with its value
+	if (!accumulator.empty())
+		for (auto &block : cfg.blocks)
+		{
+			auto &instructions = block.instructions;
+			if (instructions.empty() || instructions.back().op != TACOp::RETURN || instructions.back().arg1.empty())
+				continue;
+
+			std::string result = new_var("acc", return_type);
+			instructions.insert(instructions.end() - 1, TACInstruction(accumulate, accumulator,
+																		 instructions.back().arg1, result,
+																		 return_type));
+			instructions.back().arg1 = result;
+		}
+
+	cfg.rebuild_edges();
+
+	return true;
+}
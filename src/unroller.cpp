@@ -0,0 +1,259 @@
+#include "../include/unroller.h"
+
+#include <algorithm>
+
+#include "../include/liveness.h"
+#include "../include/sccp.h"
+
+LoopUnroller::LoopUnroller(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options)
+	: gst(gst), options(options) {}
+
+bool LoopUnroller::run(std::vector<TACInstruction> &instructions)
+{
+	bool changed = false;
+	auto ranges = find_func_ranges(instructions);
+
+	// Work backwards so growing a function doesn't move the ones still to be done
+	for (auto it = ranges.rbegin(); it != ranges.rend(); it++)
+	{
+		auto [begin, end] = *it;
+
+		gst->enter_func_scope(instructions[begin].arg1);
+
+		// Also backwards within the function so inner loops are unrolled first (they start after their outer loop)
+		for (size_t i = end + 1; i-- > begin;)
+		{
+			Loop loop;
+			if (!match_loop(instructions, i, end, loop) || !is_countable(instructions, begin, end, loop))
+				continue;
+
+			// What is left over from a vectorised loop is already short
+			if (instructions[i - 1].op == TACOp::VEC_END)
+				continue;
+
+			size_t cost = get_cost(instructions, loop);
+			size_t size = instructions.size();
+			long long trip_count;
+			bool is_constant = get_trip_count(instructions, begin, loop, trip_count);
+			int factor = options.get_unroll_factor();
+
+			if (is_constant && trip_count <= options.unroll_threshold &&
+				trip_count * cost <= (size_t)options.unroll_threshold)
+				unroll_fully(instructions, loop, trip_count);
+			else if ((!is_constant || trip_count >= factor) && factor * cost <= (size_t)options.unroll_threshold)
+				unroll_partially(instructions, loop, factor);
+			else
+				continue;
+
+			end = end + instructions.size() - size;
+			changed = true;
+		}
+
+		gst->leave_func_scope();
+	}
+
+	return changed;
+}
+
+bool LoopUnroller::match_loop(const std::vector<TACInstruction> &instructions, size_t start, size_t func_end,
+							  Loop &loop) const
+{
+	/*
+		The shape every for loop is generated with (see TacGenerator::generate_tac_for)
+		LABEL start
+		IF counter, bound -> end (jumping out once counter >= bound or counter > bound)
+		LABEL body
+		...
+		LABEL post
+		ADD counter, 1 -> counter
+		GOTO start
+		NOP
+		LABEL end
+	*/
+	if (start + 2 > func_end || instructions[start].op != TACOp::LABEL)
+		return false;
+
+	const TACInstruction &condition = instructions[start + 1];
+	if (condition.op != TACOp::IF || instructions[start + 2].op != TACOp::LABEL ||
+		(condition.cmp_op != BinOpType::GREATER_OR_EQUAL && condition.cmp_op != BinOpType::GREATER_THAN))
+		return false;
+
+	const Type &type = condition.type;
+	if (type.is_pointer() || type.is_array() ||
+		!(type.has_base_type(BaseType::INT) || type.has_base_type(BaseType::LONG)))
+		return false;
+
+	Symbol *counter = gst->get_symbol(condition.arg1);
+	if (!is_local_symbol(counter) || counter->type != type)
+		return false;
+
+	// The only jump back to the start is from the end of the loop (continue goes to post)
+	size_t jump = start + 3;
+	while (jump <= func_end &&
+		   !(instructions[jump].op == TACOp::GOTO && instructions[jump].result == instructions[start].arg1))
+		jump++;
+
+	if (jump > func_end || jump < start + 5)
+		return false;
+
+	const TACInstruction &step = instructions[jump - 1];
+	if (instructions[jump - 2].op != TACOp::LABEL || step.op != TACOp::ADD || step.arg1 != condition.arg1 ||
+		step.arg2 != "1" || step.result != condition.arg1)
+		return false;
+
+	size_t end = jump + 1;
+	if (end <= func_end && instructions[end].op == TACOp::NOP)
+		end++;
+
+	if (end > func_end || instructions[end].op != TACOp::LABEL || instructions[end].arg1 != condition.result)
+		return false;
+
+	loop.start = start;
+	loop.post = jump - 2;
+	loop.end = end;
+	loop.counter = condition.arg1;
+	loop.bound = condition.arg2;
+	return true;
+}
+
+bool LoopUnroller::is_countable(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+								const Loop &loop) const
+{
+	// The bound has to be the same every time it is checked
+	long long value;
+	if (!parse_int_literal(loop.bound, value) && !is_local_symbol(gst->get_symbol(loop.bound)))
+		return false;
+
+	// Neither can be changed through a pointer
+	for (size_t i = begin; i <= end; i++)
+		if (instructions[i].op == TACOp::ADDR_OF &&
+			(instructions[i].arg1 == loop.counter || instructions[i].arg1 == loop.bound))
+			return false;
+
+	for (size_t i = loop.start + 2; i < loop.post; i++)
+		for (auto &def : get_tac_defs(instructions[i], gst.get()))
+			if (def == loop.counter || def == loop.bound)
+				return false;
+
+	return true;
+}
+
+bool LoopUnroller::get_trip_count(const std::vector<TACInstruction> &instructions, size_t begin, const Loop &loop,
+								  long long &trip_count) const
+{
+	// The counter is set to a literal straight before the loop (which can only be entered from there)
+	if (loop.start == begin)
+		return false;
+
+	const TACInstruction &init = instructions[loop.start - 1];
+	long long first, bound;
+
+	if (init.op != TACOp::ASSIGN || init.arg1 != loop.counter || !init.arg2.empty() ||
+		!parse_int_literal(init.result, first) || !parse_int_literal(loop.bound, bound))
+		return false;
+
+	// i < n stops at n whereas i <= n goes one further
+	if (instructions[loop.start + 1].cmp_op == BinOpType::GREATER_THAN)
+		bound++;
+
+	trip_count = std::max(bound - first, 0LL);
+	return true;
+}
+
+size_t LoopUnroller::get_cost(const std::vector<TACInstruction> &instructions, const Loop &loop) const
+{
+	// Roughly the number of instructions each copy of the body (and increment) comes to
+	size_t cost = 0;
+	for (size_t i = loop.start + 2; i <= loop.post + 1; i++)
+		if (instructions[i].op != TACOp::LABEL && instructions[i].op != TACOp::NOP)
+			cost++;
+
+	return cost;
+}
+
+std::vector<TACInstruction> LoopUnroller::copy_body(const std::vector<TACInstruction> &instructions, const Loop &loop)
+{
+	std::string suffix = "_u" + std::to_string(copy_count++);
+
+	std::unordered_map<std::string, std::string> renamed;
+	for (size_t i = loop.start + 2; i <= loop.post; i++)
+		if (instructions[i].op == TACOp::LABEL)
+			renamed[instructions[i].arg1] = instructions[i].arg1 + suffix;
+
+	// Jumps out of the body (i.e. break) keep their target
+	std::vector<TACInstruction> copy;
+	for (size_t i = loop.start + 2; i <= loop.post + 1; i++)
+	{
+		TACInstruction instruction = instructions[i];
+
+		if (instruction.op == TACOp::LABEL)
+			instruction.arg1 = renamed[instruction.arg1];
+		else if (instruction.op == TACOp::GOTO || instruction.op == TACOp::IF)
+		{
+			auto it = renamed.find(instruction.result);
+			if (it != renamed.end())
+				instruction.result = it->second;
+		}
+
+		copy.push_back(instruction);
+	}
+
+	return copy;
+}
+
+void LoopUnroller::unroll_fully(std::vector<TACInstruction> &instructions, const Loop &loop, long long trip_count)
+{
+	// Nothing needs checking since how many times the body runs is already known
+	std::vector<TACInstruction> unrolled;
+	for (long long i = 0; i < trip_count; i++)
+	{
+		std::vector<TACInstruction> copy = copy_body(instructions, loop);
+		unrolled.insert(unrolled.end(), copy.begin(), copy.end());
+	}
+
+	// Everything up to (but not including) the end label is replaced
+	instructions.erase(instructions.begin() + loop.start, instructions.begin() + loop.end);
+	instructions.insert(instructions.begin() + loop.start, unrolled.begin(), unrolled.end());
+}
+
+void LoopUnroller::unroll_partially(std::vector<TACInstruction> &instructions, const Loop &loop, int factor)
+{
+	const TACInstruction &condition = instructions[loop.start + 1];
+	const std::string &label = instructions[loop.start].arg1;
+
+	/*
+		Only go round whilst there are enough iterations left for every copy
+		i.e. whilst counter < bound - (factor - 1) rather than counter + (factor - 1) < bound
+		which would overflow (and never exit) for a bound near the largest value of the type
+		The subtraction can't underflow either as a bound that close to the smallest value skips it altogether
+	*/
+	std::string limit = loop.counter + ".unroll" + std::to_string(copy_count);
+	gst->declare_temp_var(limit, condition.type);
+
+	long long lowest = min_int_value(condition.type) + factor - 1;
+	TACInstruction too_few(TACOp::IF, loop.bound, format_int_literal(lowest, condition.type), label + "_unroll_end",
+						   condition.type);
+	too_few.cmp_op = BinOpType::LESS_THAN;
+
+	TACInstruction exit(TACOp::IF, loop.counter, limit, label + "_unroll_end", condition.type);
+	exit.cmp_op = condition.cmp_op;
+
+	std::vector<TACInstruction> unrolled;
+	unrolled.push_back(too_few);
+	unrolled.emplace_back(TACOp::SUB, loop.bound, std::to_string(factor - 1), limit, condition.type);
+	unrolled.emplace_back(TACOp::LABEL, label + "_unroll");
+	unrolled.push_back(exit);
+
+	for (int i = 0; i < factor; i++)
+	{
+		std::vector<TACInstruction> copy = copy_body(instructions, loop);
+		unrolled.insert(unrolled.end(), copy.begin(), copy.end());
+	}
+
+	unrolled.emplace_back(TACOp::GOTO, "", "", label + "_unroll");
+	unrolled.emplace_back(TACOp::NOP);
+	unrolled.emplace_back(TACOp::LABEL, label + "_unroll_end");
+
+	// The original loop is left after to do whatever iterations are left
+	instructions.insert(instructions.begin() + loop.start, unrolled.begin(), unrolled.end());
+}
@@ -0,0 +1,392 @@
+#include "../include/vectoriser.h"
+
+#include "../include/liveness.h"
+#include "../include/sccp.h"
+
+LoopVectoriser::LoopVectoriser(std::shared_ptr<GlobalSymbolTable> gst, const CompilerOptions &options)
+	: gst(gst), options(options) {}
+
+bool LoopVectoriser::run(std::vector<TACInstruction> &instructions)
+{
+	bool changed = false;
+	auto ranges = find_func_ranges(instructions);
+
+	// Work backwards so growing a function doesn't move the ones still to be done
+	for (auto it = ranges.rbegin(); it != ranges.rend(); it++)
+	{
+		auto [begin, end] = *it;
+
+		gst->enter_func_scope(instructions[begin].arg1);
+
+		for (size_t i = begin; i <= end; i++)
+		{
+			Loop loop;
+			if (!match_loop(instructions, i, end, loop))
+				continue;
+
+			std::vector<TACInstruction> vectorised;
+			if (!vectorise_body(instructions, loop, vectorised) || is_used_outside(instructions, begin, end, loop))
+				continue;
+
+			// The original loop is left after the vector loop to do whatever iterations are left
+			instructions.insert(instructions.begin() + loop.start, vectorised.begin(), vectorised.end());
+			end += vectorised.size();
+			i = loop.end + vectorised.size();
+			changed = true;
+		}
+
+		gst->leave_func_scope();
+	}
+
+	return changed;
+}
+
+bool LoopVectoriser::match_loop(const std::vector<TACInstruction> &instructions, size_t start, size_t func_end,
+								Loop &loop) const
+{
+	/*
+		The shape every for loop is generated with (see TacGenerator::generate_tac_for)
+		LABEL start
+		IF counter, bound -> end (jumping out once counter >= bound or counter > bound)
+		LABEL body
+		...
+		LABEL post
+		ADD counter, 1 -> counter
+		GOTO start
+		NOP
+		LABEL end
+	*/
+	if (start + 2 > func_end || instructions[start].op != TACOp::LABEL)
+		return false;
+
+	const TACInstruction &condition = instructions[start + 1];
+	if (condition.op != TACOp::IF || instructions[start + 2].op != TACOp::LABEL ||
+		(condition.cmp_op != BinOpType::GREATER_OR_EQUAL && condition.cmp_op != BinOpType::GREATER_THAN))
+		return false;
+
+	const Type &type = condition.type;
+	if (type.is_pointer() || type.is_array() ||
+		!(type.has_base_type(BaseType::INT) || type.has_base_type(BaseType::LONG)))
+		return false;
+
+	Symbol *counter = gst->get_symbol(condition.arg1);
+	if (!is_local_symbol(counter) || counter->type != type)
+		return false;
+
+	loop.start = start;
+	loop.body = start + 3;
+	loop.counter = condition.arg1;
+	loop.bound = condition.arg2;
+
+	for (size_t i = loop.body; i + 3 <= func_end; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+
+		// Anything which branches (or is a target of one) means it isn't straight-line code
+		if (instruction.op == TACOp::IF || instruction.op == TACOp::GOTO)
+			return false;
+		if (instruction.op != TACOp::LABEL)
+			continue;
+
+		const TACInstruction &step = instructions[i + 1];
+		const TACInstruction &jump = instructions[i + 2];
+
+		size_t end = i + 3;
+		if (end <= func_end && instructions[end].op == TACOp::NOP)
+			end++;
+
+		if (step.op != TACOp::ADD || step.arg1 != loop.counter || step.arg2 != "1" || step.result != loop.counter ||
+			jump.op != TACOp::GOTO || jump.result != instructions[start].arg1 || end > func_end ||
+			instructions[end].op != TACOp::LABEL || instructions[end].arg1 != condition.result)
+			return false;
+
+		loop.post = i;
+		loop.end = end;
+		return true;
+	}
+
+	return false;
+}
+
+bool LoopVectoriser::set_element_type(const Type &type)
+{
+	if (type.is_pointer() || type.is_array() ||
+		!(type.has_base_type(BaseType::INT) || type.has_base_type(BaseType::LONG) ||
+		  type.has_base_type(BaseType::DOUBLE)))
+		return false;
+
+	// Every lane has to be the same width so the whole loop works on the one type
+	if (element_type.is_void())
+		element_type = type;
+
+	return element_type == type;
+}
+
+std::string LoopVectoriser::new_reg(bool is_splat)
+{
+	/*
+		Registers are reused once the value in them isn't needed for the rest of the body
+		A splat is set before the loop so has to be in a register nothing in the body ever writes to
+		(they're taken from the top so they don't get in the way of the values taken from the bottom)
+	*/
+	std::unordered_set<std::string> live;
+	for (auto &[operand, reg] : splats)
+		live.insert(reg);
+	for (auto &[name, reg] : values)
+		if (last_uses[name] >= current)
+			live.insert(reg);
+
+	for (int i = FIRST_VEC_REG; i <= LAST_VEC_REG; i++)
+	{
+		std::string reg = "%v" + std::to_string(is_splat ? LAST_VEC_REG + FIRST_VEC_REG - i : i);
+		if (live.count(reg) || (is_splat && written.count(reg)))
+			continue;
+
+		if (!is_splat)
+			written.insert(reg);
+		return reg;
+	}
+
+	return "";
+}
+
+std::string LoopVectoriser::new_var(const std::string &name, const Type &type)
+{
+	std::string new_name = name + ".vec" + std::to_string(new_var_count++);
+	gst->declare_temp_var(new_name, type);
+	return new_name;
+}
+
+bool LoopVectoriser::get_operand(const std::string &operand, const std::string &counter, std::string &reg)
+{
+	auto value = values.find(operand);
+	if (value != values.end())
+	{
+		reg = value->second;
+		return true;
+	}
+
+	// Used before it is defined (so it holds the value from the previous iteration)
+	if (operand == counter || body_defs.count(operand))
+		return false;
+
+	auto splat = splats.find(operand);
+	if (splat != splats.end())
+	{
+		reg = splat->second;
+		return true;
+	}
+
+	// Only scalars which don't change within the loop are left
+	Symbol *symbol = gst->get_symbol(operand);
+	long long literal;
+
+	if (symbol)
+	{
+		if (symbol->type != element_type)
+			return false;
+	}
+	else if (element_type.has_base_type(BaseType::DOUBLE) || !parse_int_literal(operand, literal))
+		return false;
+
+	reg = new_reg(true);
+	if (reg.empty())
+		return false;
+
+	splats[operand] = reg;
+	return true;
+}
+
+bool LoopVectoriser::vectorise_body(const std::vector<TACInstruction> &instructions, const Loop &loop,
+									std::vector<TACInstruction> &vectorised)
+{
+	element_type = Type();
+	values.clear();
+	splats.clear();
+	body_defs.clear();
+	last_uses.clear();
+	written.clear();
+
+	// Scaled copies of the counter (index * element size) which are only used to index arrays
+	std::unordered_map<std::string, int> indices;
+
+	for (size_t i = loop.body; i < loop.post; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+		if (instruction.op == TACOp::MUL && instruction.arg2 == loop.counter)
+			indices[instruction.result] = 0;
+
+		for (auto &def : get_tac_defs(instruction, gst.get()))
+			body_defs.insert(def);
+		for (auto &use : get_tac_uses(instruction, gst.get()))
+			last_uses[use] = i;
+	}
+
+	if (body_defs.count(loop.counter) || body_defs.count(loop.bound))
+		return false;
+
+	std::vector<TACInstruction> body;
+	bool has_store = false;
+
+	auto is_array = [&](const std::string &name)
+	{
+		Symbol *symbol = gst->get_symbol(name);
+		return is_local_symbol(symbol) && symbol->type.is_array();
+	};
+
+	auto is_index = [&](const std::string &name, const Type &type)
+	{
+		auto it = indices.find(name);
+		return it != indices.end() && it->second == (int)type.get_size();
+	};
+
+	for (size_t i = loop.body; i < loop.post; i++)
+	{
+		const TACInstruction &instruction = instructions[i];
+		std::string a, b;
+		current = i;
+
+		switch (instruction.op)
+		{
+		case TACOp::MUL:
+		{
+			auto index = indices.find(instruction.result);
+			if (index != indices.end())
+			{
+				long long scale;
+				if (!parse_int_literal(instruction.arg1, scale))
+					return false;
+				index->second = scale;
+				break;
+			}
+
+			// There is no packed 64 bit multiply before AVX-512
+			if (!set_element_type(instruction.type) || element_type.has_base_type(BaseType::LONG))
+				return false;
+
+			[[fallthrough]];
+		}
+		case TACOp::ADD:
+		case TACOp::SUB:
+		case TACOp::DIV:
+		{
+			if (!set_element_type(instruction.type) ||
+				(instruction.op == TACOp::DIV && !element_type.has_base_type(BaseType::DOUBLE)) ||
+				!get_operand(instruction.arg1, loop.counter, a) || !get_operand(instruction.arg2, loop.counter, b))
+				return false;
+
+			std::string result = new_reg();
+			if (result.empty())
+				return false;
+
+			TACOp op = instruction.op == TACOp::ADD   ? TACOp::VEC_ADD
+					   : instruction.op == TACOp::SUB ? TACOp::VEC_SUB
+					   : instruction.op == TACOp::MUL ? TACOp::VEC_MUL
+													  : TACOp::VEC_DIV;
+			body.emplace_back(op, a, b, result, element_type);
+			values[instruction.result] = result;
+			break;
+		}
+		case TACOp::ASSIGN:
+		{
+			if (!set_element_type(instruction.type))
+				return false;
+
+			if (instruction.arg2.empty())
+			{
+				// A copy just renames the value
+				if (is_array(instruction.arg1) || !get_operand(instruction.result, loop.counter, a))
+					return false;
+				values[instruction.arg1] = a;
+			}
+			else if (is_array(instruction.arg1))
+			{
+				// ASSIGN array, index -> value
+				if (!is_index(instruction.arg2, element_type) || !get_operand(instruction.result, loop.counter, a))
+					return false;
+				body.emplace_back(TACOp::VEC_STORE, instruction.arg1, loop.counter, a, element_type);
+				has_store = true;
+			}
+			else if (is_array(instruction.result))
+			{
+				// ASSIGN value, index -> array
+				if (!is_index(instruction.arg2, element_type))
+					return false;
+
+				a = new_reg();
+				if (a.empty())
+					return false;
+
+				body.emplace_back(TACOp::VEC_LOAD, instruction.result, loop.counter, a, element_type);
+				values[instruction.arg1] = a;
+			}
+			else
+				return false;
+			break;
+		}
+		default:
+			return false;
+		}
+
+		// Only arrays of the element type can be indexed by the same counter
+		for (const std::string *name : {&instruction.arg1, &instruction.result})
+			if (is_array(*name) && gst->get_symbol(*name)->type.get_base_type() != element_type.get_base_type())
+				return false;
+	}
+
+	if (!has_store)
+		return false;
+
+	const TACInstruction &condition = instructions[loop.start + 1];
+	const std::string &label = instructions[loop.start].arg1;
+	int width = options.get_vector_size() / element_type.get_size();
+
+	for (auto &[operand, reg] : splats)
+		vectorised.emplace_back(TACOp::VEC_SPLAT, operand, "", reg, element_type);
+
+	/*
+		Only go round whilst there is a whole vector's worth of iterations left
+		Checked as counter < bound - (width - 1) so it can't overflow for a bound near the largest value
+		(and skipped altogether when the bound is so small that the subtraction would)
+	*/
+	std::string limit = new_var(loop.counter, condition.type);
+
+	long long lowest = min_int_value(condition.type) + width - 1;
+	TACInstruction too_few(TACOp::IF, loop.bound, format_int_literal(lowest, condition.type), label + "_vec_end",
+						   condition.type);
+	too_few.cmp_op = BinOpType::LESS_THAN;
+
+	TACInstruction exit(TACOp::IF, loop.counter, limit, label + "_vec_end", condition.type);
+	exit.cmp_op = condition.cmp_op;
+
+	vectorised.push_back(too_few);
+	vectorised.emplace_back(TACOp::SUB, loop.bound, std::to_string(width - 1), limit, condition.type);
+	vectorised.emplace_back(TACOp::LABEL, label + "_vec");
+	vectorised.push_back(exit);
+	vectorised.insert(vectorised.end(), body.begin(), body.end());
+	vectorised.emplace_back(TACOp::ADD, loop.counter, std::to_string(width), loop.counter, condition.type);
+	vectorised.emplace_back(TACOp::GOTO, "", "", label + "_vec");
+	vectorised.emplace_back(TACOp::NOP);
+	vectorised.emplace_back(TACOp::LABEL, label + "_vec_end");
+	vectorised.emplace_back(TACOp::VEC_END);
+
+	return true;
+}
+
+bool LoopVectoriser::is_used_outside(const std::vector<TACInstruction> &instructions, size_t begin, size_t end,
+									 const Loop &loop) const
+{
+	// Values defined in the body only ever exist in vector registers
+	for (size_t i = begin; i <= end; i++)
+	{
+		if (i == loop.start)
+			i = loop.end;
+
+		const TACInstruction &instruction = instructions[i];
+		for (const std::string *name : {&instruction.arg1, &instruction.arg2, &instruction.result})
+			if (body_defs.count(*name))
+				return true;
+	}
+
+	return false;
+}